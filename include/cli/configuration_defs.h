@@ -33,17 +33,55 @@ const std::string LANDMARK_INDEX_OUTPUT_FILE = "landmark index output file";
 const std::string LANDMARK_SUBSET_INDEXES_OUTPUT_FILE = "landmark subset indexes output file";
 const std::string KNNGRAPH = "knngraph";
 const std::string ADAPTIVE_K_HIDENN = "adaptive k hidenn";
+const std::string FIXED_K = "fixed k";
 const std::string SUBSET_COUNT = "subset count";
+const std::string NN_DESCENT = "nn descent";
+const std::string K = "k";
+const std::string SAMPLE_RATE = "sample rate";
+const std::string MAX_ITERATIONS = "max iterations";
+const std::string SEED = "seed";
+const std::string THREADS = "threads";
+const std::string EPSILON = "epsilon";
+const std::string RADIUS = "radius";
+const std::string SCALE = "scale";
+const std::string MAX_DEGREE = "max degree";
 const std::string BACKEND = "backend";
 const std::string ADJACENCY_LIST = "adjacency list";
+const std::string CSR = "csr";
+const std::string BOOST = "boost";
+const std::string BOOST_CSR = "boost csr";
+const std::string KNN_BACKEND = "knn backend";
+const std::string VPTREE = "vptree";
+const std::string BRUTE_FORCE = "brute force";
+const std::string RP_FOREST = "rp forest";
+const std::string PCA_KDTREE = "pca kdtree";
+const std::string DUAL_TREE = "dual tree";
+const std::string INITIALIZATION = "initialization";
+const std::string RANDOM = "random";
 const std::string DIJKSTRA = "dijkstra";
 const std::string OPENCL = "opencl";
+const std::string CPU = "cpu";
+const std::string DELTA_STEPPING = "delta stepping";
+const std::string DELTA = "delta";
+const std::string QUEUE = "queue";
+const std::string RADIX_HEAP = "radix heap";
+const std::string LANE_BELLMAN_FORD = "lane bellman ford";
+const std::string LANES = "lanes";
+const std::string DEVICE_TYPE = "device type";
+const std::string PLATFORM = "platform";
+const std::string DEVICE = "device";
+const std::string WORK_GROUP_SIZE = "work group size";
+const std::string BATCH_SIZE = "batch size";
+const std::string KERNELS = "kernels";
+const std::string FRONTIER = "frontier";
+const std::string PROGRAM_CACHE_DIRECTORY = "program cache directory";
 const std::string RETAINED_BANDS = "retained bands";
 const std::string BACKBONE_RECONSTRUCTION = "backbone reconstruction";
 const std::string NNCACHE_INPUT_FILE = "nncache input file";
 const std::string NEIGHBORHOOD_STRATEGY = "neighborhood strategy";
 const std::string FIXED = "fixed";
 const std::string NEIGHBORHOOD_SIZE = "neighborhood size";
+const std::string INDEX_CACHE_DIRECTORY = "index cache directory";
 const std::string OUTPUT_FILE = "output file";
 
 }
@@ -6,6 +6,7 @@
 #define HSISOMAP_BACKBONE_H
 
 #include <hsisomap/HsiData.h>
+#include <hsisomap/knnsearch/KNNSearch.h>
 #include <unordered_set>
 #include "../typedefs.h"
 
@@ -20,6 +21,9 @@ Key BACKBONE_RECONSTRUCTION_NEIGHBORHOOD_ADAPTIVE_NUMBER_LOWER_LIMIT =
 Key BACKBONE_RECONSTRUCTION_NEIGHBORHOOD_ADAPTIVE_NUMBER_UPPER_LIMIT =
     "BACKBONE_RECONSTRUCTION_NEIGHBORHOOD_ADAPTIVE_NUMBER_UPPER_LIMIT";
 
+// The NN cache searches the backbone pixels directly, so the search ranges are no longer used. The kNN search
+// backend is selected with KNN_BACKEND in the optional settings of Backbone::PrepareNNCache. The backbone pixels get
+// a pivot table of 16 pivots unless KNN_PIVOTS is given there; zero disables it.
 Key BACKBONE_NNCACHE_PRIMARY_SEARCH_RANGE = "BACKBONE_NNCACHE_PRIMARY_SEARCH_RANGE";
 Key BACKBONE_NNCACHE_SECONDARY_SEARCH_RANGE = "BACKBONE_NNCACHE_SECONDARY_SEARCH_RANGE";
 
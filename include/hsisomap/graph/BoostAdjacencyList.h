@@ -38,6 +38,9 @@ class BoostAdjacencyList : public UndirectedWeightedGraph {
 
   //! Struct to represent all the information of a graph.
   struct BoostGraph {
+    //! Build the graph in place from the edges.
+    BoostGraph(const std::vector<Edge> &edges, const std::vector<Scalar> &weights, Index numVertices);
+
     BoostGraphData graph;
     size_t numVertices;
     IndexMap index;
@@ -0,0 +1,86 @@
+//***************************************************************************************
+//
+//! \file BoostCSRGraph.h
+//!  Boost Graph Library compressed sparse row graph based graph representation wrapper class.
+//!
+//! The Boost adjacency list keeps the out edges of every vertex in a linked list. The compressed sparse row graph
+//! keeps all of them in one array in vertex order, so the Boost algorithms read the neighbors of a vertex from
+//! consecutive memory. The Boost CSR graph is directed only, and each undirected edge is stored in both directions.
+//!
+//! \version   1.0
+//! \date      2026-10-19
+//! \copyright GNU Public License V3.0
+//
+//***************************************************************************************
+
+#ifndef HSISOMAP_BOOSTCSRGRAPH_H
+#define HSISOMAP_BOOSTCSRGRAPH_H
+
+#include <memory>
+#include <vector>
+#include "UndirectedWeightedGraph.h"
+#include <boost/graph/graph_traits.hpp>
+#include <boost/graph/compressed_sparse_row_graph.hpp>
+
+namespace GraphUtils {
+
+//! Boost Graph Library compressed sparse row graph based graph representation wrapper class.
+class BoostCSRGraph : public UndirectedWeightedGraph {
+ public:
+
+  //! Bundled property of an edge.
+  struct EdgeProperty {
+    Scalar weight;
+  };
+
+  //! Data type to store graph information.
+  typedef boost::compressed_sparse_row_graph<boost::directedS, boost::no_property, EdgeProperty> BoostGraphData;
+
+  //! Data type to represent a vertex.
+  typedef boost::graph_traits<BoostGraphData>::vertex_descriptor Vertex;
+
+  //! Data type to represent an edge.
+  typedef std::pair<Vertex, Vertex> Edge;
+
+  //! Struct to represent all the information of a graph.
+  struct BoostGraph {
+    //! Build the graph in place from the edges stored in both directions.
+    BoostGraph(const std::vector<Edge> &edges, const std::vector<EdgeProperty> &properties, Index numVertices);
+
+    BoostGraphData graph;
+    size_t numVertices;
+  };
+
+  //! Constructor.
+  //! \param numVertices the number of vertices.
+  BoostCSRGraph(Index numVertices);
+
+  //! Obtain the pointer to the boost graph struct. The graph is built on the first call after the last Connect,
+  //! and shared by the later calls.
+  //! \return the pointer to the boost graph struct.
+  std::shared_ptr<BoostGraph> GetBoostGraph();
+
+  //! Connect two vertices in the graph using a weighted edge.
+  //! The graph is not connected at the beginning, and each edge needs to be connected by this method.
+  //! \param a the index of the source vertex of the edge.
+  //! \param b the index of the target vertex of the edge. For undirected graph, a and b can be exchanged.
+  //! \param weight the weight of the edge.
+  void Connect(Index a, Index b, Scalar weight);
+
+  //! Get the number of vertices of the graph.
+  //! \return the number of vertices of the graph.
+  Index NumVertices() const;
+
+  //! Get the number of edges of the graph. As for BoostAdjacencyList, each undirected edge counts once.
+  //! \return the number of edges of the graph.
+  Index NumEdges() const;
+ private:
+  Index numVertices_;
+  std::vector<Edge> edges_; //!< the connected edges, each in both directions.
+  std::vector<EdgeProperty> properties_; //!< the weights of edges_.
+  std::shared_ptr<BoostGraph> boostGraph_; //!< the graph built from edges_, reset by Connect.
+};
+
+} // namespace GraphUtils
+
+#endif //HSISOMAP_BOOSTCSRGRAPH_H
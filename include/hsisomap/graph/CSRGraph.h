@@ -0,0 +1,96 @@
+//***************************************************************************************
+//
+//! \file CSRGraph.h
+//!  Compressed sparse row (CSR) representation of an undirected weighted graph.
+//!
+//! The adjacency of all vertices is stored in three flat arrays: the offsets of the vertices into the neighbor
+//! array, the neighbors and their weights. It takes the least memory of the graph representations, it is laid out
+//! as the shortest path kernels read it, and a kNN graph can be written into it in a single pass over the neighbor
+//! lists. Edges may also be added one by one with Connect; they are merged into the arrays on the next access.
+//!
+//! \version   1.0
+//! \date      2026-10-19
+//! \copyright GNU Public License V3.0
+//
+//***************************************************************************************
+
+#ifndef HSISOMAP_CSRGRAPH_H
+#define HSISOMAP_CSRGRAPH_H
+
+#include <memory>
+#include <vector>
+#include "UndirectedWeightedGraph.h"
+#include "AdjacencyList.h"
+
+namespace GraphUtils {
+
+//! Compressed sparse row (CSR) graph representation.
+class CSRGraph : public UndirectedWeightedGraph {
+ public:
+
+  //! Constructor.
+  //! Construct an empty graph.
+  //! \param numVertices the number of vertices in the graph.
+  CSRGraph(Index numVertices);
+
+  //! Constructor.
+  //! Construct the union of the neighbor lists, e.g. a kNN graph. Self loops are dropped, and an edge listed from
+  //! both of its ends is stored once, with the weight listed last in row major order.
+  //! \param numVertices the number of vertices in the graph.
+  //! \param k the number of neighbors listed per vertex.
+  //! \param neighbors row major numVertices x k table of the neighbors of each vertex.
+  //! \param weights row major numVertices x k table of the weights of the edges to the neighbors.
+  CSRGraph(Index numVertices, Index k, const std::vector<Index> &neighbors, const std::vector<Scalar> &weights);
+
+  //! Connect two vertices in the graph using a weighted edge.
+  //! Connecting two connected vertices again updates the weight of their edge.
+  //! \param a the index of the source vertex of the edge.
+  //! \param b the index of the target vertex of the edge. For undirected graph, a and b can be exchanged.
+  //! \param weight the weight of the edge.
+  void Connect(Index a, Index b, Scalar weight);
+
+  //! Get the number of vertices of the graph.
+  //! \return the number of vertices of the graph.
+  Index NumVertices() const;
+
+  //! Get the number of edges of the graph. As for AdjacencyList, each undirected edge counts from both of its ends.
+  //! \return the number of edges of the graph.
+  Index NumEdges() const;
+
+  //! Get the offsets of the vertices into the neighbor array. It has NumVertices() + 1 entries; the neighbors of
+  //! vertex v are in [offsets()[v], offsets()[v + 1]), sorted.
+  const std::vector<Index> &offsets() const;
+
+  //! Get the neighbor array.
+  const std::vector<Index> &neighbors() const;
+
+  //! Get the weight array, matching the neighbor array.
+  const std::vector<Scalar> &weights() const;
+
+  //! Construct and obtained graph array struct representation of the graph, as AdjacencyList::GetGraphArray.
+  //! \tparam T_Index the index type of the graph array. For example, it is cl_Index for OpenCL usages.
+  //! \tparam T_Scalar the scalar type of the graph array. For example, it is cl_Scalar for OpenCL usages.
+  //! \return the pointer to the graph array struct.
+  template <typename T_Index, typename T_Scalar>
+  std::shared_ptr<GraphArray<T_Index, T_Scalar>> GetGraphArray() const;
+
+ private:
+  struct PendingEdge {
+    Index a;
+    Index b;
+    Scalar weight;
+  };
+
+  //! Merge the edges added by Connect into the arrays.
+  void Compact() const;
+
+  Index numVertices_;
+  mutable std::vector<Index> offsets_;
+  mutable std::vector<Index> neighbors_;
+  mutable std::vector<Scalar> weights_;
+  mutable std::vector<PendingEdge> pending_;
+};
+
+} // namespace GraphUtils
+
+#endif //HSISOMAP_CSRGRAPH_H
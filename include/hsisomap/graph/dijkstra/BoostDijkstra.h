@@ -17,19 +17,28 @@
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/dijkstra_shortest_paths.hpp>
 #include "../BoostAdjacencyList.h"
+#include "../BoostCSRGraph.h"
 #include "../../Matrix.h"
 #include "Dijkstra.h"
 
 namespace Dijkstra {
 
 //! Boost Graph Library implementation of Dijkstra algorithm.
-//! The implementation calculates the distances from the specified source vertices (in sequence) to all vertices on the graph using Dijkstra algorithm.
+//! The implementation calculates the distances from the specified source vertices to all vertices on the graph using Dijkstra algorithm.
+//! The sources are handed out to the worker threads one at a time. Each thread keeps its color map between its
+//! sources, and its row of distances, which is handed to the sink when finished.
 class BoostDijkstra : public Dijkstra {
  public:
 
   //! Constructor.
   //! \param graph the graph to be calculated represented by GraphUtils::BoostAdjacencyList.
-  BoostDijkstra(std::shared_ptr<GraphUtils::BoostAdjacencyList> graph);
+  //! \param threads the number of worker threads. Zero uses all hardware threads.
+  BoostDijkstra(std::shared_ptr<GraphUtils::BoostAdjacencyList> graph, Index threads = 0);
+
+  //! Constructor.
+  //! \param graph the graph to be calculated represented by GraphUtils::BoostCSRGraph.
+  //! \param threads the number of worker threads. Zero uses all hardware threads.
+  BoostDijkstra(std::shared_ptr<GraphUtils::BoostCSRGraph> graph, Index threads = 0);
 
   //! Set the source vertices list.
   //! \param sourceVertices the vector of source indices.
@@ -39,12 +48,24 @@ class BoostDijkstra : public Dijkstra {
   //! \return error code. 0 if succeeded.
   int Run();
 
+  //! Run the Dijkstra algorithm, handing each finished row of distances to a sink from the worker threads.
+  //! \param sink the function receiving the rows.
+  //! \return error code. 0 if succeeded.
+  int Run(const DistanceRowSink &sink);
+
   //! Get the distance matrix from the Dijkstra algorithm.
   //! \return the calculated distance matrix as gsl::Matrix. The rows represent the source vertices, and the columns represent destination vertices.
   std::shared_ptr<gsl::Matrix> GetDistanceMatrix();
  private:
-  std::shared_ptr<GraphUtils::BoostAdjacencyList::BoostGraph> graph_; //!< the pointer to the input graph.
-  Index numVertices_; //!< number of vertices of the graph, calculated from graph_.
+  //! Run the sources on one of the graph representations.
+  //! \param sink the function receiving the rows.
+  template<typename T_Graph, typename T_WeightMap>
+  void RunGraph(const T_Graph &graph, T_WeightMap weight, const DistanceRowSink &sink);
+
+  std::shared_ptr<GraphUtils::BoostAdjacencyList::BoostGraph> graph_; //!< the pointer to the input adjacency list graph, or null.
+  std::shared_ptr<GraphUtils::BoostCSRGraph::BoostGraph> csrGraph_; //!< the pointer to the input CSR graph, or null.
+  Index numVertices_; //!< number of vertices of the graph, calculated from the input graph.
+  Index threads_; //!< the number of worker threads, zero for all hardware threads.
   std::vector<Index> sourceVertices_; //!< the source vertices list from which the shortest distances to all vertices are calculated.
   std::shared_ptr<gsl::Matrix> distanceMatrix_; //!< the pointer to the resulted distance matrix.
 };
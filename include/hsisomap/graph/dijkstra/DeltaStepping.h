@@ -0,0 +1,123 @@
+//***************************************************************************************
+//
+//! \file DeltaStepping.h
+//!  Shared-memory parallel delta-stepping single-source shortest paths.
+//!
+//! Unlike DijkstraCPU, which runs the sources in parallel, delta-stepping runs one source on all the threads, so it
+//! suits single-source or few-source queries on large graphs. The tentative distances are grouped in buckets of
+//! width delta. The vertices of the lowest bucket are settled together: their light edges (weight <= delta) are
+//! relaxed in parallel until the bucket stays empty, then their heavy edges are relaxed once. Each thread collects
+//! its relaxed vertices in its own buckets, and the buckets are a cyclic array, since all the pending distances lie
+//! within the maximum edge weight above the current bucket. The threads of a source are started once and the
+//! phases are separated by barriers, since a source runs thousands of short relaxation rounds.
+//!
+//! \version   1.0
+//! \date      2026-10-19
+//! \copyright GNU Public License V3.0
+//
+//***************************************************************************************
+
+#ifndef DIJKSTRACL_DELTASTEPPING_H
+#define DIJKSTRACL_DELTASTEPPING_H
+
+#include <atomic>
+#include "../AdjacencyList.h"
+#include "../CSRGraph.h"
+#include "../../Matrix.h"
+#include "../../typedefs.h"
+#include "Dijkstra.h"
+
+namespace Dijkstra {
+
+//! The automatic delta is this multiple of the median edge weight. The kNN edges within a few median lengths are
+//! light and settle a shell of several hops per bucket, while the long edges, e.g. those joining the components,
+//! are heavy and relaxed once per bucket.
+kScalar DELTASTEPPING_AUTO_DELTA_MEDIAN_SCALE = 2.0;
+//! The minimum number of bucket vertices per thread; smaller buckets are relaxed on fewer threads.
+kIndex DELTASTEPPING_MIN_VERTICES_PER_THREAD = 256;
+
+//! Shared-memory parallel delta-stepping implementation of the shortest distances.
+//! Unreachable vertices get the distance std::numeric_limits<Scalar>::max(), as in BoostDijkstra.
+class DeltaStepping : public Dijkstra {
+ public:
+
+  //! Constructor.
+  //! \param adjList the graph to be calculated represented by GraphUtils::AdjacencyList.
+  //! \param threads the number of worker threads. Zero uses all hardware threads.
+  //! \param delta the bucket width. Zero picks it from the edge weights.
+  DeltaStepping(std::shared_ptr<GraphUtils::AdjacencyList> adjList, Index threads = 0, Scalar delta = 0);
+
+  //! Constructor.
+  //! \param csrGraph the graph to be calculated represented by GraphUtils::CSRGraph.
+  //! \param threads the number of worker threads. Zero uses all hardware threads.
+  //! \param delta the bucket width. Zero picks it from the edge weights.
+  DeltaStepping(std::shared_ptr<GraphUtils::CSRGraph> csrGraph, Index threads = 0, Scalar delta = 0);
+
+  //! Set the bucket width, and split the edges of every vertex into light and heavy ones.
+  //! \param delta the bucket width. Zero picks DELTASTEPPING_AUTO_DELTA_MEDIAN_SCALE times the median edge weight.
+  void SetDelta(Scalar delta);
+
+  //! Get the bucket width.
+  //! \return the bucket width in use.
+  Scalar delta() const;
+
+  //! Set the source vertices list.
+  //! \param sourceVertices the vector of source indices.
+  void SetSourceVertices(std::vector<Index> sourceVertices);
+
+  //! Run the shortest distances from the sources one after another, each on all the threads.
+  //! \return error code. 0 if succeeded.
+  int Run();
+
+  //! Run the shortest distances from the sources one after another, handing each row to a sink on this thread.
+  //! \param sink the function receiving the rows.
+  //! \return error code. 0 if succeeded.
+  int Run(const DistanceRowSink &sink);
+
+  //! Get the distance matrix from the Dijkstra algorithm.
+  //! \return the calculated distance matrix as gsl::Matrix. The rows represent the source vertices, and the columns represent destination vertices.
+  std::shared_ptr<gsl::Matrix> GetDistanceMatrix();
+
+  //! Calculate the shortest distances from one source, e.g. for the landmark selection stages that pick the next
+  //! landmark from the distances to the previous one.
+  //! \param source the source vertex.
+  //! \param distances receives the distances to all the vertices, of the number of vertices of the graph.
+  void ShortestDistances(Index source, Scalar *distances);
+
+ private:
+  typedef std::pair<Index, Scalar> BucketEntry; //!< a vertex and its distance when it was put in the bucket.
+
+  //! Lower the tentative distance of a vertex, and put it in the bucket of the new distance.
+  //! \param vertex the relaxed vertex.
+  //! \param distance the candidate distance.
+  //! \param thread the worker thread, whose buckets receive the vertex.
+  void Relax(Index vertex, Scalar distance, Index thread);
+
+  //! Move the entries of a bucket from all the threads into the frontier.
+  //! \param bucket the bucket index.
+  void GatherBucket(Index bucket);
+
+  //! Get the number of threads for relaxing a number of vertices.
+  //! \param vertices the number of vertices.
+  //! \return the number of threads, at least one.
+  Index TeamSize(Index vertices) const;
+
+  std::shared_ptr<GraphUtils::GraphArray<Index, Scalar>> graph_; //!< the compact (CSR) graph array, the light edges of each vertex first.
+  std::vector<Index> lightEnd_; //!< one past the last light edge of each vertex.
+  Index numVertices_; //!< number of vertices of the graph, calculated from graph_.
+  Index threads_; //!< the number of worker threads.
+  Scalar delta_; //!< the bucket width.
+  Index numBuckets_; //!< the number of cyclic buckets, enough to cover the maximum edge weight.
+  std::vector<Index> sourceVertices_; //!< the source vertices list from which the shortest distances to all vertices are calculated.
+  std::shared_ptr<gsl::Matrix> distanceMatrix_; //!< the pointer to the resulted distance matrix.
+
+  std::unique_ptr<std::atomic<Scalar>[]> tentative_; //!< the tentative distances of the current source.
+  std::vector<std::vector<std::vector<BucketEntry>>> buckets_; //!< the cyclic buckets of each thread.
+  std::vector<std::vector<Index>> settled_; //!< the vertices settled in the current bucket by each thread.
+  std::vector<BucketEntry> frontier_; //!< the entries of the current bucket being relaxed.
+  std::vector<Index> settledAll_; //!< the vertices settled in the current bucket, for the heavy edges.
+};
+
+}
+
+#endif //DIJKSTRACL_DELTASTEPPING_H
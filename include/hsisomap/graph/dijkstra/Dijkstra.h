@@ -13,6 +13,7 @@
 #ifndef DIJKSTRACL_DIJKSTRA_H
 #define DIJKSTRACL_DIJKSTRA_H
 
+#include <functional>
 #include <vector>
 #include "../../typedefs.h"
 #include "../../Matrix.h"
@@ -22,15 +23,24 @@
 //!
 //! A collections of various implementations of Dijkstra multi-source all-path shortest path on graph algorithm.
 //!
-//! Currently the implementations include an OpenCL parallel accelerated implementation, and a standard implementation in Boost Graph Library.
+//! Currently the implementations include an OpenCL parallel accelerated implementation, a multi-threaded CPU implementation, a parallel delta-stepping implementation, a lane-per-source multi-source implementation, and a standard implementation in Boost Graph Library.
 namespace Dijkstra {
 
 //! Enum to specify implementations of Dijkstra algorithm.
 enum DijkstraImplementations {
   DIJKSTRA_IMPLEMENTATION_CL = 0, //!< OpenCL parallel accelerated implementation.
-  DIJKSTRA_IMPLEMENTATION_BOOST = 1 //!< Boost Graph Library implementation.
+  DIJKSTRA_IMPLEMENTATION_BOOST = 1, //!< Boost Graph Library implementation, the sources run in parallel.
+  DIJKSTRA_IMPLEMENTATION_CPU_PARALLEL = 2, //!< Multi-threaded CPU implementation, the sources run in parallel.
+  DIJKSTRA_IMPLEMENTATION_DELTA_STEPPING = 3, //!< Parallel delta-stepping, each source runs on all the threads.
+  DIJKSTRA_IMPLEMENTATION_LANE_BELLMAN_FORD = 4 //!< Batches of sources relaxed together, one lane per source.
 };
 
+//! Function receiving one finished row of the distance matrix: the row, i.e. the position of the source in the source
+//! vertices list, and the distances from the source to all the vertices, only valid during the call.
+//! The rows come in no particular order, and the multi-threaded implementations call it from their worker threads,
+//! so it must be safe to call for different rows at once.
+typedef std::function<void(Index, const Scalar *)> DistanceRowSink;
+
 //! Abstract class for various implementations of Dijkstra algorithm.
 class Dijkstra {
  public:
@@ -43,16 +53,28 @@ class Dijkstra {
   //! \return error code. 0 if succeeded.
   virtual int Run() = 0;
 
+  //! Run the Dijkstra algorithm, handing each finished row of distances to a sink instead of keeping the distance
+  //! matrix, e.g. to convert, reduce or store the rows as they come. GetDistanceMatrix has no result after it.
+  //! \param sink the function receiving the rows.
+  //! \return error code. 0 if succeeded.
+  virtual int Run(const DistanceRowSink &sink) = 0;
+
   //! Get the distance matrix from the Dijkstra algorithm.
   //! \return the calculated distance matrix as gsl::Matrix. The rows represent the source vertices, and the columns represent destination vertices.
   virtual std::shared_ptr<gsl::Matrix> GetDistanceMatrix() = 0;
 };
 
+//! Get a sink writing the rows into a matrix.
+//! \param matrix the matrix receiving the rows, with a row per source and a column per vertex.
+//! \return the sink writing into the matrix, which must outlive it.
+DistanceRowSink MatrixRowSink(gsl::Matrix &matrix);
+
 //! Get an implementation object of Dijkstra algorithm with specified implementation.
 //! \param dijkstraImplementations the implementation method of Dijkstra algorithm. It is one of the enum values of DijkstraImplementations.
 //! \param graph graph representation to be calculated.
+//! \param threads the number of worker threads of the CPU implementations. Zero uses all hardware threads.
 //! \return the implementation object that can be called to run the algorithm.
-std::shared_ptr<Dijkstra> DijkstraWithImplementation(DijkstraImplementations dijkstraImplementations, std::shared_ptr<::GraphUtils::UndirectedWeightedGraph> graph);
+std::shared_ptr<Dijkstra> DijkstraWithImplementation(DijkstraImplementations dijkstraImplementations, std::shared_ptr<::GraphUtils::UndirectedWeightedGraph> graph, Index threads = 0);
 
 } // namespace Dijkstra
 
@@ -28,13 +28,60 @@
 #include "CL/cl.h"
 #endif
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
 #include "../AdjacencyList.h"
+#include "../CSRGraph.h"
 #include "../../Matrix.h"
 #include "../../typedefs.h"
 #include "Dijkstra.h"
 
 namespace Dijkstra {
 
+// Device selection keys of DijkstraCL::SetDeviceSelection. The devices of all the OpenCL platforms are considered,
+// and the one with the maximum FLOPS among those matching the selection is used.
+Key DIJKSTRACL_DEVICE_TYPE = "DIJKSTRACL_DEVICE_TYPE"; //!< (Optional) Device selection key, the device type. Without it a GPU is preferred, and any other device is the fallback.
+Key DIJKSTRACL_DEVICE_TYPE_GPU = "gpu"; //!< Device type value, GPU devices only.
+Key DIJKSTRACL_DEVICE_TYPE_CPU = "cpu"; //!< Device type value, CPU devices only, e.g. from POCL or the Intel CPU runtime.
+Key DIJKSTRACL_DEVICE_TYPE_ACCELERATOR = "accelerator"; //!< Device type value, accelerator devices only.
+Key DIJKSTRACL_DEVICE_TYPE_ALL = "all"; //!< Device type value, any device.
+Key DIJKSTRACL_PLATFORM_NAME = "DIJKSTRACL_PLATFORM_NAME"; //!< (Optional) Device selection key, a part of the platform name to match.
+Key DIJKSTRACL_DEVICE_NAME = "DIJKSTRACL_DEVICE_NAME"; //!< (Optional) Device selection key, a part of the device name to match.
+Key DIJKSTRACL_WORK_GROUP_SIZE = "DIJKSTRACL_WORK_GROUP_SIZE"; //!< (Optional) Device selection key, the work-group size. Without it the size is tuned for the device type.
+
+//! Work-group size on CPU devices, in multiples of the preferred work-group size multiple (the vector width).
+//! CPU runtimes run a work-group as one task on one core, so small groups balance the cores better.
+const size_t DIJKSTRACL_CPU_WORK_GROUP_VECTORS = 8;
+//! Work-group size on GPU and accelerator devices, if the kernels allow it.
+const size_t DIJKSTRACL_GPU_WORK_GROUP_SIZE = 256;
+//! The maximum number of sources solved together when the batch size is picked from the device memory.
+const size_t DIJKSTRACL_MAX_BATCH_SIZE = 64;
+
+//! Enum to specify the kernel set of DijkstraCL.
+enum DijkstraCLKernelSet {
+  DIJKSTRACL_KERNELS_ALL_VERTICES = 0, //!< The kernels run over all the vertices in every iteration, and skip the unmasked ones.
+  DIJKSTRACL_KERNELS_FRONTIER = 1 //!< The kernels run over a compacted queue of the vertices whose cost changed in the last iteration.
+};
+
+//! The OpenCL objects of one device. They are created by the first DijkstraCL run on the device, and kept for the
+//! process, so that the later runs skip the context creation and the program build.
+struct DijkstraCLRuntime {
+  cl_context context; //!< the context of the device.
+  cl_command_queue commandQueue; //!< the queue of the kernels, with profiling enabled.
+  cl_command_queue readbackQueue; //!< the queue of the readbacks of the costs.
+  cl_program program; //!< the built program.
+  std::map<std::string, cl_kernel> kernels; //!< the kernels of the program by name.
+  std::mutex mutex; //!< held by a run on the device, since the queues and the kernel args are shared.
+};
+
+//! Counters of the last DijkstraCL::Run, to compare the kernel sets.
+struct DijkstraCLCounters {
+  Index iterations; //!< the number of relaxation iterations of all the batches.
+  Index workItems; //!< the number of work items of the relaxation kernels, the vertices visited.
+  Scalar kernelSeconds; //!< the device time of all the kernels, from the profiling events.
+  Scalar seconds; //!< the wall time of the run on the device, including the transfers.
+};
 
 //! The OpenCL implementation of the Parallel Dijkstra Algorithm
 //! for all-pair or selected-pair shortest distances calculation.
@@ -49,16 +96,61 @@ class DijkstraCL : public Dijkstra {
   //! \param adjList the graph to be calculated represented by GraphUtils::AdjacencyList.
   DijkstraCL(std::shared_ptr<GraphUtils::AdjacencyList> adjList);
 
+  //! Constructor.
+  //! Create the shortest path problem from a CSRGraph shared pointer.
+  //! \param csrGraph the graph to be calculated represented by GraphUtils::CSRGraph.
+  DijkstraCL(std::shared_ptr<GraphUtils::CSRGraph> csrGraph);
+
   //! Run the parallel shortest distance calculation with default or predefined parameters.
   //! The default behavior is to calculate all-pair shortest distance matrix using one GPU with the
   //! maximum FLOPS.
+  //! The sources are solved in batches: one 2D NDRange covers the vertices of all the sources of a batch, whose
+  //! costs and masks are kept in per-source slabs. The device raises a flag when an iteration changes any cost, so
+  //! only that flag is read back to test the convergence. With DIJKSTRACL_KERNELS_FRONTIER the relaxation instead
+  //! runs over a queue of the changed vertices of the whole batch, compacted with atomics, and the length of the
+  //! queue is read back instead of the flag. Two sets of slabs alternate between the batches, and the
+  //! costs of a finished batch are read back on a second command queue while the next batch is computed.
   //! \return error code. 0 if succeeded.
   int Run();
 
+  //! Run the parallel shortest distance calculation as Run(), handing the rows of each batch to a sink once they are
+  //! read back, converted to Scalar. Only the batches being read back are kept on the host, and GetResultsArray
+  //! and GetDistanceMatrix have no result after it.
+  //! \param sink the function receiving the rows, called on this thread.
+  //! \return error code. 0 if succeeded.
+  int Run(const DistanceRowSink &sink);
+
   //! Set the source vertices list.
   //! \param sourceVertices the vector of source indices.
   void SetSourceVertices(std::vector<Index> sourceVertices);
 
+  //! Set how the OpenCL device is selected.
+  //! \param deviceSelection the DIJKSTRACL_DEVICE_TYPE, DIJKSTRACL_PLATFORM_NAME, DIJKSTRACL_DEVICE_NAME and
+  //! DIJKSTRACL_WORK_GROUP_SIZE settings. The absent ones are not restricted.
+  void SetDeviceSelection(StringPropertyList deviceSelection);
+
+  //! Set the number of sources solved together.
+  //! \param batchSize the batch size. Zero (default) picks it from the device memory, up to DIJKSTRACL_MAX_BATCH_SIZE.
+  void SetBatchSize(Index batchSize);
+
+  //! Set the kernel set.
+  //! \param kernelSet one of the enum values of DijkstraCLKernelSet. The default is DIJKSTRACL_KERNELS_ALL_VERTICES.
+  void SetKernelSet(DijkstraCLKernelSet kernelSet);
+
+  //! Set the directory of the program binary cache, shared by the process.
+  //! The binaries are cached per platform, device, device version, driver version and program source, and loaded
+  //! instead of building the program from the source when the runtime of a device is created.
+  //! \param directory an existing directory. Empty (default) disables the cache.
+  static void SetProgramCacheDirectory(std::string directory);
+
+  //! Release the OpenCL runtimes of all the devices. The next run creates them again.
+  //! The runtimes are otherwise kept until the process exits. No DijkstraCL may be running.
+  static void ReleaseRuntimes();
+
+  //! Get the counters of the last run.
+  //! \return the iterations, work items and timings.
+  DijkstraCLCounters GetCounters();
+
   //! Get the result array pointer.
   //! \return a row-major linear storage of the distance matrix.
   std::shared_ptr<std::vector<cl_Scalar>> GetResultsArray();
@@ -70,17 +162,47 @@ class DijkstraCL : public Dijkstra {
   std::shared_ptr<GraphUtils::GraphArray<cl_Index, cl_Scalar>> graph_; //!< Predefined GraphArray shared pointer.
   cl_Index numVertices_; //!< number of vertices of the graph, calculated from graph_.
   std::vector<cl_Index> sourceVertices_; //!< the source vertices list from which the shortest distances to all vertices are calculated.
-  std::shared_ptr<std::vector<cl_Scalar>> results_; //!< the result array pointer.
+  std::shared_ptr<std::vector<cl_Scalar>> results_; //!< the result array pointer, null when the rows go to a sink.
+  const DistanceRowSink *sink_; //!< the sink of the running Run(sink), or null.
   cl_platform_id platform_; //!< the selected OpenCL platform.
-  cl_context context_; //!< the selected OpenCL context.
+  std::shared_ptr<DijkstraCLRuntime> runtime_; //!< the runtime of the selected device, shared by the process.
   cl_device_id device_; //!< the selected OpenCL device.
   cl_int lastErr_; //!< the last error number from OpenCL C API.
+  StringPropertyList deviceSelection_; //!< the device selection settings.
+  Index batchSize_; //!< the number of sources solved together, zero to pick it from the device memory.
+  DijkstraCLKernelSet kernelSet_; //!< the kernel set.
+  DijkstraCLCounters counters_; //!< the counters of the last run.
 
-  //! Initialize the selected OpenCL devices.
+  //! Device memory of one batch of sources. The vertex arrays hold one slab per source, one after another.
+  struct BatchBuffers {
+    cl_mem sources; //!< the source vertex of each slab.
+    cl_mem masks; //!< the masks of the vertices whose edges are relaxed in the next iteration.
+    cl_mem costs; //!< the current costs.
+    cl_mem updatingCosts; //!< the costs being relaxed in the current iteration.
+    cl_mem changed; //!< set by the device when an iteration changes any cost of the batch, or the length of the next queue.
+    cl_mem queues[2]; //!< the current and the next queue of the frontier kernels, as offsets into the slabs.
+    std::vector<cl_event> readbacks; //!< the pending readbacks of the costs of the batch.
+    std::vector<cl_Scalar> hostCosts; //!< the costs of the batch read back for the sink.
+    size_t first; //!< the row of the first source of the batch read back for the sink.
+  };
+
+  //! Select the OpenCL device of all the platforms matching the device selection, and get its runtime.
   cl_int InitializeDevices();
 
+  //! Create the runtime of a device: the context, the queues, the program and the kernels.
+  //! \param device the OpenCL device.
+  //! \return the runtime, or null if the context cannot be created.
+  std::shared_ptr<DijkstraCLRuntime> CreateRuntime(cl_device_id device);
+
   //! Select one device from the device list with the maximum FLOPS.
-  cl_device_id GetMaxFlopsDevice();
+  //! \param devices the candidate devices, not empty.
+  cl_device_id GetMaxFlopsDevice(const std::vector<cl_device_id> &devices);
+
+  //! Get the work-group size for running the kernels on the device.
+  //! \param device the OpenCL device.
+  //! \param kernels the kernels to be launched with the same work-group size.
+  //! \return the work-group size, tuned for the device type unless DIJKSTRACL_WORK_GROUP_SIZE is set.
+  size_t WorkGroupSize(cl_device_id device, const std::vector<cl_kernel> &kernels);
 
   //! Get the rounded-up of the global work size to be enough to cover all the global computing elements.
   //! Note that the size types are defined as type size_t according to OpenCL API.
@@ -90,12 +212,11 @@ class DijkstraCL : public Dijkstra {
   //! \return rounded-up work size.
   size_t RoundUpWorkSize(size_t groupSize, size_t globalSize);
 
-  //! Simple helper function to check if all the elements of the mask array are zero (empty) using a loop.
-  //! This function works on host memory.
-  //! \param mask mask array pointer in host memory.
-  //! \param maskSize the size of the mask array.
-  //! \return whether the mask is empty.
-  bool isMaskEmpty(cl_Index * mask, cl_Index maskSize);
+  //! Pick the batch size from the device memory, unless it was set.
+  //! \param device the OpenCL device.
+  //! \param stride the length of the slab of one source, the rounded-up number of vertices.
+  //! \return the number of sources solved together.
+  size_t BatchSize(cl_device_id device, size_t stride);
 
   //! Prepare the device memory.
   //! This function allocates the required device memory, create the host memory pointers, copy the graph data
@@ -106,31 +227,47 @@ class DijkstraCL : public Dijkstra {
   //! \param verticesDevice the pointer to where a device memory reference for vertices array is created.
   //! \param edgesDevice the pointer to where a device memory reference for edges array is created.
   //! \param weightsDevice the pointer to where a device memory reference for weights array is created.
-  //! \param maskDevice the pointer to where a device memory reference for mask array is created.
-  //! \param costDevice the pointer to where a device memory reference for cost array is created.
-  //! \param updatingCostDevice the pointer to where a device memory reference for updating cost array is created.
   //! \param globalWorkSize rounded-up global work size.
   void PrepareDeviceMemory
       (cl_context context, cl_command_queue commandQueue, GraphUtils::GraphArray<cl_Index, cl_Scalar> &graph,
        cl_mem *verticesDevice, cl_mem *edgesDevice, cl_mem *weightsDevice,
-       cl_mem *maskDevice, cl_mem *costDevice, cl_mem *updatingCostDevice,
        size_t globalWorkSize);
 
+  //! Allocate the device memory of one batch of sources.
+  //! \param context the OpenCL context.
+  //! \param batchSize the number of slabs.
+  //! \param stride the length of one slab.
+  //! \param buffers the batch buffers to be created.
+  void PrepareBatchMemory(cl_context context, size_t batchSize, size_t stride, BatchBuffers *buffers);
+
+  //! Add the device time of kernels to the counters and release their events.
+  //! \param events the profiling events of the kernels, cleared.
+  void CountKernelTime(std::vector<cl_event> *events);
+
+  //! Run the sources on the selected device, into the results array or the sink.
+  //! \return error code. 0 if succeeded.
+  int RunSources();
+
+  //! Wait for the pending readbacks of a batch and release their events, then hand the rows to the sink, if any.
+  //! \param buffers the batch buffers.
+  void WaitForReadbacks(BatchBuffers *buffers);
+
   //! Check if the returning error number of OpenCL C API is success;
   //! if not, show the current source file and line number, and terminate the program.
   //! There is no need to call this function directly. This works with the checkError() macro.
   void checkErrorFileLine(const char *file, const int lineNumber);
 
-  //! Build the OpenCL kernel program on the specified context.
+  //! Build the OpenCL kernel program on the specified context, or load it from the program binary cache.
   //! \param context the OpenCL context on which the program is built.
+  //! \param device the OpenCL device of the context.
   //! \return OpenCL program index as cl_program.
-  cl_program buildProgram(cl_context context);
+  cl_program buildProgram(cl_context context, cl_device_id device);
 
-  //! Run the OpenCL kernel program on specified context and device.
-  //! \param context the OpenCL context on which the program runs.
+  //! Run the OpenCL kernel program on specified runtime and device.
+  //! \param runtime the runtime of the device, locked by the caller.
   //! \param device the OpenCL device on which the program runs.
   //! \return error code. 0 if succeed.
-  cl_int RunOnDevice(cl_context context, cl_device_id device);
+  cl_int RunOnDevice(DijkstraCLRuntime &runtime, cl_device_id device);
 };
 
 } // namespace Dijkstra
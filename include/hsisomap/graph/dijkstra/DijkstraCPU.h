@@ -0,0 +1,103 @@
+//***************************************************************************************
+//
+//! \file DijkstraCPU.h
+//!  Multi-threaded CPU implementation of multi-source Dijkstra algorithm.
+//!
+//! The sources are independent single-source problems. They are handed out to the worker threads one at a time,
+//! so a thread that finishes early takes the next source instead of idling. Each thread keeps its binary heap and
+//! its row of tentative distances between sources, and hands each finished row to the sink.
+//!
+//! Optionally the queue is a monotone radix heap over the distances quantized to integers. The weights are scaled
+//! so that the maximum one is 2^32 - 1 and rounded, and the distances are sums of them in 64 bits. This trades the
+//! comparisons of the binary heap for bit scans, at a relative error bounded by relativeErrorBound().
+//!
+//! \version   1.0
+//! \date      2026-10-19
+//! \copyright GNU Public License V3.0
+//
+//***************************************************************************************
+
+#ifndef DIJKSTRACL_DIJKSTRACPU_H
+#define DIJKSTRACL_DIJKSTRACPU_H
+
+#include <cstdint>
+#include "../AdjacencyList.h"
+#include "../CSRGraph.h"
+#include "../../Matrix.h"
+#include "../../typedefs.h"
+#include "Dijkstra.h"
+
+namespace Dijkstra {
+
+//! Enum to specify the priority queue of DijkstraCPU.
+enum DijkstraCPUQueue {
+  DIJKSTRACPU_QUEUE_BINARY_HEAP = 0, //!< Binary heap of the exact distances.
+  DIJKSTRACPU_QUEUE_RADIX_HEAP = 1 //!< Monotone radix heap of the distances over the quantized weights.
+};
+
+//! Multi-threaded CPU implementation of multi-source Dijkstra algorithm.
+//! Unreachable vertices get the distance std::numeric_limits<Scalar>::max(), as in BoostDijkstra.
+class DijkstraCPU : public Dijkstra {
+ public:
+
+  //! Constructor.
+  //! \param adjList the graph to be calculated represented by GraphUtils::AdjacencyList.
+  //! \param threads the number of worker threads. Zero uses all hardware threads.
+  DijkstraCPU(std::shared_ptr<GraphUtils::AdjacencyList> adjList, Index threads = 0);
+
+  //! Constructor.
+  //! \param csrGraph the graph to be calculated represented by GraphUtils::CSRGraph.
+  //! \param threads the number of worker threads. Zero uses all hardware threads.
+  DijkstraCPU(std::shared_ptr<GraphUtils::CSRGraph> csrGraph, Index threads = 0);
+
+  //! Set the priority queue.
+  //! \param queue one of the enum values of DijkstraCPUQueue. The default is DIJKSTRACPU_QUEUE_BINARY_HEAP.
+  void SetQueue(DijkstraCPUQueue queue);
+
+  //! Get the bound of the error relative to the exact distances: |d' - d| <= relativeErrorBound() * d.
+  //! Each quantized weight is off by at most half a step, and every positive weight on a path is at least the
+  //! minimum positive weight, so the bound is half a step over the minimum positive weight.
+  //! \return the relative error bound, zero with the binary heap.
+  Scalar relativeErrorBound() const;
+
+  //! Set the source vertices list.
+  //! \param sourceVertices the vector of source indices.
+  void SetSourceVertices(std::vector<Index> sourceVertices);
+
+  //! Run the Dijkstra algorithm.
+  //! \return error code. 0 if succeeded.
+  int Run();
+
+  //! Run the Dijkstra algorithm, handing each finished row of distances to a sink from the worker threads.
+  //! \param sink the function receiving the rows.
+  //! \return error code. 0 if succeeded.
+  int Run(const DistanceRowSink &sink);
+
+  //! Get the distance matrix from the Dijkstra algorithm.
+  //! \return the calculated distance matrix as gsl::Matrix. The rows represent the source vertices, and the columns represent destination vertices.
+  std::shared_ptr<gsl::Matrix> GetDistanceMatrix();
+ private:
+  std::shared_ptr<GraphUtils::GraphArray<Index, Scalar>> graph_; //!< the compact (CSR) graph array.
+  Index numVertices_; //!< number of vertices of the graph, calculated from graph_.
+  Index threads_; //!< the number of worker threads, zero for all hardware threads.
+  DijkstraCPUQueue queue_; //!< the priority queue.
+  std::vector<std::uint64_t> quantizedWeights_; //!< the weights scaled and rounded for the radix heap.
+  Scalar scale_; //!< the quantization scale of the weights, 2^32 - 1 over the maximum weight.
+  Scalar relativeErrorBound_; //!< the relative error bound of the quantized distances.
+  std::vector<Index> sourceVertices_; //!< the source vertices list from which the shortest distances to all vertices are calculated.
+  std::shared_ptr<gsl::Matrix> distanceMatrix_; //!< the pointer to the resulted distance matrix.
+
+  //! Run the sources with the binary heap.
+  //! \param distanceMatrix the matrix whose rows receive the distances directly, or nullptr to use the sink.
+  //! \param sink the function receiving the rows when there is no matrix.
+  void RunBinaryHeap(gsl::Matrix *distanceMatrix, const DistanceRowSink &sink);
+
+  //! Run the sources with the radix heap over the quantized weights.
+  //! \param distanceMatrix the matrix whose rows receive the distances directly, or nullptr to use the sink.
+  //! \param sink the function receiving the rows when there is no matrix.
+  void RunRadixHeap(gsl::Matrix *distanceMatrix, const DistanceRowSink &sink);
+};
+
+}
+
+#endif //DIJKSTRACL_DIJKSTRACPU_H
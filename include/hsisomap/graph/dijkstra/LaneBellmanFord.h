@@ -0,0 +1,104 @@
+//***************************************************************************************
+//
+//! \file LaneBellmanFord.h
+//!  Multi-source shortest distances with one lane per source, relaxed together over the graph.
+//!
+//! The sources are taken in batches of lanes() sources. Every vertex holds the tentative distances of the whole
+//! batch side by side, and relaxing an edge is a min-plus over all the lanes at once, a fixed-length loop the
+//! compiler vectorizes. One pass over the adjacency of a vertex thus serves every source of the batch, which pays
+//! off when the sources reach the vertices at similar distances, as on the kNN graphs of high dimensional data.
+//!
+//! A vertex whose distances improved is active, and is relaxed again later. The active vertices are ordered by
+//! their lowest improved distance, rounded down to multiples of delta, in a radix heap. Plain Bellman-Ford sweeps
+//! over the active vertices relax each edge many times over on long graphs; in distance order it is about once per
+//! lane in the worst case, and once for all the lanes when their wavefronts meet the vertex together.
+//!
+//! \version   1.0
+//! \date      2026-10-19
+//! \copyright GNU Public License V3.0
+//
+//***************************************************************************************
+
+#ifndef DIJKSTRACL_LANEBELLMANFORD_H
+#define DIJKSTRACL_LANEBELLMANFORD_H
+
+#include "../AdjacencyList.h"
+#include "../CSRGraph.h"
+#include "../../Matrix.h"
+#include "../../typedefs.h"
+#include "Dijkstra.h"
+
+namespace Dijkstra {
+
+//! The automatic delta is this fraction of the median edge weight. A coarser order relaxes the vertices before
+//! their distances settle, and a finer one only adds heap entries.
+kScalar LANEBELLMANFORD_AUTO_DELTA_MEDIAN_SCALE = 0.25;
+
+//! Multi-source shortest distances relaxing a batch of sources per pass, one lane per source.
+//! Unreachable vertices get the distance std::numeric_limits<Scalar>::max(), as in BoostDijkstra.
+class LaneBellmanFord : public Dijkstra {
+ public:
+
+  //! Constructor.
+  //! \param adjList the graph to be calculated represented by GraphUtils::AdjacencyList.
+  //! \param threads the number of worker threads, each running its own batches. Zero uses all hardware threads.
+  //! \param lanes the number of sources per batch, 8 or 16.
+  LaneBellmanFord(std::shared_ptr<GraphUtils::AdjacencyList> adjList, Index threads = 0, Index lanes = 8);
+
+  //! Constructor.
+  //! \param csrGraph the graph to be calculated represented by GraphUtils::CSRGraph.
+  //! \param threads the number of worker threads, each running its own batches. Zero uses all hardware threads.
+  //! \param lanes the number of sources per batch, 8 or 16.
+  LaneBellmanFord(std::shared_ptr<GraphUtils::CSRGraph> csrGraph, Index threads = 0, Index lanes = 8);
+
+  //! Set the number of sources per batch.
+  //! \param lanes 8 or 16. Each thread holds the number of vertices times lanes distances.
+  void SetLanes(Index lanes);
+
+  //! Get the number of sources per batch.
+  //! \return the number of lanes.
+  Index lanes() const;
+
+  //! Set the rounding of the distances ordering the active vertices.
+  //! \param delta the rounding. Zero picks LANEBELLMANFORD_AUTO_DELTA_MEDIAN_SCALE times the median edge weight.
+  void SetDelta(Scalar delta);
+
+  //! Get the rounding of the distances ordering the active vertices.
+  //! \return the delta in use.
+  Scalar delta() const;
+
+  //! Set the source vertices list.
+  //! \param sourceVertices the vector of source indices.
+  void SetSourceVertices(std::vector<Index> sourceVertices);
+
+  //! Run the batches of sources on the worker threads.
+  //! \return error code. 0 if succeeded.
+  int Run();
+
+  //! Run the batches of sources on the worker threads, handing each finished row of distances to a sink.
+  //! \param sink the function receiving the rows.
+  //! \return error code. 0 if succeeded.
+  int Run(const DistanceRowSink &sink);
+
+  //! Get the distance matrix from the Dijkstra algorithm.
+  //! \return the calculated distance matrix as gsl::Matrix. The rows represent the source vertices, and the columns represent destination vertices.
+  std::shared_ptr<gsl::Matrix> GetDistanceMatrix();
+
+ private:
+  //! Run all the batches with a fixed number of lanes.
+  //! \param sink the function receiving the rows.
+  template<Index T_Lanes>
+  void RunLanes(const DistanceRowSink &sink);
+
+  std::shared_ptr<GraphUtils::GraphArray<Index, Scalar>> graph_; //!< the compact (CSR) graph array.
+  Index numVertices_; //!< number of vertices of the graph, calculated from graph_.
+  Index threads_; //!< the number of worker threads, zero for all hardware threads.
+  Index lanes_; //!< the number of sources per batch.
+  Scalar delta_; //!< the rounding of the distances ordering the active vertices.
+  std::vector<Index> sourceVertices_; //!< the source vertices list from which the shortest distances to all vertices are calculated.
+  std::shared_ptr<gsl::Matrix> distanceMatrix_; //!< the pointer to the resulted distance matrix.
+};
+
+}
+
+#endif //DIJKSTRACL_LANEBELLMANFORD_H
@@ -16,21 +16,28 @@
 #include <vector>
 #include <hsisomap/Matrix.h>
 #include <hsisomap/graph/UndirectedWeightedGraph.h>
+#include <hsisomap/knnsearch/KNNSearch.h>
 #include "../../typedefs.h"
 
 HSISOMAP_NAMESPACE_BEGIN
 
 //! Enum of different kNN graph implementation.
 enum KNNGraphImplementation {
-  KNNGRAPH_IMPLEMENTATION_FIXED_K = 0, //!< kNN graph with fixed k.
+  KNNGRAPH_IMPLEMENTATION_FIXED_K = 0, //!< kNN graph with fixed k, without connectivity augmentation.
   KNNGRAPH_IMPLEMENTATION_FIXED_K_WITH_MST = 1, //!< kNN graph with fixed k augmented with minimum spanning tree (MST) to ensure connectivity.
-  KNNGRAPH_IMPLEMENTATION_ADAPTIVE_K_HIDENN = 2 //!< kNN graph with adaptive k from HIDENN method, also MST augmented.
+  KNNGRAPH_IMPLEMENTATION_ADAPTIVE_K_HIDENN = 2, //!< kNN graph with adaptive k from HIDENN method, also MST augmented.
+  KNNGRAPH_IMPLEMENTATION_NN_DESCENT = 3, //!< Approximate kNN graph with fixed k from NN-Descent, also MST augmented.
+  KNNGRAPH_IMPLEMENTATION_EPSILON = 4 //!< Epsilon-neighborhood graph with fixed or per subset adaptive radius and degree caps, also MST augmented.
 };
 
 
 Key KNNGRAPH_GRAPH_BACKEND = "KNNGRAPH_GRAPH_BACKEND"; //!< kNN graph backend key for the property list.
 kScalar KNNGRAPH_GRAPH_BACKEND_ADJACENCYLIST = 0.0; //!< kNN graph backend value for the property list, to generate adjacency list graph representation.
 kScalar KNNGRAPH_GRAPH_BACKEND_BOOST = 1.0; //!< kNN graph backend value for the property list, to Boost Graph Library based graph representation.
+kScalar KNNGRAPH_GRAPH_BACKEND_CSR = 2.0; //!< kNN graph backend value for the property list, to generate compressed sparse row (CSR) graph representation.
+kScalar KNNGRAPH_GRAPH_BACKEND_BOOST_CSR = 3.0; //!< kNN graph backend value for the property list, to Boost Graph Library compressed sparse row graph representation.
+// The kNN search used by the graph implementations is selected with KNN_BACKEND (see KNNSearch.h). When the data
+// rows are image pixels in line order, set KNN_IMAGE_SAMPLES to let the search seed the queries spatially.
 
 //! Abstract class to manage different implementations of kNN graph.
 class KNNGraph {
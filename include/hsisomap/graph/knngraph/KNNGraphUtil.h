@@ -0,0 +1,61 @@
+//***************************************************************************************
+//
+//! \file KNNGraphUtil.h
+//!  Helpers shared by the kNN graph implementations: graph backend creation and
+//! minimum spanning tree (MST) connectivity augmentation, from a candidate pool or with Borůvka rounds.
+//!
+//! \version   1.0
+//! \date      2026-10-19
+//! \copyright GNU Public License V3.0
+//
+//***************************************************************************************
+
+#ifndef HSISOMAP_KNNGRAPHUTIL_H
+#define HSISOMAP_KNNGRAPHUTIL_H
+
+#include <hsisomap/util/ConcurrentUnionFind.h>
+#include <hsisomap/util/UnionFind.h>
+#include "KNNGraph.h"
+
+HSISOMAP_NAMESPACE_BEGIN
+
+//! A weighted edge that is a candidate for the MST augmentation.
+struct UndirectedEdge {
+  Index index_b;
+  Index index_a;
+  Scalar weight;
+  UndirectedEdge(Index index_a, Index index_b, Scalar weight) : index_a(index_a), index_b(index_b), weight(weight) { }
+};
+
+//! Create an empty graph with the representation specified by KNNGRAPH_GRAPH_BACKEND in the property list.
+//! \param property_list the property list of the kNN graph implementation.
+//! \param vertices the number of vertices of the graph.
+//! \return the empty graph.
+std::shared_ptr<GraphUtils::UndirectedWeightedGraph> CreateKNNGraphBackend(PropertyList &property_list, Index vertices);
+
+//! Augment a graph with the shortest edges of a candidate pool until it is connected (Kruskal on the pool).
+//!
+//! The union-find structure must already contain the connectivity of the graph. The pool is sorted in-place.
+//! \param graph the graph to be augmented.
+//! \param uf the union-find structure that tracks the connected parts of the graph. It is updated.
+//! \param unused_edges the candidate edge pool.
+//! \return the number of edges augmented.
+Index AugmentMST(GraphUtils::UndirectedWeightedGraph &graph, UnionFind &uf, std::vector<UndirectedEdge> &unused_edges);
+
+//! Augment a graph with the shortest edges between its connected parts until it is connected (Borůvka).
+//!
+//! Each round, every connected part but the largest is joined to the nearest point outside it, found with a
+//! component-aware ball tree search over the data. The augmented edges are those of the MST of the connected parts,
+//! no candidate pool is kept, and the graph always ends up connected.
+//! \param graph the graph to be augmented.
+//! \param uf the union-find structure that tracks the connected parts of the graph. It is updated. It is shared with
+//! the parallel graph builders, which fill it from several threads.
+//! \param data the data matrix, the rows are the vertices of the graph.
+//! \param threads the number of threads. Zero uses all hardware threads.
+//! \return the number of edges augmented.
+Index AugmentBoruvka(GraphUtils::UndirectedWeightedGraph &graph, ConcurrentUnionFind &uf, const gsl::Matrix &data,
+                     Index threads = 0);
+
+HSISOMAP_NAMESPACE_END
+
+#endif //HSISOMAP_KNNGRAPHUTIL_H
@@ -26,13 +26,15 @@
 HSISOMAP_NAMESPACE_BEGIN
 
 Key KNNGRAPH_ADAPTIVE_K_HIDENN_SUBSET_NUMBER = "KNNGRAPH_ADAPTIVE_K_HIDENN_SUBSET_NUMBER"; //!< Property list key, specify the number of subsets that represents local spectral region that has the local adaptive k.
-Key KNNGRAPH_ADAPTIVE_K_WITH_MST_EDGE_POOL_DEPTH = "KNNGRAPH_ADAPTIVE_K_WITH_MST_EDGE_POOL_DEPTH"; //!< (Optional) Property list key, specify the MST edge pool depth. It is a trade-off between space and time.
+Key KNNGRAPH_ADAPTIVE_K_HIDENN_SEED = "KNNGRAPH_ADAPTIVE_K_HIDENN_SEED"; //!< (Optional) Property list key, specify the random seed of the Costa & Hero sampling. Zero (default) uses a random seed.
+Key KNNGRAPH_ADAPTIVE_K_WITH_MST_EDGE_POOL_DEPTH = "KNNGRAPH_ADAPTIVE_K_WITH_MST_EDGE_POOL_DEPTH"; //!< No longer used: the MST augmentation searches the edges between the connected parts directly (AugmentBoruvka).
 
 //! kNN graph construction with adaptive k method based on HIDENN.
 //!
 //! The method is based on Hyperspectral Intrinsic Dimensionality Estimation with Nearest Neighbor Ratio (HIDENN) and Costa & Hero intrinsic dimensionality estimation.
 //!
-//! The result is randomized because of the random sampling part of the Costa & Hero method.
+//! The result is randomized because of the random sampling part of the Costa & Hero method, unless a seed is given.
+//! The subsets are estimated in parallel with PARALLEL_THREADS threads.
 //!
 //! The graph is also augmented by minimum spanning tree (MST) to ensure connectivity.
 //!
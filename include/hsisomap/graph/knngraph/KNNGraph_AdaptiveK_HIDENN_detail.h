@@ -0,0 +1,44 @@
+//***************************************************************************************
+//
+//! \file KNNGraph_AdaptiveK_HIDENN_detail.h
+//!  Internals of KNNGraph_AdaptiveK_HIDENN, the Costa & Hero graph length slopes, exposed for testing.
+//!
+//! \version   1.0
+//! \date      2026-10-19
+//! \copyright GNU Public License V3.0
+//
+//***************************************************************************************
+
+#ifndef HSISOMAP_KNNGRAPH_ADAPTIVEK_HIDENN_DETAIL_H
+#define HSISOMAP_KNNGRAPH_ADAPTIVEK_HIDENN_DETAIL_H
+
+#include <random>
+#include <vector>
+#include <hsisomap/Matrix.h>
+#include "../../typedefs.h"
+
+HSISOMAP_NAMESPACE_BEGIN
+
+namespace hidenn_detail {
+
+kIndex MIN_K = 3; //!< Smallest k whose graph length slope is estimated.
+kIndex MAX_K = 22; //!< Largest k whose graph length slope is estimated.
+kIndex MIN_SAMPLES = 10; //!< Smallest sample size of the graph length regression.
+kIndex MAX_SAMPLES = 100; //!< Largest sample size of the graph length regression.
+
+//! Slopes of log(kNN graph length) over log(sample size) of a subset, for every k in [MIN_K, MAX_K] (Costa & Hero).
+//!
+//! One random sample of the subset is drawn per sample size N in [MIN_SAMPLES, MAX_SAMPLES], a partial Fisher-Yates
+//! shuffle of the rows. The graph length is the sum of the edge lengths of the undirected kNN graph of the sample,
+//! each edge counted from both ends.
+//! \param data the data matrix, each row is a point.
+//! \param rows the rows of the subset.
+//! \param rng the random stream of the sampling.
+//! \return the slopes indexed by k, zero below MIN_K. All zero if the subset has at most MIN_SAMPLES rows.
+std::vector<Scalar> GraphLengthSlopes(const gsl::Matrix &data, const std::vector<Index> &rows, std::mt19937 &rng);
+
+}
+
+HSISOMAP_NAMESPACE_END
+
+#endif //HSISOMAP_KNNGRAPH_ADAPTIVEK_HIDENN_DETAIL_H
@@ -0,0 +1,60 @@
+//***************************************************************************************
+//
+//! \file KNNGraph_Epsilon.h
+//!  Epsilon-neighborhood graph construction with degree caps, augmented with minimum spanning tree (MST) to ensure graph connectivity.
+//!
+//! Every point is connected to all points within a radius epsilon of it, up to a maximum degree (the closest ones
+//! are kept). The radius is either fixed, or adapted to the local density of each spectral subset: it is the median
+//! distance from the points of the subset to their r-th nearest neighbor, times a scale factor. The radius queries
+//! run on a vantage point tree with multiple threads.
+//!
+//! \version   1.0
+//! \date      2026-10-19
+//! \copyright GNU Public License V3.0
+//
+//***************************************************************************************
+
+#ifndef HSISOMAP_KNNGRAPH_EPSILON_H
+#define HSISOMAP_KNNGRAPH_EPSILON_H
+
+#include "KNNGraph.h"
+
+HSISOMAP_NAMESPACE_BEGIN
+
+Key KNNGRAPH_EPSILON_RADIUS = "KNNGRAPH_EPSILON_RADIUS"; //!< (Optional) Property list key, specify a fixed radius epsilon (Euclidean distance). Zero (default) uses the adaptive radius.
+Key KNNGRAPH_EPSILON_SUBSET_NUMBER = "KNNGRAPH_EPSILON_SUBSET_NUMBER"; //!< (Optional) Property list key, specify the number of spectral subsets with their own adaptive radius. Default is 1.
+Key KNNGRAPH_EPSILON_REFERENCE_K = "KNNGRAPH_EPSILON_REFERENCE_K"; //!< (Optional) Property list key, specify r for the adaptive radius, the median distance to the r-th nearest neighbor (the point itself is counted). Default is 10.
+Key KNNGRAPH_EPSILON_SCALE = "KNNGRAPH_EPSILON_SCALE"; //!< (Optional) Property list key, specify the factor applied to the adaptive radius. Default is 1.0.
+Key KNNGRAPH_EPSILON_MAX_DEGREE = "KNNGRAPH_EPSILON_MAX_DEGREE"; //!< (Optional) Property list key, specify the maximum number of neighbors searched per point, the point itself excluded. Default is 64.
+
+//! Epsilon-neighborhood graph construction with degree caps, augmented with minimum spanning tree (MST) to ensure graph connectivity.
+//!
+//! The adaptive radius is estimated from at most 1024 sampled points per subset, with the kNN search selected by
+//! KNN_BACKEND. The number of threads is taken from PARALLEL_THREADS.
+//!
+//! Connected parts left by the radius search are joined by the shortest edges between them (AugmentBoruvka).
+class KNNGraph_Epsilon: public KNNGraph {
+ public:
+
+  //! Constructor.
+  //! \param data the data matrix, each row is a point.
+  //! \param property_list the property list contains the options needed to construct the graph.
+  KNNGraph_Epsilon(std::shared_ptr<gsl::Matrix> data, PropertyList property_list);
+
+  //! Get the constructed kNN graph.
+  //! \return the constructed kNN graph. It is a smart pointer to an GraphUtils::UndirectedWeightedGraph. The underlying implementation of the graph is specified in KNNGraphWithImplementation.
+  std::shared_ptr<GraphUtils::UndirectedWeightedGraph> knngraph() { return knngraph_; }
+
+  //! Get the radius used for each point.
+  //! \return the radius epsilon of each point, in data row order.
+  const std::vector<Scalar> &radii() const { return radii_; }
+ private:
+  std::shared_ptr<gsl::Matrix> data_;
+  std::shared_ptr<GraphUtils::UndirectedWeightedGraph> knngraph_;
+  PropertyList property_list_;
+  std::vector<Scalar> radii_;
+};
+
+HSISOMAP_NAMESPACE_END
+
+#endif //HSISOMAP_KNNGRAPH_EPSILON_H
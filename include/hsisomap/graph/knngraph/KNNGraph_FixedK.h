@@ -0,0 +1,53 @@
+//***************************************************************************************
+//
+//! \file KNNGraph_FixedK.h
+//!  kNN graph construction with fixed k, without connectivity augmentation.
+//!
+//! Exactly k neighbors are searched for every point, in parallel, and the graph is written from the neighbor lists
+//! in one pass. With the default CSR graph backend no intermediate graph is built. The connectivity is checked with
+//! a union-find structure and the connected components are reported, but not joined; use KNNGraph_FixedK_MST when
+//! the graph needs to be connected.
+//!
+//! \version   1.0
+//! \date      2026-10-19
+//! \copyright GNU Public License V3.0
+//
+//***************************************************************************************
+
+#ifndef HSISOMAP_KNNGRAPH_FIXEDK_H
+#define HSISOMAP_KNNGRAPH_FIXEDK_H
+
+#include "KNNGraph.h"
+
+HSISOMAP_NAMESPACE_BEGIN
+
+Key KNNGRAPH_FIXED_K_NUMBER = "KNNGRAPH_FIXED_K_NUMBER"; //!< Property list key, specify k value (neighborhood size).
+
+//! kNN graph construction with fixed k, without connectivity augmentation.
+//!
+//! KNNGRAPH_GRAPH_BACKEND defaults to KNNGRAPH_GRAPH_BACKEND_CSR when it is not in the property list.
+class KNNGraph_FixedK: public KNNGraph {
+ public:
+
+  //! Constructor.
+  //! \param data the data matrix. The rows are the samples.
+  //! \param property_list the property list contains the options needed to construct the graph.
+  KNNGraph_FixedK(std::shared_ptr<gsl::Matrix> data, PropertyList property_list);
+
+  //! Get the constructed kNN graph.
+  //! \return the constructed kNN graph. It is a smart pointer to an GraphUtils::UndirectedWeightedGraph. The underlying implementation of the graph is specified in KNNGraphWithImplementation.
+  std::shared_ptr<GraphUtils::UndirectedWeightedGraph> knngraph() { return knngraph_; }
+
+  //! Get the sizes of the connected components of the graph.
+  //! \return the number of vertices of each connected component, largest first. A single entry means the graph is connected.
+  const std::vector<Index> &component_sizes() const { return component_sizes_; }
+ private:
+  std::shared_ptr<gsl::Matrix> data_;
+  std::shared_ptr<GraphUtils::UndirectedWeightedGraph> knngraph_;
+  PropertyList property_list_;
+  std::vector<Index> component_sizes_;
+};
+
+HSISOMAP_NAMESPACE_END
+
+#endif //HSISOMAP_KNNGRAPH_FIXEDK_H
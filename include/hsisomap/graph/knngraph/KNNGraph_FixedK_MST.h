@@ -13,12 +13,11 @@
 #ifndef HSISOMAP_KNNGRAPH_FIXEDK_MST_H
 #define HSISOMAP_KNNGRAPH_FIXEDK_MST_H
 
-#include "KNNGraph.h"
+#include "KNNGraph_FixedK.h"
 
 HSISOMAP_NAMESPACE_BEGIN
 
-Key KNNGRAPH_FIXED_K_NUMBER = "KNNGRAPH_FIXED_K_NUMBER"; //!< Property list key, specify k value (neighborhood size).
-Key KNNGRAPH_FIXED_K_WITH_MST_EDGE_POOL_DEPTH = "KNNGRAPH_FIXED_K_WITH_MST_EDGE_POOL_DEPTH"; //!< (Optional) Property list key, specify the MST edge pool depth. It is a trade-off between space and time.
+Key KNNGRAPH_FIXED_K_WITH_MST_EDGE_POOL_DEPTH = "KNNGRAPH_FIXED_K_WITH_MST_EDGE_POOL_DEPTH"; //!< No longer used: the MST augmentation searches the edges between the connected parts directly (AugmentBoruvka).
 
 //! kNN graph construction with fixed k and minimum spanning tree (MST) augmented to ensure graph connectivity.
 class KNNGraph_FixedK_MST: public KNNGraph {
@@ -0,0 +1,62 @@
+//***************************************************************************************
+//
+//! \file KNNGraph_NNDescent.h
+//!  Approximate kNN graph construction with NN-Descent, augmented with minimum spanning tree (MST) to ensure graph connectivity.
+//!
+//! NN-Descent starts from a random kNN graph and iteratively refines it by comparing the neighbors of neighbors
+//! ("a neighbor of a neighbor is likely to be a neighbor"). No search index is built. The local joins of each
+//! iteration run on multiple threads, and the iteration stops once the number of neighbor list updates drops below
+//! a fraction of N * k.
+//!
+//! The result is randomized because of the random initialization and sampling.
+//!
+//! Please see W. Dong, M. Charikar, K. Li, "Efficient K-Nearest Neighbor Graph Construction for Generic Similarity
+//! Measures", WWW 2011 for details.
+//!
+//! \version   1.0
+//! \date      2026-10-19
+//! \copyright GNU Public License V3.0
+//
+//***************************************************************************************
+
+#ifndef HSISOMAP_KNNGRAPH_NNDESCENT_H
+#define HSISOMAP_KNNGRAPH_NNDESCENT_H
+
+#include <hsisomap/knnsearch/KNNSearch_RPForest.h>
+#include "KNNGraph.h"
+
+HSISOMAP_NAMESPACE_BEGIN
+
+Key KNNGRAPH_NN_DESCENT_K_NUMBER = "KNNGRAPH_NN_DESCENT_K_NUMBER"; //!< Property list key, specify k value (neighborhood size). As with KNNGRAPH_FIXED_K_NUMBER, the point itself is counted.
+Key KNNGRAPH_NN_DESCENT_SAMPLE_RATE = "KNNGRAPH_NN_DESCENT_SAMPLE_RATE"; //!< (Optional) Property list key, specify the sample rate rho in (0, 1] of the local joins. Default is 1.0.
+Key KNNGRAPH_NN_DESCENT_TERMINATION_DELTA = "KNNGRAPH_NN_DESCENT_TERMINATION_DELTA"; //!< (Optional) Property list key, stop when an iteration updates fewer than delta * N * k neighbors. Default is 0.001.
+Key KNNGRAPH_NN_DESCENT_MAX_ITERATIONS = "KNNGRAPH_NN_DESCENT_MAX_ITERATIONS"; //!< (Optional) Property list key, specify the maximum number of iterations. Default is 10.
+Key KNNGRAPH_NN_DESCENT_SEED = "KNNGRAPH_NN_DESCENT_SEED"; //!< (Optional) Property list key, specify the random seed. Zero (default) uses a random seed.
+Key KNNGRAPH_NN_DESCENT_INITIALIZATION = "KNNGRAPH_NN_DESCENT_INITIALIZATION"; //!< (Optional) Property list key, specify how the neighbor lists are initialized.
+kScalar KNNGRAPH_NN_DESCENT_INITIALIZATION_RANDOM = 0.0; //!< NN-Descent initialization value for the property list, to start from random neighbors (default).
+kScalar KNNGRAPH_NN_DESCENT_INITIALIZATION_RPFOREST = 1.0; //!< NN-Descent initialization value for the property list, to start from random projection forest candidates. The forest is set with the KNN_RPFOREST keys; by default 4 trees with leaves of max(k, 16) points.
+
+//! Approximate kNN graph construction with NN-Descent, augmented with minimum spanning tree (MST) to ensure graph connectivity.
+//!
+//! The connected parts of the converged neighbor lists are joined with the shortest edges between them (AugmentBoruvka),
+//! so only the k neighbors of each point are kept. The number of threads is taken from PARALLEL_THREADS.
+class KNNGraph_NNDescent: public KNNGraph {
+ public:
+
+  //! Constructor.
+  //! \param data the data matrix, each row is a point.
+  //! \param property_list the property list contains the options needed to construct the graph.
+  KNNGraph_NNDescent(std::shared_ptr<gsl::Matrix> data, PropertyList property_list);
+
+  //! Get the constructed kNN graph.
+  //! \return the constructed kNN graph. It is a smart pointer to an GraphUtils::UndirectedWeightedGraph. The underlying implementation of the graph is specified in KNNGraphWithImplementation.
+  std::shared_ptr<GraphUtils::UndirectedWeightedGraph> knngraph() { return knngraph_; }
+ private:
+  std::shared_ptr<gsl::Matrix> data_;
+  std::shared_ptr<GraphUtils::UndirectedWeightedGraph> knngraph_;
+  PropertyList property_list_;
+};
+
+HSISOMAP_NAMESPACE_END
+
+#endif //HSISOMAP_KNNGRAPH_NNDESCENT_H
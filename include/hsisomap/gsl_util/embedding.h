@@ -76,8 +76,9 @@ Embedding MNF(const Matrix &data, const Matrix &noise_covariance, Index reduced_
 //! Estimate the noise covariance matrix from the data using nearest neighbor method.
 //! This function estimates the noise covariance matrix of the input data using nearest neighbor method, which is calculate the nearest neighbor distances in spectral space as the noise covariance matrix. The output is a std::shared_ptr of a gsl::Matrix.
 //! \param data input data as gsl::Matrix. The rows are the samples. The columns are the dimensions.
+//! \param property_list (Optional) the kNN search options (KNN_BACKEND, PARALLEL_THREADS). The exact brute-force backend is used if KNN_BACKEND is not specified.
 //! \return smart pointer to the noise covariance matrix of the input data using nearest neighbor method.
-std::shared_ptr<Matrix> NearestNeighborNoiseEstimation(const Matrix &data);
+std::shared_ptr<Matrix> NearestNeighborNoiseEstimation(const Matrix &data, PropertyList property_list = PropertyList());
 
 //! Calculates L2 distance matrix.
 //! The function calculates the L2 distance pairwisely between all vectors from each of the two input data matrices. The dimensions (number of columns) of the two input data matrices must be the same. The output matrix has the number of the rows and columns equal to the number of rows of data1 and data2 matrices respectively.
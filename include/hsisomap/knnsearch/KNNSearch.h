@@ -0,0 +1,123 @@
+//***************************************************************************************
+//
+//! \file KNNSearch.h
+//!  Batch k nearest neighbor (kNN) search engines shared by the kNN graph builders, the backbone NN cache and the noise estimation.
+//!
+//! \version   1.0
+//! \date      2026-10-19
+//! \copyright GNU Public License V3.0
+//
+//***************************************************************************************
+
+#ifndef HSISOMAP_KNNSEARCH_H
+#define HSISOMAP_KNNSEARCH_H
+
+#include <hsisomap/Matrix.h>
+#include <hsisomap/util/Parallel.h>
+#include "../typedefs.h"
+
+HSISOMAP_NAMESPACE_BEGIN
+
+Key KNN_BACKEND = "KNN_BACKEND"; //!< (Optional) Property list key, specify the kNN search backend.
+kScalar KNN_BACKEND_VPTREE = 0.0; //!< kNN search backend value for the property list, to search with a vantage point tree (default).
+kScalar KNN_BACKEND_BRUTE_FORCE = 1.0; //!< kNN search backend value for the property list, to search exhaustively with blocked matrix multiplications.
+kScalar KNN_BACKEND_RPFOREST = 2.0; //!< kNN search backend value for the property list, to search approximately with a random projection forest.
+kScalar KNN_BACKEND_PCA_KDTREE = 3.0; //!< kNN search backend value for the property list, to search exactly with a KD-tree on the leading principal components.
+kScalar KNN_BACKEND_DUAL_TREE = 4.0; //!< kNN search backend value for the property list, to search exactly with a dual-tree traversal of ball trees. It is the default of the kNN graph builders that query all the reference rows, see KNNGraphDefaultBackend.
+
+Key KNN_IMAGE_SAMPLES = "KNN_IMAGE_SAMPLES"; //!< (Optional) Property list key, specify the number of samples per image line when the reference rows are image pixels in line order (row = line * samples + sample). Zero (default) means no image geometry. Backends may use it to seed the searches with spatial neighbors; the results stay exact.
+
+Key KNN_PIVOTS = "KNN_PIVOTS"; //!< (Optional) Property list key, specify the number of pivots of a PivotTable over the reference rows. Zero (default) means no pivots. The VpTree and brute force backends use the pivot distances to skip spectral distance evaluations; the results stay exact.
+
+kIndex KNN_SEARCH_BATCH_ROWS = 16384; //!< Recommended number of queries per batch, to bound the memory used by the result tables.
+
+//! Result table of a batch kNN search.
+//!
+//! Row q holds the k nearest reference rows of query q, closest first. If a query is also a reference row, it is
+//! usually its own first neighbor with zero distance.
+struct KNNTable {
+  Index k; //!< The number of neighbors per query.
+  std::vector<Index> indices; //!< Row major table of the reference row indices of the neighbors.
+  std::vector<Scalar> distance_squares; //!< Row major table of the squared Euclidean distances to the neighbors.
+
+  KNNTable(Index queries, Index k) : k(k), indices(queries * k, 0), distance_squares(queries * k, 0) { }
+
+  //! Get the number of queries in the table.
+  Index queries() const { return k == 0 ? 0 : indices.size() / k; }
+  //! Get the reference row index of the j-th neighbor of query q.
+  Index &index(Index q, Index j) { return indices[q * k + j]; }
+  const Index &index(Index q, Index j) const { return indices[q * k + j]; }
+  //! Get the squared distance to the j-th neighbor of query q.
+  Scalar &distance_square(Index q, Index j) { return distance_squares[q * k + j]; }
+  const Scalar &distance_square(Index q, Index j) const { return distance_squares[q * k + j]; }
+};
+
+//! Abstract class to manage different kNN search backends over a fixed set of reference rows.
+//!
+//! The reference matrix is not copied and needs to outlive the search object. Searches are multi-threaded with
+//! PARALLEL_THREADS threads.
+class KNNSearch {
+ public:
+  virtual ~KNNSearch() { }
+
+  //! Search the k nearest reference rows of each row of the query matrix.
+  //! \param queries the query matrix, with the same number of columns as the reference.
+  //! \param k the number of neighbors. It is capped at the number of reference rows.
+  //! \return the result table with one row per query.
+  KNNTable Search(const gsl::Matrix &queries, Index k);
+
+  //! Search the k nearest reference rows of the reference rows in [first, last), without copying them.
+  //! \param first the first reference row to query.
+  //! \param last one past the last reference row to query.
+  //! \param k the number of neighbors, including the query row itself. It is capped at the number of reference rows.
+  //! \return the result table with one row per query; query q is reference row first + q.
+  KNNTable SearchReference(Index first, Index last, Index k);
+
+  //! Search the k nearest reference rows of the given reference rows.
+  //! \param rows the reference rows to query.
+  //! \param k the number of neighbors, including the query row itself. It is capped at the number of reference rows.
+  //! \return the result table with one row per query; query q is reference row rows[q].
+  KNNTable SearchReferenceRows(const std::vector<Index> &rows, Index k);
+
+ protected:
+  KNNSearch(const gsl::Matrix &reference, PropertyList property_list);
+
+  //! Search the k nearest reference rows of each row of a block of queries.
+  virtual KNNTable SearchBlock(const gsl_matrix *queries, Index k) = 0;
+
+  //! Search the k nearest reference rows of a block of queries that are reference rows, query q being reference
+  //! row rows[q]. Backends that can take advantage of the row indices override it; by default it is SearchBlock.
+  virtual KNNTable SearchReferenceBlock(const gsl_matrix *queries, const Index * /*rows*/, Index k) {
+    return SearchBlock(queries, k);
+  }
+
+  const gsl::Matrix &reference_;
+  PropertyList property_list_;
+  Index threads_;
+};
+
+//! Set the directory where the kNN search backends cache their indexes between runs. The index files are named
+//! after a checksum of the reference matrix and the index settings, so one directory serves any number of data sets
+//! and settings. Empty (default)
+//! disables the cache. Currently the VpTree backend is cached.
+//! \param directory the cache directory. It needs to exist.
+void SetKNNIndexCacheDirectory(const std::string &directory);
+
+//! Get the kNN index cache directory set with SetKNNIndexCacheDirectory.
+std::string KNNIndexCacheDirectory();
+
+//! Get the default kNN search backend of the kNN graph builders that query all the reference rows. It is
+//! KNN_BACKEND_DUAL_TREE, since a self-join of the whole reference is what the dual-tree traversal is good at, or
+//! KNN_BACKEND_VPTREE when an index cache directory is set, since only the VpTree index is cached between runs.
+//! \return the backend value for KNN_BACKEND.
+Scalar KNNGraphDefaultBackend();
+
+//! Return the kNN search backend specified by KNN_BACKEND in the property list, built over the reference rows.
+//! \param reference the reference matrix. The rows are the samples. It needs to outlive the returned object.
+//! \param property_list the property list with KNN_BACKEND, PARALLEL_THREADS and the backend specific options.
+//! \return smart pointer to the kNN search backend.
+std::shared_ptr<KNNSearch> KNNSearchWithBackend(const gsl::Matrix &reference, PropertyList property_list);
+
+HSISOMAP_NAMESPACE_END
+
+#endif //HSISOMAP_KNNSEARCH_H
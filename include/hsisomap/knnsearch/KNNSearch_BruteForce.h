@@ -0,0 +1,57 @@
+//***************************************************************************************
+//
+//! \file KNNSearch_BruteForce.h
+//!  Exact brute-force kNN search backend with blocked matrix multiplications.
+//!
+//! The squared distances are computed tile by tile as |a|^2 + |b|^2 - 2 a.b, where the a.b terms of a query tile
+//! against a reference tile come from one GEMM call. Each tile is followed immediately by the top-k selection of its
+//! rows, so the full distance matrix is never materialized. Query tiles are processed on multiple threads. The expanded
+//! form cancels for close pairs far from the origin, so the selection keeps every reference row whose distance may be
+//! within its rounding error bound of the k-th, and ranks those on their direct distances. The result is that of an
+//! exhaustive search on direct distances, near ties included.
+//!
+//! With KNN_PIVOTS, each query is scanned on its own instead (LAESA). The pivot lower bounds of all reference rows
+//! are computed first, the k rows with the smallest bounds seed the top k, and the other rows are evaluated only
+//! when their bound is below the current k-th distance.
+//!
+//! \version   1.0
+//! \date      2026-10-19
+//! \copyright GNU Public License V3.0
+//
+//***************************************************************************************
+
+#ifndef HSISOMAP_KNNSEARCH_BRUTEFORCE_H
+#define HSISOMAP_KNNSEARCH_BRUTEFORCE_H
+
+#include <hsisomap/util/PivotTable.h>
+#include "KNNSearch.h"
+
+HSISOMAP_NAMESPACE_BEGIN
+
+Key KNN_BRUTE_FORCE_TILE_ROWS = "KNN_BRUTE_FORCE_TILE_ROWS"; //!< (Optional) Property list key, specify the number of query rows per tile. Default is 256.
+Key KNN_BRUTE_FORCE_TILE_COLS = "KNN_BRUTE_FORCE_TILE_COLS"; //!< (Optional) Property list key, specify the number of reference rows per tile. Default is 2048.
+
+//! Exact brute-force kNN search backend with blocked matrix multiplications.
+class KNNSearch_BruteForce: public KNNSearch {
+ public:
+
+  //! Constructor.
+  //! \param reference the reference matrix. It needs to outlive the search object.
+  //! \param property_list the property list contains the options of the search.
+  KNNSearch_BruteForce(const gsl::Matrix &reference, PropertyList property_list);
+
+ protected:
+  KNNTable SearchBlock(const gsl_matrix *queries, Index k);
+
+ private:
+  KNNTable SearchBlockWithPivots(const gsl_matrix *queries, Index k);
+
+  std::unique_ptr<PivotTable> pivots_;
+  std::vector<Scalar> reference_norms_;
+  Index tile_rows_;
+  Index tile_cols_;
+};
+
+HSISOMAP_NAMESPACE_END
+
+#endif //HSISOMAP_KNNSEARCH_BRUTEFORCE_H
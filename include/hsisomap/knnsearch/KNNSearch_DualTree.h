@@ -0,0 +1,48 @@
+//***************************************************************************************
+//
+//! \file KNNSearch_DualTree.h
+//!  Exact kNN search backend with a dual-tree traversal of ball trees.
+//!
+//! A ball tree is built over the reference rows once, and over every block of queries as it comes. The two trees
+//! are traversed together, so the pruning decisions are shared by whole groups of nearby queries instead of being
+//! repeated for every query. It suits the all kNN searches of the graph builders, where the queries are the
+//! reference rows themselves; that case reuses the reference tree as the query tree.
+//!
+//! \version   1.0
+//! \date      2026-10-19
+//! \copyright GNU Public License V3.0
+//
+//***************************************************************************************
+
+#ifndef HSISOMAP_KNNSEARCH_DUALTREE_H
+#define HSISOMAP_KNNSEARCH_DUALTREE_H
+
+#include <hsisomap/util/BallTree.h>
+#include "KNNSearch.h"
+
+HSISOMAP_NAMESPACE_BEGIN
+
+Key KNN_DUAL_TREE_LEAF_SIZE = "KNN_DUAL_TREE_LEAF_SIZE"; //!< (Optional) Property list key, specify the maximum number of points in a ball tree leaf. Default is 32.
+
+//! Exact kNN search backend with a dual-tree traversal of ball trees.
+class KNNSearch_DualTree: public KNNSearch {
+ public:
+
+  //! Constructor.
+  //! \param reference the reference matrix. It needs to outlive the search object.
+  //! \param property_list the property list contains the options of the search.
+  KNNSearch_DualTree(const gsl::Matrix &reference, PropertyList property_list);
+
+ protected:
+  KNNTable SearchBlock(const gsl_matrix *queries, Index k);
+  KNNTable SearchReferenceBlock(const gsl_matrix *queries, const Index *rows, Index k);
+
+ private:
+  KNNTable Search(const BallTree &query_tree, Index k);
+
+  std::unique_ptr<BallTree> tree_;
+};
+
+HSISOMAP_NAMESPACE_END
+
+#endif //HSISOMAP_KNNSEARCH_DUALTREE_H
@@ -0,0 +1,48 @@
+//***************************************************************************************
+//
+//! \file KNNSearch_PCAKDTree.h
+//!  Exact kNN search backend with a KD-tree on the leading principal components and exact refinement.
+//!
+//! The reference rows are rotated onto their principal axes and a KD-tree is built on the leading components only.
+//! Because the PCA bases are orthonormal, the squared distance on the leading components is a lower bound of the
+//! full spectral squared distance. The tree filters the candidates with this bound and the survivors are refined
+//! with the exact distance, so the result matches the brute force search. The fewer components carry most of the
+//! variance of the data, the fewer exact distances are evaluated.
+//!
+//! \version   1.0
+//! \date      2026-10-19
+//! \copyright GNU Public License V3.0
+//
+//***************************************************************************************
+
+#ifndef HSISOMAP_KNNSEARCH_PCAKDTREE_H
+#define HSISOMAP_KNNSEARCH_PCAKDTREE_H
+
+#include <hsisomap/util/KDTree.h>
+#include "KNNSearch.h"
+
+HSISOMAP_NAMESPACE_BEGIN
+
+Key KNN_PCA_DIMENSIONS = "KNN_PCA_DIMENSIONS"; //!< (Optional) Property list key, specify the number of leading principal components indexed by the KD-tree. Default is 16, capped at the number of columns.
+Key KNN_KDTREE_LEAF_SIZE = "KNN_KDTREE_LEAF_SIZE"; //!< (Optional) Property list key, specify the maximum number of points in a KD-tree leaf. Default is 16.
+
+//! Exact kNN search backend with a KD-tree on the leading principal components and exact refinement.
+class KNNSearch_PCAKDTree: public KNNSearch {
+ public:
+
+  //! Constructor.
+  //! \param reference the reference matrix. It needs to outlive the search object.
+  //! \param property_list the property list contains the options of the search.
+  KNNSearch_PCAKDTree(const gsl::Matrix &reference, PropertyList property_list);
+
+ protected:
+  KNNTable SearchBlock(const gsl_matrix *queries, Index k);
+
+ private:
+  std::shared_ptr<gsl::Matrix> bases_; //!< The leading principal axes as columns, D x m.
+  std::unique_ptr<KDTree> tree_;
+};
+
+HSISOMAP_NAMESPACE_END
+
+#endif //HSISOMAP_KNNSEARCH_PCAKDTREE_H
@@ -0,0 +1,43 @@
+//***************************************************************************************
+//
+//! \file KNNSearch_RPForest.h
+//!  Approximate kNN search backend with a random projection forest.
+//!
+//! \version   1.0
+//! \date      2026-10-19
+//! \copyright GNU Public License V3.0
+//
+//***************************************************************************************
+
+#ifndef HSISOMAP_KNNSEARCH_RPFOREST_H
+#define HSISOMAP_KNNSEARCH_RPFOREST_H
+
+#include <hsisomap/util/RPForest.h>
+#include "KNNSearch.h"
+
+HSISOMAP_NAMESPACE_BEGIN
+
+Key KNN_RPFOREST_TREES = "KNN_RPFOREST_TREES"; //!< (Optional) Property list key, specify the number of random projection trees. Default is 8.
+Key KNN_RPFOREST_LEAF_SIZE = "KNN_RPFOREST_LEAF_SIZE"; //!< (Optional) Property list key, specify the maximum number of points in a leaf. Default is 32.
+Key KNN_RPFOREST_SEED = "KNN_RPFOREST_SEED"; //!< (Optional) Property list key, specify the random seed. Zero (default) uses a random seed.
+Key KNN_RPFOREST_SEARCH_CANDIDATES = "KNN_RPFOREST_SEARCH_CANDIDATES"; //!< (Optional) Property list key, specify the number of candidates visited per query. More candidates give better recall. Default is max(k, leaf size) * trees.
+
+//! Approximate kNN search backend with a random projection forest. The trees are built in parallel in the constructor.
+class KNNSearch_RPForest: public KNNSearch {
+ public:
+
+  //! Constructor.
+  //! \param reference the reference matrix. It needs to outlive the search object.
+  //! \param property_list the property list contains the options of the search.
+  KNNSearch_RPForest(const gsl::Matrix &reference, PropertyList property_list);
+
+ protected:
+  KNNTable SearchBlock(const gsl_matrix *queries, Index k);
+
+ private:
+  std::unique_ptr<RPForest> forest_;
+};
+
+HSISOMAP_NAMESPACE_END
+
+#endif //HSISOMAP_KNNSEARCH_RPFOREST_H
@@ -0,0 +1,62 @@
+//***************************************************************************************
+//
+//! \file KNNSearch_VpTree.h
+//!  kNN search backend with a vantage point tree.
+//!
+//! \version   1.0
+//! \date      2026-10-19
+//! \copyright GNU Public License V3.0
+//
+//***************************************************************************************
+
+#ifndef HSISOMAP_KNNSEARCH_VPTREE_H
+#define HSISOMAP_KNNSEARCH_VPTREE_H
+
+#include <hsisomap/util/VpTree.h>
+#include <hsisomap/util/PivotTable.h>
+#include "KNNSearch.h"
+
+HSISOMAP_NAMESPACE_BEGIN
+
+Key KNN_VPTREE_VANTAGE_CANDIDATES = "KNN_VPTREE_VANTAGE_CANDIDATES"; //!< (Optional) Property list key, specify the number of vantage point candidates per node, the one with the largest distance spread is taken. Default is 1 (random vantage points).
+Key KNN_VPTREE_VANTAGE_SAMPLES = "KNN_VPTREE_VANTAGE_SAMPLES"; //!< (Optional) Property list key, specify the number of items sampled to measure the spread of a candidate. Default is four times the candidates.
+Key KNN_VPTREE_SPATIAL_SEED_RADIUS = "KNN_VPTREE_SPATIAL_SEED_RADIUS"; //!< (Optional) Property list key, specify the radius in pixels of the spatial window used to seed the searches when KNN_IMAGE_SAMPLES is set. Default is the smallest radius whose window holds 2k pixels.
+
+//! kNN search backend with a vantage point tree. The tree is built once in the constructor and queried in parallel.
+//!
+//! When the reference rows carry image geometry (KNN_IMAGE_SAMPLES) and the queries are reference rows, each search
+//! first evaluates the pixels in a small spatial window around the query. Spectral neighbors are often spatial
+//! neighbors, so the k-th smallest of these distances is a tight initial search radius, and the tree search then
+//! prunes most branches from the start. The result is the same as without seeding.
+//!
+//! With KNN_PIVOTS, the search passes the nodes whose pivot lower bound already excludes them and their inside
+//! subtree, without evaluating the spectral distance to their vantage point.
+class KNNSearch_VpTree: public KNNSearch {
+ public:
+
+  //! Constructor.
+  //! \param reference the reference matrix. It needs to outlive the search object.
+  //! \param property_list the property list contains the options of the search.
+  KNNSearch_VpTree(const gsl::Matrix &reference, PropertyList property_list);
+
+  //! Get the counters of the tree, to tune the vantage point selection.
+  //! \return the build and search counters since the construction.
+  VpTreeStats stats() const { return vptree_.stats(); }
+
+ protected:
+  KNNTable SearchBlock(const gsl_matrix *queries, Index k);
+  KNNTable SearchReferenceBlock(const gsl_matrix *queries, const Index *rows, Index k);
+
+ private:
+  //! Search the tree, with the pivot lower bounds when there are pivots. A search seeded with tau that comes back
+  //! with fewer than k results is run again unseeded, so there are k results whenever the tree holds k items.
+  void Search(const PixelView &query, Index k, std::vector<PixelView> *results, std::vector<Scalar> *distance_squares,
+              Scalar tau = std::numeric_limits<Scalar>::max()) const;
+
+  VpTree<PixelView, SquaredDistance> vptree_;
+  std::unique_ptr<PivotTable> pivots_;
+};
+
+HSISOMAP_NAMESPACE_END
+
+#endif //HSISOMAP_KNNSEARCH_VPTREE_H
@@ -5,14 +5,24 @@
 #ifndef HSISOMAP_MANIFOLDCONSTRUCTOR_H
 #define HSISOMAP_MANIFOLDCONSTRUCTOR_H
 
+#include <functional>
 #include <hsisomap/Matrix.h>
 #include "../typedefs.h"
 #include "../gsl_util/embedding.h"
 
 HSISOMAP_NAMESPACE_BEGIN
 
+kIndex MANIFOLD_CONSTRUCTOR_BLOCK_ELEMENTS = 1 << 24; //!< Number of the squared distances converted per block, to bound the memory of the landmark blocks.
+
+//! Function to get a row of the landmark to all distances: the landmark, and the buffer receiving its distances to all the points.
+typedef std::function<void(Index, Scalar *)> DistanceRowSource;
+
 std::shared_ptr<gsl::Matrix> ConstructManifold(const gsl::Matrix &landmark_to_all_distances, const gsl::Matrix &landmark_distances, const gsl::Embedding &landmark_cmds_embedding, Index reduced_dimensions);
 
+//! Construct the manifold coordinates from the landmark to all distances given row by row, e.g. stored as float or
+//! on disk. The rows are converted to squared distances a block of landmarks at a time.
+std::shared_ptr<gsl::Matrix> ConstructManifold(Index points, const DistanceRowSource &landmark_to_all_row, const gsl::Matrix &landmark_distances, const gsl::Embedding &landmark_cmds_embedding, Index reduced_dimensions);
+
 HSISOMAP_NAMESPACE_END
 
 #endif //HSISOMAP_MANIFOLDCONSTRUCTOR_H
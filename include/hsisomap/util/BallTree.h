@@ -0,0 +1,100 @@
+//***************************************************************************************
+//
+//! \file BallTree.h
+//!  Ball tree and dual-tree all k nearest neighbor search.
+//!
+//! Each node of a ball tree bounds its points by a ball (the centroid and the largest distance to it). Nodes are
+//! split at the median projection on the line between two far apart points.
+//!
+//! The dual-tree search traverses a query tree and a reference tree together. A pair of nodes is pruned as a whole
+//! when the smallest possible distance between their balls exceeds the largest current k-th neighbor distance of
+//! the query node, so most query points never meet most reference nodes. The search is exact.
+//!
+//! Please see R. Curtin et al., "Tree-Independent Dual-Tree Algorithms", ICML 2013 for details.
+//!
+//! \version   1.0
+//! \date      2026-10-19
+//! \copyright GNU Public License V3.0
+//
+//***************************************************************************************
+
+#ifndef HSISOMAP_BALLTREE_H
+#define HSISOMAP_BALLTREE_H
+
+#include <hsisomap/Matrix.h>
+#include "../typedefs.h"
+
+HSISOMAP_NAMESPACE_BEGIN
+
+//! Ball tree over the rows of a matrix.
+class BallTree {
+ public:
+
+  //! Build the tree.
+  //! \param data the data matrix. The rows are the points. It is not copied and needs to outlive the tree.
+  //! \param leaf_size the maximum number of points in a leaf.
+  BallTree(const gsl_matrix *data, Index leaf_size = 32);
+
+  //! Get the number of points.
+  Index size() const { return order_.size(); }
+
+ private:
+  friend class DualTreeKNNTraversal;
+  friend class ComponentNearestSearch;
+
+  struct Node {
+    Index begin; //!< First position of the node in the point order.
+    Index end;
+    Index left; //!< Left child, or NO_CHILD for a leaf.
+    Index right;
+    Index parent;
+    Scalar radius; //!< Largest distance from the centroid to a point of the node.
+  };
+
+  static kIndex NO_CHILD = static_cast<Index>(-1);
+
+  const Scalar *point(Index row) const { return data_->data + row * data_->tda; }
+  const Scalar *center(Index node) const { return &centers_[node * data_->size2]; }
+  Index AddNode(Index begin, Index end, Index parent);
+  void Build();
+
+  const gsl_matrix *data_;
+  Index leaf_size_;
+  std::vector<Index> order_; //!< Point order; every node is a contiguous range.
+  std::vector<Node> nodes_; //!< The root is node 0.
+  std::vector<Scalar> centers_;
+};
+
+//! Dual-tree exact k nearest neighbor search of every query point among the reference points.
+//!
+//! The query tree is split into independent subtrees that are searched on multiple threads. A query point that is
+//! also a reference point finds itself at distance zero.
+//! \param queries the ball tree of the query points.
+//! \param reference the ball tree of the reference points, with the same number of columns.
+//! \param k the number of neighbors. It is capped at the number of reference points.
+//! \param indices receives the row major query count x k table of reference rows, closest first per query.
+//! \param distance_squares receives the matching table of squared distances.
+//! \param threads the number of threads. Zero uses all hardware threads.
+void DualTreeKNN(const BallTree &queries, const BallTree &reference, Index k, std::vector<Index> *indices,
+                 std::vector<Scalar> *distance_squares, Index threads = 0);
+
+//! Component-aware nearest neighbor search, the step of Borůvka's algorithm: for each of the given components,
+//! find the shortest edge from one of its points to a point of another component.
+//!
+//! Subtrees whose points all belong to the searched component are pruned as a whole, as are subtrees farther than
+//! the best edge of the component so far. The components are searched on multiple threads.
+//! \param tree the ball tree of the points.
+//! \param labels the component label of every point (row of the tree data).
+//! \param members the points of each component to search from. Each list holds points of a single label.
+//! \param edges receives per component the (own point, outside point) pair of the shortest edge. The pair is
+//! (own point, own point) if all points have the same label.
+//! \param distance_squares receives per component the squared length of the shortest edge.
+//! \param threads the number of threads. Zero uses all hardware threads.
+void ComponentNearestNeighbors(const BallTree &tree, const std::vector<Index> &labels,
+                               const std::vector<std::vector<Index>> &members,
+                               std::vector<std::pair<Index, Index>> *edges, std::vector<Scalar> *distance_squares,
+                               Index threads = 0);
+
+HSISOMAP_NAMESPACE_END
+
+#endif //HSISOMAP_BALLTREE_H
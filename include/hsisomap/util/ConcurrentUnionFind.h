@@ -0,0 +1,93 @@
+//***************************************************************************************
+//
+//! \file ConcurrentUnionFind.h
+//!  Lock-free union-find for building connectivity from several threads.
+//!
+//! The parent links are atomics updated with compare-and-swap. A root is always linked below a root with a smaller
+//! index, so the links only point to smaller indices and no cycle can form whatever the interleaving. Find shortens
+//! the paths it walks by halving; a lost race on a halving step is harmless, as another thread has already moved
+//! the link closer to the root. Linking by index gives up the balance of union by size, and the path halving keeps
+//! the trees flat in its place.
+//!
+//! \version   1.0
+//! \date      2026-10-19
+//! \copyright GNU Public License V3.0
+//
+//***************************************************************************************
+
+#ifndef HSISOMAP_CONCURRENTUNIONFIND_H
+#define HSISOMAP_CONCURRENTUNIONFIND_H
+
+#include <atomic>
+#include <vector>
+#include "../typedefs.h"
+
+HSISOMAP_NAMESPACE_BEGIN
+
+//! Union-find whose Find, Connect and connected can be called concurrently.
+class ConcurrentUnionFind {
+ public:
+
+  //! Constructor.
+  //! \param count the number of elements, each in its own set.
+  ConcurrentUnionFind(Index count) : parent_(count), count_(count) {
+    for (Index i = 0; i < count; ++i) parent_[i].store(i, std::memory_order_relaxed);
+  }
+
+  //! Get the number of sets. It is exact once the concurrent updates have finished.
+  //! \return the number of sets.
+  Index count() const { return count_.load(); }
+
+  //! Find the representative of the set of an element. The representative is the smallest element of the set.
+  //! \param p the element.
+  //! \return the representative.
+  Index Find(Index p) {
+    while (true) {
+      Index parent = parent_[p].load(std::memory_order_acquire);
+      Index grandparent = parent_[parent].load(std::memory_order_acquire);
+      if (parent == grandparent) return parent;
+      parent_[p].compare_exchange_weak(parent, grandparent, std::memory_order_release, std::memory_order_relaxed);
+      p = grandparent;
+    }
+  }
+
+  //! Test whether two elements are in the same set.
+  //! \param p the first element.
+  //! \param q the second element.
+  //! \return true if the elements are in the same set.
+  bool connected(Index p, Index q) {
+    while (true) {
+      p = Find(p);
+      q = Find(q);
+      if (p == q) return true;
+      // p was a root after q was found, so the two sets were distinct at that point.
+      if (parent_[p].load(std::memory_order_acquire) == p) return false;
+    }
+  }
+
+  //! Merge the sets of two elements.
+  //! \param p the first element.
+  //! \param q the second element.
+  //! \return true if the sets were distinct and this call merged them.
+  bool Connect(Index p, Index q) {
+    while (true) {
+      p = Find(p);
+      q = Find(q);
+      if (p == q) return false;
+      if (p < q) std::swap(p, q);
+      Index expected = p;
+      if (parent_[p].compare_exchange_strong(expected, q, std::memory_order_acq_rel)) {
+        count_.fetch_sub(1);
+        return true;
+      }
+    }
+  }
+
+ private:
+  std::vector<std::atomic<Index>> parent_;
+  std::atomic<Index> count_;
+};
+
+HSISOMAP_NAMESPACE_END
+
+#endif //HSISOMAP_CONCURRENTUNIONFIND_H
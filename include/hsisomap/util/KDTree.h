@@ -0,0 +1,193 @@
+//***************************************************************************************
+//
+//! \file KDTree.h
+//!  KD-tree over low-dimensional coordinates with filter-and-refine k nearest neighbor search.
+//!
+//! The tree indexes a low-dimensional representation of the data, typically the leading components after an
+//! orthonormal rotation. The squared distance in the tree coordinates must be a lower bound of the exact squared
+//! distance. The search visits the nodes closest first, computes the exact distance only for points whose lower
+//! bound can still enter the current top k, and stops once no remaining node can. The result is therefore exact.
+//!
+//! \version   1.0
+//! \date      2026-10-19
+//! \copyright GNU Public License V3.0
+//
+//***************************************************************************************
+
+#ifndef HSISOMAP_KDTREE_H
+#define HSISOMAP_KDTREE_H
+
+#include <hsisomap/Matrix.h>
+#include <functional>
+#include <numeric>
+#include <queue>
+#include "../typedefs.h"
+
+HSISOMAP_NAMESPACE_BEGIN
+
+class KDTree {
+ public:
+
+  //! Build the tree.
+  //! \param points the low-dimensional coordinates. The rows are the samples. The matrix is copied.
+  //! \param leaf_size the maximum number of points in a leaf.
+  KDTree(const gsl::Matrix &points, Index leaf_size = 16)
+      : rows_(points.rows()), dimensions_(points.cols()), leaf_size_(std::max<Index>(1, leaf_size)),
+        order_(points.rows()) {
+    coordinates_.resize(rows_ * dimensions_);
+    for (Index r = 0; r < rows_; ++r) {
+      std::copy(points.m_->data + r * points.m_->tda, points.m_->data + r * points.m_->tda + dimensions_,
+                coordinates_.begin() + r * dimensions_);
+    }
+    std::iota(order_.begin(), order_.end(), 0);
+    if (rows_ > 0) Build();
+  }
+
+  //! Search the exact k nearest points of a query.
+  //! \param query pointer to the low-dimensional coordinates of the query.
+  //! \param k the number of neighbors.
+  //! \param exact callable returning the exact squared distance from the query to point i, as exact(Index i).
+  //! \param indices receives the indices of the neighbors, closest first.
+  //! \param distance_squares receives the exact squared distances of the neighbors.
+  //! \return the number of exact distance evaluations.
+  template<typename ExactDistance>
+  Index Search(const Scalar *query, Index k, ExactDistance exact, std::vector<Index> *indices,
+               std::vector<Scalar> *distance_squares) const {
+    k = std::min(k, rows_);
+    indices->clear();
+    distance_squares->clear();
+    if (k == 0) return 0;
+
+    std::priority_queue<std::pair<Scalar, Index>> heap; // (exact distance, index), farthest on top
+    Scalar tau = std::numeric_limits<Scalar>::max();
+    Index evaluations = 0;
+
+    typedef std::pair<Scalar, Index> Entry; // (lower bound, node)
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    queue.push(Entry(BoxDistance(nodes_[0], query), 0));
+
+    while (!queue.empty() && queue.top().first <= tau) {
+      const Node &node = nodes_[queue.top().second];
+      queue.pop();
+
+      if (node.left == NO_CHILD) {
+        for (Index p = node.begin; p < node.end; ++p) {
+          Index i = order_[p];
+          const Scalar *coordinates = &coordinates_[i * dimensions_];
+          Scalar bound = 0;
+          for (Index d = 0; d < dimensions_ && bound <= tau; ++d) {
+            bound += (query[d] - coordinates[d]) * (query[d] - coordinates[d]);
+          }
+          if (bound > tau) continue;
+          Scalar distance = exact(i);
+          ++evaluations;
+          if (heap.size() < k) {
+            heap.push(std::make_pair(distance, i));
+          } else if (distance < heap.top().first) {
+            heap.pop();
+            heap.push(std::make_pair(distance, i));
+          }
+          if (heap.size() == k) tau = heap.top().first;
+        }
+        continue;
+      }
+
+      Scalar left_bound = BoxDistance(nodes_[node.left], query);
+      Scalar right_bound = BoxDistance(nodes_[node.right], query);
+      if (left_bound <= tau) queue.push(Entry(left_bound, node.left));
+      if (right_bound <= tau) queue.push(Entry(right_bound, node.right));
+    }
+
+    while (!heap.empty()) {
+      indices->push_back(heap.top().second);
+      distance_squares->push_back(heap.top().first);
+      heap.pop();
+    }
+    std::reverse(indices->begin(), indices->end());
+    std::reverse(distance_squares->begin(), distance_squares->end());
+    return evaluations;
+  }
+
+ private:
+  struct Node {
+    Index begin;
+    Index end;
+    Index left;
+    Index right;
+    Index box; //!< Offset of the bounding box (lower corner followed by upper corner) in boxes_.
+  };
+
+  static kIndex NO_CHILD = static_cast<Index>(-1);
+
+  Scalar BoxDistance(const Node &node, const Scalar *query) const {
+    const Scalar *lower = &boxes_[node.box];
+    const Scalar *upper = lower + dimensions_;
+    Scalar distance = 0;
+    for (Index d = 0; d < dimensions_; ++d) {
+      Scalar gap = std::max(std::max(lower[d] - query[d], query[d] - upper[d]), 0.0);
+      distance += gap * gap;
+    }
+    return distance;
+  }
+
+  Index AddNode(Index begin, Index end) {
+    Node node = {begin, end, NO_CHILD, NO_CHILD, boxes_.size()};
+    boxes_.resize(boxes_.size() + 2 * dimensions_);
+    Scalar *lower = &boxes_[node.box];
+    Scalar *upper = lower + dimensions_;
+    std::fill(lower, upper, std::numeric_limits<Scalar>::max());
+    std::fill(upper, upper + dimensions_, -std::numeric_limits<Scalar>::max());
+    for (Index p = begin; p < end; ++p) {
+      const Scalar *coordinates = &coordinates_[order_[p] * dimensions_];
+      for (Index d = 0; d < dimensions_; ++d) {
+        lower[d] = std::min(lower[d], coordinates[d]);
+        upper[d] = std::max(upper[d], coordinates[d]);
+      }
+    }
+    nodes_.push_back(node);
+    return nodes_.size() - 1;
+  }
+
+  void Build() {
+    std::vector<Index> stack(1, AddNode(0, rows_));
+    while (!stack.empty()) {
+      Index id = stack.back();
+      stack.pop_back();
+      Index begin = nodes_[id].begin, end = nodes_[id].end;
+      if (end - begin <= leaf_size_) continue;
+
+      // Split the widest dimension at the median.
+      const Scalar *lower = &boxes_[nodes_[id].box];
+      const Scalar *upper = lower + dimensions_;
+      Index split = 0;
+      for (Index d = 1; d < dimensions_; ++d) {
+        if (upper[d] - lower[d] > upper[split] - lower[split]) split = d;
+      }
+      if (dimensions_ == 0 || upper[split] <= lower[split]) continue; // All points coincide, keep it as a leaf.
+
+      Index median = (begin + end) / 2;
+      std::nth_element(order_.begin() + begin, order_.begin() + median, order_.begin() + end,
+                       [this, split](Index a, Index b) {
+                         return coordinates_[a * dimensions_ + split] < coordinates_[b * dimensions_ + split];
+                       });
+      Index left = AddNode(begin, median);
+      Index right = AddNode(median, end);
+      nodes_[id].left = left;
+      nodes_[id].right = right;
+      stack.push_back(left);
+      stack.push_back(right);
+    }
+  }
+
+  Index rows_;
+  Index dimensions_;
+  Index leaf_size_;
+  std::vector<Scalar> coordinates_;
+  std::vector<Index> order_;
+  std::vector<Node> nodes_;
+  std::vector<Scalar> boxes_;
+};
+
+HSISOMAP_NAMESPACE_END
+
+#endif //HSISOMAP_KDTREE_H
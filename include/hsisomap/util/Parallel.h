@@ -0,0 +1,160 @@
+//***************************************************************************************
+//
+//! \file Parallel.h
+//!  Minimal thread helpers shared by the multi-threaded parts of the library.
+//!
+//! \version   1.0
+//! \date      2026-10-19
+//! \copyright GNU Public License V3.0
+//
+//***************************************************************************************
+
+#ifndef HSISOMAP_PARALLEL_H
+#define HSISOMAP_PARALLEL_H
+
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../typedefs.h"
+
+HSISOMAP_NAMESPACE_BEGIN
+
+Key PARALLEL_THREADS = "PARALLEL_THREADS"; //!< (Optional) Property list key, specify the number of worker threads. Zero (default) uses all hardware threads.
+
+//! Resolve the number of worker threads to use.
+//! \param requested the requested number of threads. Zero means all hardware threads.
+//! \return the number of threads, at least one.
+inline Index ParallelThreadCount(Index requested = 0) {
+  if (requested > 0) return requested;
+  Index hardware = static_cast<Index>(std::thread::hardware_concurrency());
+  return hardware > 0 ? hardware : 1;
+}
+
+//! Run body(i, thread) for every i in [begin, end) on a number of worker threads.
+//!
+//! Iterations are handed out dynamically in chunks, so uneven per-iteration costs are balanced between the threads.
+//! The thread argument is in [0, threads) and can be used to index per-thread buffers. If any iteration throws,
+//! the remaining iterations are skipped and the first exception is rethrown on the calling thread.
+//! \param begin the first iteration.
+//! \param end one past the last iteration.
+//! \param body the callable invoked as body(Index i, Index thread).
+//! \param threads the number of worker threads. Zero means all hardware threads.
+//! \param chunk the number of consecutive iterations taken at once. Zero picks a chunk size from the range size.
+template<typename Function>
+void ParallelFor(Index begin, Index end, Function body, Index threads = 0, Index chunk = 0) {
+  if (end <= begin) return;
+  threads = std::min(ParallelThreadCount(threads), end - begin);
+  if (chunk == 0) chunk = std::max<Index>(1, (end - begin) / (threads * 16));
+
+  if (threads == 1) {
+    for (Index i = begin; i < end; ++i) body(i, 0);
+    return;
+  }
+
+  std::atomic<Index> next(begin);
+  std::atomic<bool> failed(false);
+  std::exception_ptr exception;
+  std::mutex exception_mutex;
+
+  auto worker = [&](Index thread) {
+    try {
+      while (!failed.load(std::memory_order_relaxed)) {
+        Index first = next.fetch_add(chunk);
+        if (first >= end) break;
+        Index last = std::min(first + chunk, end);
+        for (Index i = first; i < last; ++i) body(i, thread);
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(exception_mutex);
+      if (!exception) exception = std::current_exception();
+      failed = true;
+    }
+  };
+
+  std::vector<std::thread> pool;
+  pool.reserve(threads - 1);
+  for (Index t = 1; t < threads; ++t) pool.emplace_back(worker, t);
+  worker(0);
+  for (auto &thread : pool) thread.join();
+
+  if (exception) std::rethrow_exception(exception);
+}
+
+//! A reusable barrier for the threads of a ParallelTeam.
+//!
+//! The waiting threads yield instead of sleeping, since the team phases it separates are short.
+class ParallelBarrier {
+ public:
+  //! Thrown by Wait on the other threads once a thread of the team has failed, so that none of them waits forever.
+  struct Broken { };
+
+  //! Constructor.
+  //! \param threads the number of threads of the team.
+  explicit ParallelBarrier(Index threads) : threads_(threads), waiting_(0), generation_(0), broken_(false) { }
+
+  //! Wait until all the threads of the team have arrived. The writes of every thread before the barrier are
+  //! visible to all the threads after it.
+  void Wait() {
+    Index generation = generation_.load(std::memory_order_acquire);
+    if (waiting_.fetch_add(1, std::memory_order_acq_rel) + 1 == threads_) {
+      waiting_.store(0, std::memory_order_relaxed);
+      generation_.fetch_add(1, std::memory_order_acq_rel);
+    } else {
+      while (generation_.load(std::memory_order_acquire) == generation) {
+        if (broken_.load(std::memory_order_relaxed)) throw Broken();
+        std::this_thread::yield();
+      }
+    }
+    if (broken_.load(std::memory_order_relaxed)) throw Broken();
+  }
+
+  //! Release the waiting threads, and make all the later waits throw Broken.
+  void Break() { broken_ = true; }
+
+ private:
+  const Index threads_;
+  std::atomic<Index> waiting_;
+  std::atomic<Index> generation_;
+  std::atomic<bool> broken_;
+};
+
+//! Run body(thread, barrier) once on each of a number of threads, which share the barrier.
+//!
+//! Unlike ParallelFor, the threads live for the whole body, so an algorithm of many short parallel phases starts
+//! its threads once and separates the phases with barrier.Wait(). All the threads need to wait on the barrier the
+//! same number of times. If the body throws on a thread, the barrier is broken so the other threads leave their
+//! bodies too, and the first exception is rethrown on the calling thread.
+//! \param threads the number of threads. Zero means all hardware threads.
+//! \param body the callable invoked as body(Index thread, ParallelBarrier &barrier).
+template<typename Function>
+void ParallelTeam(Index threads, Function body) {
+  threads = ParallelThreadCount(threads);
+  ParallelBarrier barrier(threads);
+  std::exception_ptr exception;
+  std::mutex exception_mutex;
+
+  auto worker = [&](Index thread) {
+    try {
+      body(thread, barrier);
+    } catch (ParallelBarrier::Broken &) {
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(exception_mutex);
+      if (!exception) exception = std::current_exception();
+      barrier.Break();
+    }
+  };
+
+  std::vector<std::thread> pool;
+  pool.reserve(threads - 1);
+  for (Index t = 1; t < threads; ++t) pool.emplace_back(worker, t);
+  worker(0);
+  for (auto &thread : pool) thread.join();
+
+  if (exception) std::rethrow_exception(exception);
+}
+
+HSISOMAP_NAMESPACE_END
+
+#endif //HSISOMAP_PARALLEL_H
@@ -0,0 +1,75 @@
+//***************************************************************************************
+//
+//! \file PivotTable.h
+//!  Pivot table of precomputed distances, for triangle inequality lower bounds (LAESA).
+//!
+//! A few pivot rows are chosen by max-min spread: each new pivot is the row farthest from the pivots chosen so far.
+//! The Euclidean distances of all rows to the pivots are stored as float32. For a query with known distances to
+//! the pivots, max over the pivots of |d(q, p) - d(x, p)| is a lower bound of d(q, x). A search evaluates a full
+//! spectral distance only for the rows whose bound does not already exclude them.
+//!
+//! Please see L. Mico et al., "A new version of the nearest-neighbour approximating and eliminating search algorithm
+//! (AESA) with linear preprocessing time and memory requirements", Pattern Recognition Letters 15, 1994.
+//!
+//! \version   1.0
+//! \date      2026-10-19
+//! \copyright GNU Public License V3.0
+//
+//***************************************************************************************
+
+#ifndef HSISOMAP_PIVOTTABLE_H
+#define HSISOMAP_PIVOTTABLE_H
+
+#include <hsisomap/Matrix.h>
+#include <cmath>
+#include "../typedefs.h"
+
+HSISOMAP_NAMESPACE_BEGIN
+
+kScalar PIVOT_TABLE_FLOAT_TOLERANCE = 1.2e-7; //!< Relative rounding error of the float32 table, with a margin.
+
+//! Pivot table over the rows of a matrix.
+class PivotTable {
+ public:
+
+  //! Choose the pivots and compute the table.
+  //! \param data the data matrix. The rows are the points. The pivot rows are copied.
+  //! \param pivots the number of pivots. It is capped at the number of rows.
+  //! \param threads the number of threads computing the table. Zero uses all hardware threads.
+  PivotTable(const gsl_matrix *data, Index pivots, Index threads = 0);
+
+  //! Get the number of pivots.
+  Index pivots() const { return pivot_rows_.size(); }
+
+  //! Get the rows chosen as pivots, in the order they were chosen.
+  const std::vector<Index> &pivot_rows() const { return pivot_rows_; }
+
+  //! Compute the Euclidean distances from a query to the pivots.
+  //! \param query pointer to the query, with as many values as the data columns.
+  //! \param distances receives the pivots() distances.
+  void QueryDistances(const Scalar *query, Scalar *distances) const;
+
+  //! Get a lower bound of the Euclidean distance between a query and a row.
+  //! \param query_distances the distances of the query to the pivots, from QueryDistances.
+  //! \param row the row of the data matrix.
+  //! \return the lower bound, not squared. The float32 rounding of the table is accounted for.
+  Scalar LowerBound(const Scalar *query_distances, Index row) const {
+    const float *row_distances = &table_[row * pivots()];
+    Scalar bound = 0;
+    for (Index p = 0; p < pivots(); ++p) {
+      Scalar distance = row_distances[p];
+      bound = std::max(bound, std::abs(query_distances[p] - distance) - PIVOT_TABLE_FLOAT_TOLERANCE * distance);
+    }
+    return bound;
+  }
+
+ private:
+  Index dimensions_;
+  std::vector<Index> pivot_rows_;
+  std::vector<Scalar> pivot_data_; //!< The pivot rows, pivots() x dimensions_.
+  std::vector<float> table_; //!< Row major rows x pivots() table of distances.
+};
+
+HSISOMAP_NAMESPACE_END
+
+#endif //HSISOMAP_PIVOTTABLE_H
@@ -0,0 +1,83 @@
+//***************************************************************************************
+//
+//! \file RPForest.h
+//!  A forest of random projection trees for approximate k nearest neighbor candidate generation.
+//!
+//! Each tree splits its points recursively by the hyperplane that bisects two randomly chosen points of the node,
+//! falling back to the median of the projections when the bisector does not separate them. Points ending in the
+//! same leaf of any tree are candidates to be neighbors. A query descends all trees at once, visiting the branches
+//! closest to the splitting hyperplanes first, until enough candidates are collected. The candidates are then
+//! ranked by exact distance.
+//!
+//! The trees only store the pivot rows and thresholds, so the data matrix needs to outlive the forest.
+//!
+//! \version   1.0
+//! \date      2026-10-19
+//! \copyright GNU Public License V3.0
+//
+//***************************************************************************************
+
+#ifndef HSISOMAP_RPFOREST_H
+#define HSISOMAP_RPFOREST_H
+
+#include <hsisomap/Matrix.h>
+#include <random>
+#include "../typedefs.h"
+
+HSISOMAP_NAMESPACE_BEGIN
+
+//! A forest of random projection trees for approximate k nearest neighbor candidate generation.
+class RPForest {
+ public:
+
+  //! Build the forest. The trees are built in parallel.
+  //! \param data the data matrix. The rows are the samples. It needs to outlive the forest.
+  //! \param trees the number of trees.
+  //! \param leaf_size the maximum number of points in a leaf.
+  //! \param seed the random seed. Zero uses a random seed.
+  //! \param threads the number of threads. Zero uses all hardware threads.
+  RPForest(const gsl::Matrix &data, Index trees, Index leaf_size, Index seed = 0, Index threads = 0);
+
+  //! Search the approximate k nearest data rows of a query.
+  //!
+  //! At least max(k, leaf size) * trees candidate entries (with repetitions) are visited, and at least k distinct
+  //! rows, unless the forest holds fewer.
+  //! \param query pointer to the query vector, with the same number of elements as the data columns.
+  //! \param k the number of neighbors.
+  //! \param indices receives the data row indices of the neighbors, closest first.
+  //! \param distance_squares receives the squared distances of the neighbors.
+  //! \param search_candidates (Optional) the number of candidate entries to visit. Zero uses the default above.
+  void Search(const Scalar *query, Index k, std::vector<Index> *indices, std::vector<Scalar> *distance_squares,
+              Index search_candidates = 0) const;
+
+  //! Get the number of trees.
+  Index trees() const { return nodes_.size(); }
+  //! Get the maximum leaf size.
+  Index leaf_size() const { return leaf_size_; }
+
+ private:
+  struct Node {
+    Index pivot_a; //!< Points whose projection is above the threshold go to the left child.
+    Index pivot_b;
+    Scalar threshold; //!< Threshold of |x - b|^2 - |x - a|^2.
+    Scalar scale; //!< 2 |a - b|, converting projection differences to distances from the hyperplane.
+    Index left; //!< Left child, or NO_CHILD for a leaf.
+    Index right;
+    Index begin; //!< First position of the leaf in the point order.
+    Index end;
+  };
+
+  static kIndex NO_CHILD = static_cast<Index>(-1);
+
+  Scalar Project(const Node &node, const Scalar *x) const;
+  void BuildTree(Index tree, std::mt19937 &rng);
+
+  const gsl::Matrix &data_;
+  Index leaf_size_;
+  std::vector<std::vector<Node>> nodes_; //!< Nodes of each tree; the root is node 0.
+  std::vector<std::vector<Index>> order_; //!< Point order of each tree; every leaf is a contiguous range.
+};
+
+HSISOMAP_NAMESPACE_END
+
+#endif //HSISOMAP_RPFOREST_H
@@ -0,0 +1,98 @@
+//***************************************************************************************
+//
+//! \file RadixHeap.h
+//!  Monotone radix heap over 64-bit integer keys.
+//!
+//! The keys pushed are never below the last key popped, as in Dijkstra's algorithm with non-negative weights.
+//! Bucket i holds the keys whose highest bit differing from the last popped key is bit i - 1, and bucket 0 the
+//! keys equal to it. A pop takes bucket 0, or first redistributes the lowest non-empty bucket around its minimum,
+//! so every key moves to lower buckets at most 64 times over its life, with no comparisons between the entries.
+//!
+//! \version   1.0
+//! \date      2026-10-19
+//! \copyright GNU Public License V3.0
+//
+//***************************************************************************************
+
+#ifndef HSISOMAP_RADIXHEAP_H
+#define HSISOMAP_RADIXHEAP_H
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "../typedefs.h"
+
+HSISOMAP_NAMESPACE_BEGIN
+
+template<typename T_Value>
+class RadixHeap {
+ public:
+  typedef std::uint64_t Key;
+  typedef std::pair<Key, T_Value> Entry;
+
+  RadixHeap() : buckets_(65), last_(0), size_(0) { }
+
+  bool empty() const { return size_ == 0; }
+  Index size() const { return size_; }
+
+  //! Remove all the entries, and accept any key from zero again. The bucket capacities are kept.
+  void clear() {
+    for (auto &bucket : buckets_) bucket.clear();
+    last_ = 0;
+    size_ = 0;
+  }
+
+  //! Add an entry. The key must not be below the last popped key.
+  void push(Key key, T_Value value) {
+    if (key < last_) throw std::invalid_argument("RadixHeap key below the last popped key.");
+    buckets_[BucketOf(key)].push_back(Entry(key, value));
+    ++size_;
+  }
+
+  //! Remove and return an entry with the minimum key. The heap must not be empty.
+  Entry pop() {
+    if (buckets_[0].empty()) {
+      Index i = 1;
+      while (buckets_[i].empty()) ++i;
+      Key minimum = buckets_[i][0].first;
+      for (const Entry &entry : buckets_[i]) minimum = std::min(minimum, entry.first);
+      last_ = minimum;
+      // Every entry of bucket i lands in a lower bucket relative to the new last key
+      for (const Entry &entry : buckets_[i]) buckets_[BucketOf(entry.first)].push_back(entry);
+      buckets_[i].clear();
+    }
+    Entry entry = buckets_[0].back();
+    buckets_[0].pop_back();
+    --size_;
+    return entry;
+  }
+
+ private:
+  //! The bucket of a key: one plus the position of the highest bit differing from the last popped key.
+  Index BucketOf(Key key) const {
+    Key bits = key ^ last_;
+    if (!bits) return 0;
+#if defined(__GNUC__)
+    return 64 - __builtin_clzll(bits);
+#else
+    Index bucket = 1;
+    for (Index shift = 32; shift > 0; shift /= 2) {
+      if (bits >> shift) {
+        bits >>= shift;
+        bucket += shift;
+      }
+    }
+    return bucket;
+#endif
+  }
+
+  std::vector<std::vector<Entry>> buckets_;
+  Key last_;
+  Index size_;
+};
+
+HSISOMAP_NAMESPACE_END
+
+#endif //HSISOMAP_RADIXHEAP_H
@@ -12,6 +12,7 @@
 HSISOMAP_NAMESPACE_BEGIN
 
 
+//! Union-find with union by size and path halving. It is not thread-safe; see ConcurrentUnionFind.
 class UnionFind 
 {
  public:
@@ -20,7 +21,10 @@ class UnionFind
   }
   Index count() { return count_; }
   Index Find(Index p) {
-    while (p != id_[p]) p = id_[p];
+    while (p != id_[p]) {
+      id_[p] = id_[id_[p]];
+      p = id_[p];
+    }
     return p;
   }
   bool connected(Index p, Index q) { return Find(p) == Find(q); }
@@ -6,6 +6,10 @@
 #define HSISOMAP_VPTREE_H
 
 #include <hsisomap/Matrix.h>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
 #include <queue>
 #include <gsl/gsl_matrix_double.h>
 #include "../typedefs.h"
@@ -13,27 +17,190 @@
 HSISOMAP_NAMESPACE_BEGIN
 
 
+// Counters of a tree since the last reset. The search counters add up all queries, concurrent ones included; divide
+// them by the number of queries for per query figures.
+struct VpTreeStats {
+  uint64_t queries;
+  uint64_t nodes_visited; // Including the subtrees skipped for holding only deleted items.
+  uint64_t distance_evaluations;
+  uint64_t build_distance_evaluations; // Distances computed by the builds and rebuilds, vantage point selection included.
+};
+
+// A node of a flattened tree, in pre-order. The children are positions in the node array, or -1. The layout is
+// fixed so that the array can be stored to and mapped from files.
+struct VpTreeFlatNode {
+  int32_t index; // Id of the vantage item.
+  int32_t left;
+  int32_t right;
+  int32_t deleted;
+  double threshold;
+};
+
 template<typename T, double (*distance)(const T &, const T &)>
 class VpTree {
  public:
-  VpTree() : _root(0) { }
+  VpTree() : _root(0), _vantage_candidates(1), _vantage_samples(0) { reset_stats(); }
+
+  // Set how vantage points are selected for the following builds and rebuilds. With one candidate (default) a
+  // random item is taken. With more, each candidate's distances to a random sample of the node's items are
+  // measured and the candidate with the largest spread (variance of the metric distances) is taken, as proposed by
+  // Yianilos. A sample of zero uses as many items as candidates times four.
+  void set_vantage_selection(int candidates, int samples = 0) {
+    _vantage_candidates = std::max(1, candidates);
+    _vantage_samples = samples > 0 ? samples : 4 * _vantage_candidates;
+  }
+
+  // The vantage point selection in effect, see set_vantage_selection().
+  int vantage_candidates() const { return _vantage_candidates; }
+  int vantage_samples() const { return _vantage_samples; }
+
+  VpTreeStats stats() const {
+    VpTreeStats stats;
+    stats.queries = _queries.load();
+    stats.nodes_visited = _nodes_visited.load();
+    stats.distance_evaluations = _distance_evaluations.load();
+    stats.build_distance_evaluations = _build_distance_evaluations.load();
+    return stats;
+  }
+
+  void reset_stats() {
+    _queries = 0;
+    _nodes_visited = 0;
+    _distance_evaluations = 0;
+    _build_distance_evaluations = 0;
+  }
 
   ~VpTree() {
     delete _root;
   }
 
+  // The items keep their position in the vector as id, for erase().
   void create(const std::vector<T> &items) {
     delete _root;
     _items = items;
-    _root = buildFromPoints(0, (int) items.size());
+    _deleted.assign(items.size(), 0);
+    _node_of.assign(items.size(), NULL);
+    _live = (int) items.size();
+    std::vector<int> slots(items.size());
+    std::iota(slots.begin(), slots.end(), 0);
+    _root = buildFromPoints(slots, 0, (int) slots.size(), NULL);
+  }
+
+  // Restore a tree from its flattened nodes (see flatten()) over the same items, without computing any distance.
+  // Every item must appear in exactly one node.
+  void create(const std::vector<T> &items, const VpTreeFlatNode *nodes, size_t count) {
+    if (count != items.size()) throw std::invalid_argument("VpTree nodes do not match the items.");
+    delete _root;
+    _root = NULL;
+    _items = items;
+    _deleted.assign(items.size(), 0);
+    _node_of.assign(items.size(), NULL);
+    _live = 0;
+    try {
+      if (count > 0) _root = restoreNode(nodes, count, 0, NULL);
+      if (subtreeSize(_root) != (int) count) throw std::invalid_argument("Invalid VpTree node.");
+    } catch (...) {
+      delete _root;
+      _root = NULL;
+      _items.clear();
+      _deleted.clear();
+      _node_of.clear();
+      _live = 0;
+      throw;
+    }
   }
 
+  // Flatten the tree into a node array in pre-order, for storage.
+  std::vector<VpTreeFlatNode> flatten() const {
+    std::vector<VpTreeFlatNode> nodes;
+    nodes.reserve(_items.size());
+    flattenNode(_root, nodes);
+    return nodes;
+  }
+
+  // Insert an item and return its id. The item descends the tree like a search and becomes a new leaf. If a
+  // subtree on the path gets too unbalanced, the highest such subtree is rebuilt.
+  int insert(const T &item) {
+    int id = (int) _items.size();
+    _items.push_back(item);
+    _deleted.push_back(0);
+    ++_live;
+
+    Node *leaf = new Node();
+    leaf->index = id;
+    _node_of.push_back(leaf);
+    if (_root == NULL) {
+      _root = leaf;
+      return id;
+    }
+
+    Node *node = _root;
+    while (true) {
+      ++node->size;
+      ++node->live;
+      double root = std::sqrt(distance(_items[node->index], item));
+      ++_build_distance_evaluations;
+      // A leaf becomes a vantage point whose only child is the new item.
+      if (node->left == NULL && node->right == NULL) node->threshold = root;
+      Node *&child = root < node->threshold ? node->left : node->right;
+      if (child == NULL) {
+        child = leaf;
+        leaf->parent = node;
+        break;
+      }
+      node = child;
+    }
+
+    Node *scapegoat = NULL;
+    for (Node *p = leaf->parent; p != NULL; p = p->parent) {
+      int heavier = std::max(subtreeSize(p->left), subtreeSize(p->right));
+      if (p->size >= kRebuildMinSize && 4 * heavier > 3 * p->size) scapegoat = p;
+    }
+    if (scapegoat != NULL) rebuild(scapegoat);
+    return id;
+  }
+
+  // Erase an item by id. The item is only marked as deleted (a tombstone): it still routes the searches but is no
+  // longer returned. Once half of a subtree is deleted, the highest such subtree is rebuilt from its live items.
+  // Return false if the id is invalid or already erased.
+  bool erase(int id) {
+    if (id < 0 || id >= (int) _items.size() || _deleted[id]) return false;
+    _deleted[id] = 1;
+    --_live;
+
+    Node *candidate = NULL;
+    for (Node *p = _node_of[id]; p != NULL; p = p->parent) {
+      --p->live;
+      if (p->size >= kRebuildMinSize && 2 * p->live < p->size) candidate = p;
+    }
+    if (candidate != NULL) rebuild(candidate);
+    return true;
+  }
+
+  // The number of live items.
+  int size() const { return _live; }
+
+  bool erased(int id) const { return _deleted[id] != 0; }
+
+  // The search keeps its state on the stack, so concurrent searches on the same tree are safe.
+  // The optional tau is an upper bound of the distance to the k-th neighbor, e.g. the k-th smallest distance from
+  // the target to any k items of the tree. A tight bound prunes most of the tree from the start.
   void search(const T &target, int k, std::vector<T> *results,
-              std::vector<double> *distances) {
+              std::vector<double> *distances, double tau = std::numeric_limits<double>::max()) const {
+    search(target, k, results, distances, tau, [](int) { return 0.0; });
+  }
+
+  // Search with a cheap lower bound of the metric (square root) distance from the target to an item, as
+  // lower_bound(id), e.g. from a PivotTable. A node whose bound already excludes its item and its inside subtree is
+  // passed without evaluating its distance.
+  template<typename LowerBound>
+  void search(const T &target, int k, std::vector<T> *results,
+              std::vector<double> *distances, double tau, LowerBound lower_bound) const {
     std::priority_queue<HeapItem> heap;
 
-    _tau = std::numeric_limits<double>::max();
-    search(_root, target, k, heap);
+    Counters counters;
+    search(_root, target, k, heap, tau, lower_bound, counters);
+    record(counters);
 
     results->clear();
     distances->clear();
@@ -48,36 +215,48 @@ class VpTree {
     std::reverse(distances->begin(), distances->end());
   }
 
-  void search_r(const T &target, double dist_rad, std::vector<T> *results, std::vector<double> *distances) {
-    std::priority_queue<HeapItem> heap;
-
-    search_r(_root, target, dist_rad, heap);
+  // Radius search, closest first.
+  void search_r(const T &target, double dist_rad, std::vector<T> *results, std::vector<double> *distances) const {
+    std::vector<std::pair<double, const T *>> hits;
+    search_r(target, dist_rad, [&hits](const T &item, double dist) { hits.push_back(std::make_pair(dist, &item)); });
+    std::sort(hits.begin(), hits.end(), [](const std::pair<double, const T *> &a, const std::pair<double, const T *> &b) {
+      return a.first < b.first;
+    });
 
     results->clear();
     distances->clear();
-
-    while (!heap.empty()) {
-      results->push_back(_items[heap.top().index]);
-      distances->push_back(heap.top().dist);
-      heap.pop();
+    for (auto &hit : hits) {
+      results->push_back(*hit.second);
+      distances->push_back(hit.first);
     }
+  }
 
-    std::reverse(results->begin(), results->end());
-    std::reverse(distances->begin(), distances->end());
+  // Unordered radius search without allocation: visitor(item, dist) is called for every item within the radius,
+  // in tree order.
+  template<typename Visitor>
+  void search_r(const T &target, double dist_rad, Visitor &&visitor) const {
+    Counters counters;
+    search_r(_root, target, dist_rad, std::sqrt(dist_rad), visitor, counters);
+    record(counters);
   }
+
  private:
+  static const int kRebuildMinSize = 16;
+
   std::vector<T> _items;
-  double _tau;
-  int _k_found;
+  std::vector<char> _deleted;
 
   struct Node {
     int index;
     double threshold;
     Node *left;
     Node *right;
+    Node *parent;
+    int size; // Items in the subtree, deleted ones included.
+    int live;
 
     Node() :
-        index(0), threshold(0.), left(0), right(0) { }
+        index(0), threshold(0.), left(0), right(0), parent(0), size(1), live(1) { }
 
     ~Node() {
       delete left;
@@ -85,6 +264,57 @@ class VpTree {
     }
   } *_root;
 
+  std::vector<Node *> _node_of;
+  int _live = 0;
+
+  int _vantage_candidates;
+  int _vantage_samples;
+
+  // The counters of one query are kept on the stack and added to the tree counters at the end.
+  struct Counters {
+    uint64_t nodes_visited = 0;
+    uint64_t distance_evaluations = 0;
+  };
+  mutable std::atomic<uint64_t> _queries;
+  mutable std::atomic<uint64_t> _nodes_visited;
+  mutable std::atomic<uint64_t> _distance_evaluations;
+  std::atomic<uint64_t> _build_distance_evaluations;
+
+  void record(const Counters &counters) const {
+    _queries += 1;
+    _nodes_visited += counters.nodes_visited;
+    _distance_evaluations += counters.distance_evaluations;
+  }
+
+  // Pick the vantage point of slots[lower, upper), see set_vantage_selection().
+  int chooseVantage(const std::vector<int> &slots, int lower, int upper) {
+    int count = upper - lower;
+    if (_vantage_candidates == 1 || count <= 2) {
+      return (int) ((double) rand() / RAND_MAX * (count - 1)) + lower;
+    }
+
+    int samples = std::min(_vantage_samples, count);
+    int best = lower;
+    double best_spread = -1;
+    for (int c = 0; c < std::min(_vantage_candidates, count); ++c) {
+      int candidate = rand() % count + lower;
+      double sum = 0, sum_squares = 0;
+      for (int j = 0; j < samples; ++j) {
+        double root = std::sqrt(distance(_items[slots[candidate]], _items[slots[rand() % count + lower]]));
+        sum += root;
+        sum_squares += root * root;
+      }
+      _build_distance_evaluations += samples;
+      double mean = sum / samples;
+      double spread = sum_squares / samples - mean * mean;
+      if (spread > best_spread) {
+        best_spread = spread;
+        best = candidate;
+      }
+    }
+    return best;
+  }
+
   struct HeapItem {
     HeapItem(int index, double dist) :
         index(index), dist(dist) { }
@@ -95,119 +325,195 @@ class VpTree {
     }
   };
 
-  struct DistanceComparator {
-    const T &item;
-    DistanceComparator(const T &item) : item(item) { }
-    bool operator()(const T &a, const T &b) {
-      return distance(item, a) < distance(item, b);
-    }
-  };
+  static int subtreeSize(const Node *node) { return node == NULL ? 0 : node->size; }
 
-  Node *buildFromPoints(int lower, int upper) {
+  // Build a subtree over the items in slots[lower, upper). The slots are reordered; the items are not moved.
+  Node *buildFromPoints(std::vector<int> &slots, int lower, int upper, Node *parent) {
     if (upper == lower) {
       return NULL;
     }
 
     Node *node = new Node();
-    node->index = lower;
+    node->parent = parent;
+    node->size = node->live = upper - lower;
 
     if (upper - lower > 1) {
 
-      // choose an arbitrary point and move it to the start
-      int i = (int) ((double) rand() / RAND_MAX * (upper - lower - 1)) + lower;
-      std::swap(_items[lower], _items[i]);
+      // choose the vantage point and move it to the start
+      int i = chooseVantage(slots, lower, upper);
+      std::swap(slots[lower], slots[i]);
 
       int median = (upper + lower) / 2;
 
       // partitian around the median distance
+      const T &vantage = _items[slots[lower]];
+      uint64_t evaluations = 1;
       std::nth_element(
-          _items.begin() + lower + 1,
-          _items.begin() + median,
-          _items.begin() + upper,
-          DistanceComparator(_items[lower]));
+          slots.begin() + lower + 1,
+          slots.begin() + median,
+          slots.begin() + upper,
+          [this, &vantage, &evaluations](int a, int b) {
+            evaluations += 2;
+            return distance(vantage, _items[a]) < distance(vantage, _items[b]);
+          });
+      _build_distance_evaluations += evaluations;
+
+      // what was the median? The threshold is kept as a square root, see search().
+      node->threshold = std::sqrt(distance(vantage, _items[slots[median]]));
+
+      node->left = buildFromPoints(slots, lower + 1, median, node);
+      node->right = buildFromPoints(slots, median, upper, node);
+    }
 
-      // what was the median?
-      node->threshold = distance(_items[lower], _items[median]);
+    node->index = slots[lower];
+    _node_of[node->index] = node;
+    return node;
+  }
+
+  int flattenNode(const Node *node, std::vector<VpTreeFlatNode> &nodes) const {
+    if (node == NULL) return -1;
+    int position = (int) nodes.size();
+    VpTreeFlatNode flat = {node->index, -1, -1, _deleted[node->index], node->threshold};
+    nodes.push_back(flat);
+    int left = flattenNode(node->left, nodes);
+    int right = flattenNode(node->right, nodes);
+    nodes[position].left = left;
+    nodes[position].right = right;
+    return position;
+  }
 
-      node->index = lower;
-      node->left = buildFromPoints(lower + 1, median);
-      node->right = buildFromPoints(median, upper);
+  // The children of a pre-order node come after it, which rules out cycles.
+  Node *restoreNode(const VpTreeFlatNode *nodes, size_t count, int position, Node *parent) {
+    const VpTreeFlatNode &flat = nodes[position];
+    if (flat.index < 0 || flat.index >= (int) _items.size() || _node_of[flat.index] != NULL) {
+      throw std::invalid_argument("Invalid VpTree node.");
+    }
+    for (int child : {flat.left, flat.right}) {
+      if (child != -1 && (child <= position || child >= (int) count)) throw std::invalid_argument("Invalid VpTree node.");
     }
 
+    Node *node = new Node();
+    node->index = flat.index;
+    node->threshold = flat.threshold;
+    node->parent = parent;
+    _node_of[node->index] = node;
+    _deleted[node->index] = flat.deleted != 0;
+    node->live = flat.deleted != 0 ? 0 : 1;
+    _live += node->live;
+    try {
+      if (flat.left != -1) node->left = restoreNode(nodes, count, flat.left, node);
+      if (flat.right != -1) node->right = restoreNode(nodes, count, flat.right, node);
+    } catch (...) {
+      delete node;
+      throw;
+    }
+    node->size = 1 + subtreeSize(node->left) + subtreeSize(node->right);
+    node->live += node->left == NULL ? 0 : node->left->live;
+    node->live += node->right == NULL ? 0 : node->right->live;
     return node;
   }
 
-  void search(Node *node, const T &target, int k,
-              std::priority_queue<HeapItem> &heap) {
+  void collectLive(Node *node, std::vector<int> &slots) {
     if (node == NULL) return;
+    if (_deleted[node->index]) {
+      _node_of[node->index] = NULL;
+    } else {
+      slots.push_back(node->index);
+    }
+    collectLive(node->left, slots);
+    collectLive(node->right, slots);
+  }
+
+  // Rebuild a subtree from its live items, dropping its tombstones.
+  void rebuild(Node *node) {
+    std::vector<int> slots;
+    collectLive(node, slots);
+
+    Node *parent = node->parent;
+    Node **link = parent == NULL ? &_root : (parent->left == node ? &parent->left : &parent->right);
+    int removed = node->size - (int) slots.size();
+    node->parent = NULL;
+    delete node;
 
+    *link = buildFromPoints(slots, 0, (int) slots.size(), parent);
+    for (Node *p = parent; p != NULL; p = p->parent) p->size -= removed;
+  }
+
+  // The distance may be a squared metric (as SquaredDistance), which breaks the triangle inequality. Its square
+  // root is a metric in both cases, so the pruning is done on square roots and stays exact.
+  template<typename LowerBound>
+  void search(Node *node, const T &target, int k, std::priority_queue<HeapItem> &heap, double &tau,
+              LowerBound &lower_bound, Counters &counters) const {
+    if (node == NULL) return;
+    ++counters.nodes_visited;
+    if (node->live == 0) return;
+
+    // Beyond tau the item is no candidate, and beyond the threshold plus tau the inside subtree holds none either.
+    double bound = lower_bound(node->index);
+    if (bound > 0) {
+      bound -= std::sqrt(tau);
+      if (bound > 0 && (bound > node->threshold || (node->left == NULL && node->right == NULL))) {
+        search(node->right, target, k, heap, tau, lower_bound, counters);
+        return;
+      }
+    }
+
+    ++counters.distance_evaluations;
     double dist = distance(_items[node->index], target);
-    //printf("dist=%g tau=%gn", dist, _tau );
 
-    if (dist < _tau) {
+    // Until the heap is full, tau may come from the caller and an item at exactly that distance is still needed.
+    if (!_deleted[node->index] && (heap.size() < k ? dist <= tau : dist < tau)) {
       if (heap.size() == k) heap.pop();
       heap.push(HeapItem(node->index, dist));
-      if (heap.size() == k) _tau = heap.top().dist;
+      if (heap.size() == k) tau = heap.top().dist;
     }
 
     if (node->left == NULL && node->right == NULL) {
       return;
     }
 
-    if (dist < node->threshold) {
-//      if (dist - _tau <= node->threshold) {
-        search(node->left, target, k, heap);
-//      }
+    double root = std::sqrt(dist);
+    if (root < node->threshold) {
+      search(node->left, target, k, heap, tau, lower_bound, counters);
 
-      if (dist + _tau >= node->threshold) {
-        search(node->right, target, k, heap);
+      if (root + std::sqrt(tau) >= node->threshold) {
+        search(node->right, target, k, heap, tau, lower_bound, counters);
       }
 
     } else {
-//      if (dist + _tau >= node->threshold) {
-        search(node->right, target, k, heap);
-//      }
+      search(node->right, target, k, heap, tau, lower_bound, counters);
 
-      if (dist - _tau <= node->threshold) {
-        search(node->left, target, k, heap);
+      if (root - std::sqrt(tau) <= node->threshold) {
+        search(node->left, target, k, heap, tau, lower_bound, counters);
       }
     }
   }
 
-  void search_r(Node *node, const T &target, double dist_rad,
-                std::priority_queue<HeapItem> &heap) {
+  template<typename Visitor>
+  void search_r(Node *node, const T &target, double dist_rad, double root_rad, Visitor &visitor,
+                Counters &counters) const {
     if (node == NULL) return;
+    ++counters.nodes_visited;
+    if (node->live == 0) return;
 
+    ++counters.distance_evaluations;
     double dist = distance(_items[node->index], target);
-    //printf("dist=%g tau=%gn", dist, _tau );
 
-    if (dist <= dist_rad) {
-//            if ( heap.size() == k ) heap.pop();
-      heap.push(HeapItem(node->index, dist));
-//            if ( heap.size() == k ) _tau = heap.top().dist;
+    if (dist <= dist_rad && !_deleted[node->index]) {
+      visitor(_items[node->index], dist);
     }
 
     if (node->left == NULL && node->right == NULL) {
       return;
     }
 
-    if (dist < node->threshold) {
-      if (dist - dist_rad <= node->threshold) {
-        search_r(node->left, target, dist_rad, heap);
-      }
-
-      if (dist + dist_rad >= node->threshold) {
-        search_r(node->right, target, dist_rad, heap);
-      }
-
-    } else {
-      if (dist + dist_rad >= node->threshold) {
-        search_r(node->right, target, dist_rad, heap);
-      }
+    double root = std::sqrt(dist);
+    if (root - root_rad <= node->threshold) {
+      search_r(node->left, target, dist_rad, root_rad, visitor, counters);
+    }
 
-      if (dist - dist_rad <= node->threshold) {
-        search_r(node->left, target, dist_rad, heap);
-      }
+    if (root + root_rad >= node->threshold) {
+      search_r(node->right, target, dist_rad, root_rad, visitor, counters);
     }
   }
 
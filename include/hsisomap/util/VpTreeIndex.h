@@ -0,0 +1,86 @@
+//***************************************************************************************
+//
+//! \file VpTreeIndex.h
+//!  Persistent vantage point tree index files.
+//!
+//! An index file stores the flattened nodes of a tree (see VpTree::flatten) after a versioned header that records
+//! the shape and a checksum of the data matrix the tree was built on, and the vantage point selection it was built
+//! with. Loading maps the file into memory and validates the header against the data and the selection, so a stale
+//! index is never used.
+//!
+//! The mapped nodes are restored into a regular pointer tree (VpTree::create from nodes), and the queries run on
+//! that tree, not off the mapping. Loading skips the distance computations of the build, but still takes one pass
+//! over the nodes and the memory of the tree; the mapping can be released once the tree is restored.
+//!
+//! The file layout is the in-memory layout of the host; the header records the node size and a byte order mark
+//! and files from a different layout are rejected.
+//!
+//! \version   1.0
+//! \date      2026-10-19
+//! \copyright GNU Public License V3.0
+//
+//***************************************************************************************
+
+#ifndef HSISOMAP_VPTREEINDEX_H
+#define HSISOMAP_VPTREEINDEX_H
+
+#include <hsisomap/Matrix.h>
+#include <hsisomap/util/VpTree.h>
+#include <string>
+#include "../typedefs.h"
+
+HSISOMAP_NAMESPACE_BEGIN
+
+kIndex VPTREE_INDEX_VERSION = 2; //!< Version of the index file format.
+
+//! Calculate a 64-bit FNV-1a checksum of the elements of a matrix, row by row.
+//! \param matrix the matrix.
+//! \return the checksum.
+uint64_t MatrixChecksum(const gsl::Matrix &matrix);
+
+//! Save a flattened tree to an index file. The file is written under a temporary name and renamed, so readers never
+//! see a partial file.
+//! \param path the index file path.
+//! \param data the data matrix the tree was built on.
+//! \param checksum the checksum of the data matrix, from MatrixChecksum.
+//! \param vantage_candidates the vantage point candidates the tree was built with (VpTree::vantage_candidates).
+//! \param vantage_samples the vantage point samples the tree was built with (VpTree::vantage_samples).
+//! \param nodes the flattened nodes of the tree.
+void SaveVpTreeIndex(const std::string &path, const gsl::Matrix &data, uint64_t checksum, int vantage_candidates,
+                     int vantage_samples, const std::vector<VpTreeFlatNode> &nodes);
+
+//! A memory-mapped index file. The mapping lives as long as the object.
+class VpTreeIndexFile {
+ public:
+
+  //! Map an index file and validate it against the data matrix and the vantage point selection.
+  //! \param path the index file path.
+  //! \param data the data matrix the tree is expected to be built on.
+  //! \param checksum the checksum of the data matrix, from MatrixChecksum.
+  //! \param vantage_candidates the vantage point candidates the tree is expected to be built with.
+  //! \param vantage_samples the vantage point samples the tree is expected to be built with.
+  VpTreeIndexFile(const std::string &path, const gsl::Matrix &data, uint64_t checksum, int vantage_candidates,
+                  int vantage_samples);
+  ~VpTreeIndexFile();
+
+  //! Whether the file exists, is a complete index of the current version and matches the data matrix and the
+  //! vantage point selection.
+  bool valid() const { return nodes_ != NULL; }
+  //! Get the mapped nodes, or NULL if the file is not valid.
+  const VpTreeFlatNode *nodes() const { return nodes_; }
+  //! Get the number of nodes.
+  Index size() const { return size_; }
+
+ private:
+  VpTreeIndexFile(const VpTreeIndexFile &) = delete;
+  VpTreeIndexFile &operator=(const VpTreeIndexFile &) = delete;
+
+  void *mapping_;
+  size_t mapping_size_;
+  const VpTreeFlatNode *nodes_;
+  Index size_;
+};
+
+HSISOMAP_NAMESPACE_END
+
+#endif //HSISOMAP_VPTREEINDEX_H
@@ -44,6 +44,14 @@ void tasking(const picojson::value &task_value) {
   }
 
 
+  // kNN index cache (optional): the search indexes are saved there and reused by later runs on the same data.
+  if (task[CONFIG::INDEX_CACHE_DIRECTORY].is<std::string>() && task[CONFIG::INDEX_CACHE_DIRECTORY].to_str() != "") {
+    auto index_cache_path =
+        output_root_path / boost::filesystem::path(task[CONFIG::INDEX_CACHE_DIRECTORY].to_str());
+    boost::filesystem::create_directories(index_cache_path);
+    SetKNNIndexCacheDirectory(index_cache_path.string());
+  }
+
   // Backbone processing
   if (!task[CONFIG::BACKBONE_SAMPLING].is<picojson::object>()) {
     std::cerr << "Unexpected configuration structure error." << std::endl;
@@ -181,7 +189,82 @@ void tasking(const picojson::value &task_value) {
 
   std::shared_ptr<KNNGraph> knngraph;
 
-  if (knngraph_config[CONFIG::IMPLEMENTATION].to_str() == CONFIG::ADAPTIVE_K_HIDENN) {
+  auto knngraph_graph_backend = KNNGRAPH_GRAPH_BACKEND_ADJACENCYLIST;
+  if (knngraph_config[CONFIG::BACKEND].to_str() == CONFIG::ADJACENCY_LIST) {
+    // Default, do nothing
+  } else if (knngraph_config[CONFIG::BACKEND].to_str() == CONFIG::CSR) {
+    knngraph_graph_backend = KNNGRAPH_GRAPH_BACKEND_CSR;
+  } else if (knngraph_config[CONFIG::BACKEND].to_str() == CONFIG::BOOST) {
+    knngraph_graph_backend = KNNGRAPH_GRAPH_BACKEND_BOOST;
+  } else if (knngraph_config[CONFIG::BACKEND].to_str() == CONFIG::BOOST_CSR) {
+    knngraph_graph_backend = KNNGRAPH_GRAPH_BACKEND_BOOST_CSR;
+  } else {
+    std::cerr << "Unexpected knngraph backend: " << knngraph_config[CONFIG::BACKEND] << "."
+              << std::endl;
+    exit(3);
+  }
+
+  // The default follows the index cache: the dual-tree search, unless the cached VpTree index can be reused.
+  auto knngraph_knn_backend = KNNGraphDefaultBackend();
+  if (knngraph_config[CONFIG::KNN_BACKEND].is<picojson::null>()) {
+    // Default, do nothing
+  } else if (knngraph_config[CONFIG::KNN_BACKEND].to_str() == CONFIG::DUAL_TREE) {
+    knngraph_knn_backend = KNN_BACKEND_DUAL_TREE;
+  } else if (knngraph_config[CONFIG::KNN_BACKEND].to_str() == CONFIG::VPTREE) {
+    knngraph_knn_backend = KNN_BACKEND_VPTREE;
+  } else if (knngraph_config[CONFIG::KNN_BACKEND].to_str() == CONFIG::BRUTE_FORCE) {
+    knngraph_knn_backend = KNN_BACKEND_BRUTE_FORCE;
+  } else if (knngraph_config[CONFIG::KNN_BACKEND].to_str() == CONFIG::RP_FOREST) {
+    knngraph_knn_backend = KNN_BACKEND_RPFOREST;
+  } else if (knngraph_config[CONFIG::KNN_BACKEND].to_str() == CONFIG::PCA_KDTREE) {
+    knngraph_knn_backend = KNN_BACKEND_PCA_KDTREE;
+  } else {
+    std::cerr << "Unexpected knngraph knn backend: " << knngraph_config[CONFIG::KNN_BACKEND] << "."
+              << std::endl;
+    exit(3);
+  }
+
+  // The backbone keeps the image geometry only when it holds all pixels in their original order.
+  Scalar knngraph_image_samples = hsi_data.samples();
+  if (backbone.sampling_indices().size() != hsi_data.data()->rows()) knngraph_image_samples = 0;
+  for (Index i = 0; i < backbone.sampling_indices().size() && knngraph_image_samples != 0; ++i) {
+    if (backbone.sampling_indices()[i] != i) knngraph_image_samples = 0;
+  }
+
+  if (knngraph_config[CONFIG::IMPLEMENTATION].to_str() == CONFIG::FIXED_K) {
+
+    Scalar knngraph_fixed_k_number = 0;
+    if (knngraph_config[CONFIG::K].is<double>()) {
+      knngraph_fixed_k_number = knngraph_config[CONFIG::K].get<double>();
+    } else {
+      std::cerr << "Unexpected data type at " << CONFIG::KNNGRAPH << " -> " << CONFIG::K << "." << std::endl;
+      exit(3);
+    }
+
+    if (knngraph_fixed_k_number < 1) {
+      std::cerr << "Wrong fixed k value or not specified." << std::endl;
+      exit(3);
+    }
+
+    Scalar knngraph_threads = 0;
+    if (knngraph_config[CONFIG::THREADS].is<double>()) {
+      knngraph_threads = knngraph_config[CONFIG::THREADS].get<double>();
+    }
+
+    knngraph = KNNGraphWithImplementation(KNNGRAPH_IMPLEMENTATION_FIXED_K,
+                                          bb_data,
+                                          PropertyList({{KNNGRAPH_FIXED_K_NUMBER,
+                                                         knngraph_fixed_k_number},
+                                                        {KNN_BACKEND,
+                                                         knngraph_knn_backend},
+                                                        {KNN_IMAGE_SAMPLES,
+                                                         knngraph_image_samples},
+                                                        {PARALLEL_THREADS,
+                                                         knngraph_threads},
+                                                        {KNNGRAPH_GRAPH_BACKEND,
+                                                         knngraph_graph_backend}}));
+
+  } else if (knngraph_config[CONFIG::IMPLEMENTATION].to_str() == CONFIG::ADAPTIVE_K_HIDENN) {
 
     Scalar knngraph_adaptive_k_hidenn_subset_number = 0;
     if (knngraph_config[CONFIG::SUBSET_COUNT].is<double>()) {
@@ -196,20 +279,124 @@ void tasking(const picojson::value &task_value) {
       exit(3);
     }
 
-    auto knngraph_graph_backend = KNNGRAPH_GRAPH_BACKEND_ADJACENCYLIST;
-    if (knngraph_config[CONFIG::BACKEND].to_str() == CONFIG::ADJACENCY_LIST) {
+    knngraph = KNNGraphWithImplementation(KNNGRAPH_IMPLEMENTATION_ADAPTIVE_K_HIDENN,
+                                          bb_data,
+                                          PropertyList({{KNNGRAPH_ADAPTIVE_K_HIDENN_SUBSET_NUMBER,
+                                                         knngraph_adaptive_k_hidenn_subset_number},
+                                                        {KNN_BACKEND,
+                                                         knngraph_knn_backend},
+                                                        {KNN_IMAGE_SAMPLES,
+                                                         knngraph_image_samples},
+                                                        {KNNGRAPH_GRAPH_BACKEND,
+                                                         knngraph_graph_backend}}));
+
+  } else if (knngraph_config[CONFIG::IMPLEMENTATION].to_str() == CONFIG::NN_DESCENT) {
+
+    Scalar knngraph_nn_descent_k_number = 0;
+    if (knngraph_config[CONFIG::K].is<double>()) {
+      knngraph_nn_descent_k_number = knngraph_config[CONFIG::K].get<double>();
+    } else {
+      std::cerr << "Unexpected data type at " << CONFIG::KNNGRAPH << " -> " << CONFIG::K << "." << std::endl;
+      exit(3);
+    }
+
+    if (knngraph_nn_descent_k_number < 2) {
+      std::cerr << "Wrong nn descent k value or not specified." << std::endl;
+      exit(3);
+    }
+
+    // Optional settings, zero means the library default.
+    Scalar knngraph_nn_descent_sample_rate = 0;
+    Scalar knngraph_nn_descent_max_iterations = 0;
+    Scalar knngraph_nn_descent_seed = 0;
+    Scalar knngraph_threads = 0;
+    if (knngraph_config[CONFIG::SAMPLE_RATE].is<double>()) {
+      knngraph_nn_descent_sample_rate = knngraph_config[CONFIG::SAMPLE_RATE].get<double>();
+    }
+    if (knngraph_config[CONFIG::MAX_ITERATIONS].is<double>()) {
+      knngraph_nn_descent_max_iterations = knngraph_config[CONFIG::MAX_ITERATIONS].get<double>();
+    }
+    if (knngraph_config[CONFIG::SEED].is<double>()) {
+      knngraph_nn_descent_seed = knngraph_config[CONFIG::SEED].get<double>();
+    }
+    if (knngraph_config[CONFIG::THREADS].is<double>()) {
+      knngraph_threads = knngraph_config[CONFIG::THREADS].get<double>();
+    }
+
+    auto knngraph_nn_descent_initialization = KNNGRAPH_NN_DESCENT_INITIALIZATION_RANDOM;
+    if (knngraph_config[CONFIG::INITIALIZATION].is<picojson::null>()
+        || knngraph_config[CONFIG::INITIALIZATION].to_str() == CONFIG::RANDOM) {
       // Default, do nothing
-      // TODO: Support boost graph
+    } else if (knngraph_config[CONFIG::INITIALIZATION].to_str() == CONFIG::RP_FOREST) {
+      knngraph_nn_descent_initialization = KNNGRAPH_NN_DESCENT_INITIALIZATION_RPFOREST;
     } else {
-      std::cerr << "Unexpected knngraph backend: " << knngraph_config[CONFIG::BACKEND] << "."
+      std::cerr << "Unexpected nn descent initialization: " << knngraph_config[CONFIG::INITIALIZATION] << "."
                 << std::endl;
       exit(3);
     }
 
-    knngraph = KNNGraphWithImplementation(KNNGRAPH_IMPLEMENTATION_ADAPTIVE_K_HIDENN,
+    knngraph = KNNGraphWithImplementation(KNNGRAPH_IMPLEMENTATION_NN_DESCENT,
                                           bb_data,
-                                          PropertyList({{KNNGRAPH_ADAPTIVE_K_HIDENN_SUBSET_NUMBER,
-                                                         knngraph_adaptive_k_hidenn_subset_number},
+                                          PropertyList({{KNNGRAPH_NN_DESCENT_K_NUMBER,
+                                                         knngraph_nn_descent_k_number},
+                                                        {KNNGRAPH_NN_DESCENT_SAMPLE_RATE,
+                                                         knngraph_nn_descent_sample_rate},
+                                                        {KNNGRAPH_NN_DESCENT_MAX_ITERATIONS,
+                                                         knngraph_nn_descent_max_iterations},
+                                                        {KNNGRAPH_NN_DESCENT_SEED,
+                                                         knngraph_nn_descent_seed},
+                                                        {KNNGRAPH_NN_DESCENT_INITIALIZATION,
+                                                         knngraph_nn_descent_initialization},
+                                                        {PARALLEL_THREADS,
+                                                         knngraph_threads},
+                                                        {KNNGRAPH_GRAPH_BACKEND,
+                                                         knngraph_graph_backend}}));
+
+  } else if (knngraph_config[CONFIG::IMPLEMENTATION].to_str() == CONFIG::EPSILON) {
+
+    // Optional settings, zero means the library default (adaptive radius over a single subset).
+    Scalar knngraph_epsilon_radius = 0;
+    Scalar knngraph_epsilon_subset_number = 0;
+    Scalar knngraph_epsilon_scale = 0;
+    Scalar knngraph_epsilon_max_degree = 0;
+    Scalar knngraph_threads = 0;
+    if (knngraph_config[CONFIG::RADIUS].is<double>()) {
+      knngraph_epsilon_radius = knngraph_config[CONFIG::RADIUS].get<double>();
+    }
+    if (knngraph_config[CONFIG::SUBSET_COUNT].is<double>()) {
+      knngraph_epsilon_subset_number = knngraph_config[CONFIG::SUBSET_COUNT].get<double>();
+    }
+    if (knngraph_config[CONFIG::SCALE].is<double>()) {
+      knngraph_epsilon_scale = knngraph_config[CONFIG::SCALE].get<double>();
+    }
+    if (knngraph_config[CONFIG::MAX_DEGREE].is<double>()) {
+      knngraph_epsilon_max_degree = knngraph_config[CONFIG::MAX_DEGREE].get<double>();
+    }
+    if (knngraph_config[CONFIG::THREADS].is<double>()) {
+      knngraph_threads = knngraph_config[CONFIG::THREADS].get<double>();
+    }
+
+    if (knngraph_epsilon_radius < 0 || knngraph_epsilon_scale < 0) {
+      std::cerr << "Wrong epsilon radius or scale value." << std::endl;
+      exit(3);
+    }
+
+    knngraph = KNNGraphWithImplementation(KNNGRAPH_IMPLEMENTATION_EPSILON,
+                                          bb_data,
+                                          PropertyList({{KNNGRAPH_EPSILON_RADIUS,
+                                                         knngraph_epsilon_radius},
+                                                        {KNNGRAPH_EPSILON_SUBSET_NUMBER,
+                                                         knngraph_epsilon_subset_number},
+                                                        {KNNGRAPH_EPSILON_SCALE,
+                                                         knngraph_epsilon_scale},
+                                                        {KNNGRAPH_EPSILON_MAX_DEGREE,
+                                                         knngraph_epsilon_max_degree},
+                                                        {KNN_BACKEND,
+                                                         knngraph_knn_backend},
+                                                        {KNN_IMAGE_SAMPLES,
+                                                         knngraph_image_samples},
+                                                        {PARALLEL_THREADS,
+                                                         knngraph_threads},
                                                         {KNNGRAPH_GRAPH_BACKEND,
                                                          knngraph_graph_backend}}));
 
@@ -234,28 +421,159 @@ void tasking(const picojson::value &task_value) {
   auto dijkstra_config = task[CONFIG::DIJKSTRA].get<picojson::object>();
 
   std::shared_ptr<Dijkstra::Dijkstra> dijkstra;
+  int dijkstra_result = 0;
+
+  // The engines hand the rows straight to this matrix, so that they keep no distance table of their own.
+  auto distance_matrix_landmark_to_all =
+      std::make_shared<gsl::Matrix>(landmark->landmarks().size(), knngraph->knngraph()->NumVertices());
+  auto distance_row_sink = Dijkstra::MatrixRowSink(*distance_matrix_landmark_to_all);
 
   if (dijkstra_config[CONFIG::IMPLEMENTATION].to_str() == CONFIG::OPENCL) {
 
+    // Optional device selection, the absent settings are not restricted.
+    StringPropertyList dijkstra_device_selection;
+    if (dijkstra_config[CONFIG::DEVICE_TYPE].is<std::string>()) {
+      dijkstra_device_selection[Dijkstra::DIJKSTRACL_DEVICE_TYPE] = dijkstra_config[CONFIG::DEVICE_TYPE].to_str();
+    }
+    if (dijkstra_config[CONFIG::PLATFORM].is<std::string>()) {
+      dijkstra_device_selection[Dijkstra::DIJKSTRACL_PLATFORM_NAME] = dijkstra_config[CONFIG::PLATFORM].to_str();
+    }
+    if (dijkstra_config[CONFIG::DEVICE].is<std::string>()) {
+      dijkstra_device_selection[Dijkstra::DIJKSTRACL_DEVICE_NAME] = dijkstra_config[CONFIG::DEVICE].to_str();
+    }
+    if (dijkstra_config[CONFIG::WORK_GROUP_SIZE].is<double>()) {
+      dijkstra_device_selection[Dijkstra::DIJKSTRACL_WORK_GROUP_SIZE] =
+          std::to_string(static_cast<Index>(dijkstra_config[CONFIG::WORK_GROUP_SIZE].get<double>()));
+    }
+
+    // Optional number of sources solved together, 0 or absent chooses it from the device memory.
+    Scalar dijkstra_batch_size = 0;
+    if (dijkstra_config[CONFIG::BATCH_SIZE].is<double>()) {
+      dijkstra_batch_size = dijkstra_config[CONFIG::BATCH_SIZE].get<double>();
+    }
+
+    // Optional program binary cache, shared by the runs of the process.
+    if (dijkstra_config[CONFIG::PROGRAM_CACHE_DIRECTORY].is<std::string>()) {
+      Dijkstra::DijkstraCL::SetProgramCacheDirectory(dijkstra_config[CONFIG::PROGRAM_CACHE_DIRECTORY].to_str());
+    }
+
+    // Optional kernel set, the frontier kernels relax only the vertices changed in the last iteration.
+    Dijkstra::DijkstraCLKernelSet dijkstra_kernel_set = Dijkstra::DIJKSTRACL_KERNELS_ALL_VERTICES;
+    if (dijkstra_config[CONFIG::KERNELS].is<std::string>() && dijkstra_config[CONFIG::KERNELS].to_str() == CONFIG::FRONTIER) {
+      dijkstra_kernel_set = Dijkstra::DIJKSTRACL_KERNELS_FRONTIER;
+    }
+
     LOGI("Perform DijkstraCL from " << landmark->landmarks().size() << " landmarks to all the " << bb_data->rows()
                                     << " pixels.")
     dijkstra = Dijkstra::DijkstraWithImplementation(Dijkstra::DIJKSTRA_IMPLEMENTATION_CL, knngraph->knngraph());
+    std::dynamic_pointer_cast<Dijkstra::DijkstraCL>(dijkstra)->SetDeviceSelection(dijkstra_device_selection);
+    std::dynamic_pointer_cast<Dijkstra::DijkstraCL>(dijkstra)->SetBatchSize(static_cast<Index>(dijkstra_batch_size));
+    std::dynamic_pointer_cast<Dijkstra::DijkstraCL>(dijkstra)->SetKernelSet(dijkstra_kernel_set);
     dijkstra->SetSourceVertices(landmark->landmarks());
-    dijkstra->Run();
+    dijkstra_result = dijkstra->Run(distance_row_sink);
     LOGI("DijkstraCL finished.")
 
-  }
+  } else if (dijkstra_config[CONFIG::IMPLEMENTATION].to_str() == CONFIG::BOOST) {
+
+    Scalar dijkstra_threads = 0;
+    if (dijkstra_config[CONFIG::THREADS].is<double>()) {
+      dijkstra_threads = dijkstra_config[CONFIG::THREADS].get<double>();
+    }
+
+    // Requires the "boost" or "boost csr" knngraph backend.
+    LOGI("Perform BoostDijkstra from " << landmark->landmarks().size() << " landmarks to all the " << bb_data->rows()
+                                       << " pixels.")
+    dijkstra = Dijkstra::DijkstraWithImplementation(Dijkstra::DIJKSTRA_IMPLEMENTATION_BOOST,
+                                                    knngraph->knngraph(),
+                                                    static_cast<Index>(dijkstra_threads));
+    dijkstra->SetSourceVertices(landmark->landmarks());
+    dijkstra_result = dijkstra->Run(distance_row_sink);
+    LOGI("BoostDijkstra finished.")
+
+  } else if (dijkstra_config[CONFIG::IMPLEMENTATION].to_str() == CONFIG::CPU) {
+
+    Scalar dijkstra_threads = 0;
+    if (dijkstra_config[CONFIG::THREADS].is<double>()) {
+      dijkstra_threads = dijkstra_config[CONFIG::THREADS].get<double>();
+    }
+
+    LOGI("Perform DijkstraCPU from " << landmark->landmarks().size() << " landmarks to all the " << bb_data->rows()
+                                     << " pixels.")
+    dijkstra = Dijkstra::DijkstraWithImplementation(Dijkstra::DIJKSTRA_IMPLEMENTATION_CPU_PARALLEL,
+                                                    knngraph->knngraph(),
+                                                    static_cast<Index>(dijkstra_threads));
+    // Optional radix heap over the edge weights quantized to integers, instead of the binary heap.
+    if (dijkstra_config[CONFIG::QUEUE].is<std::string>()
+        && dijkstra_config[CONFIG::QUEUE].to_str() == CONFIG::RADIX_HEAP) {
+      auto dijkstra_cpu = std::dynamic_pointer_cast<Dijkstra::DijkstraCPU>(dijkstra);
+      dijkstra_cpu->SetQueue(Dijkstra::DIJKSTRACPU_QUEUE_RADIX_HEAP);
+      LOGI("DijkstraCPU uses the radix heap, relative distance error within " << dijkstra_cpu->relativeErrorBound() << ".")
+    }
+    dijkstra->SetSourceVertices(landmark->landmarks());
+    dijkstra_result = dijkstra->Run(distance_row_sink);
+    LOGI("DijkstraCPU finished.")
 
-  // TODO: Support boost graph implementation
+  } else if (dijkstra_config[CONFIG::IMPLEMENTATION].to_str() == CONFIG::DELTA_STEPPING) {
+
+    Scalar dijkstra_threads = 0;
+    if (dijkstra_config[CONFIG::THREADS].is<double>()) {
+      dijkstra_threads = dijkstra_config[CONFIG::THREADS].get<double>();
+    }
+
+    // Optional bucket width, 0 or absent picks it from the edge weights.
+    Scalar dijkstra_delta = 0;
+    if (dijkstra_config[CONFIG::DELTA].is<double>()) {
+      dijkstra_delta = dijkstra_config[CONFIG::DELTA].get<double>();
+    }
+
+    LOGI("Perform DeltaStepping from " << landmark->landmarks().size() << " landmarks to all the " << bb_data->rows()
+                                       << " pixels.")
+    dijkstra = Dijkstra::DijkstraWithImplementation(Dijkstra::DIJKSTRA_IMPLEMENTATION_DELTA_STEPPING,
+                                                    knngraph->knngraph(),
+                                                    static_cast<Index>(dijkstra_threads));
+    if (dijkstra_delta > 0) std::dynamic_pointer_cast<Dijkstra::DeltaStepping>(dijkstra)->SetDelta(dijkstra_delta);
+    dijkstra->SetSourceVertices(landmark->landmarks());
+    dijkstra_result = dijkstra->Run(distance_row_sink);
+    LOGI("DeltaStepping finished.")
+
+  } else if (dijkstra_config[CONFIG::IMPLEMENTATION].to_str() == CONFIG::LANE_BELLMAN_FORD) {
+
+    Scalar dijkstra_threads = 0;
+    if (dijkstra_config[CONFIG::THREADS].is<double>()) {
+      dijkstra_threads = dijkstra_config[CONFIG::THREADS].get<double>();
+    }
+
+    // Optional number of sources per batch, 8 or 16.
+    Scalar dijkstra_lanes = 8;
+    if (dijkstra_config[CONFIG::LANES].is<double>()) {
+      dijkstra_lanes = dijkstra_config[CONFIG::LANES].get<double>();
+    }
+
+    LOGI("Perform LaneBellmanFord from " << landmark->landmarks().size() << " landmarks to all the " << bb_data->rows()
+                                         << " pixels.")
+    dijkstra = Dijkstra::DijkstraWithImplementation(Dijkstra::DIJKSTRA_IMPLEMENTATION_LANE_BELLMAN_FORD,
+                                                    knngraph->knngraph(),
+                                                    static_cast<Index>(dijkstra_threads));
+    std::dynamic_pointer_cast<Dijkstra::LaneBellmanFord>(dijkstra)->SetLanes(static_cast<Index>(dijkstra_lanes));
+    dijkstra->SetSourceVertices(landmark->landmarks());
+    dijkstra_result = dijkstra->Run(distance_row_sink);
+    LOGI("LaneBellmanFord finished.")
+
+  }
 
   if (dijkstra == nullptr) {
     std::cerr << "Fatal error in creating dijkstra object." << std::endl;
     exit(1);
   }
 
+  // The rows of distance_matrix_landmark_to_all are not initialized until the run fills them
+  if (dijkstra_result != 0) {
+    std::cerr << "Dijkstra failed with error code " << dijkstra_result << "." << std::endl;
+    exit(3);
+  }
+
   LOGI("Performing CMDS...");
 
-  auto distance_matrix_landmark_to_all = dijkstra->GetDistanceMatrix();
   auto distance_matrix_landmarks = GetCols(distance_matrix_landmark_to_all, landmark->landmarks());
 
   auto
@@ -1,4 +1,5 @@
 #include <hsisomap/hsisomap>
+#include <chrono>
 #include <numeric>
 #include <random>
 
@@ -439,10 +440,86 @@ void paviau_mnf_landmark_tests() {
 }
 
 
+void union_find_benchmark() {
+
+  LOGTIMESTAMP("Union-Find Benchmark Begin.")
+
+  // kNN graph shaped workload: each of N pixels links to K neighbors, most of them in a window of nearby rows and
+  // some anywhere, as the kNN of image pixels are.
+  const Index N = 2000000, K = 10;
+  std::vector<Index> neighbors(N * K);
+  std::mt19937 g(1);
+  std::uniform_int_distribution<Index> nearby(0, 2000), anywhere(0, N - 1), pick(0, 9);
+  for (Index n = 0; n < N; ++n) {
+    for (Index j = 0; j < K; ++j) neighbors[n * K + j] = pick(g) < 8 ? (n + nearby(g)) % N : anywhere(g);
+  }
+
+  auto seconds_since = [](std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  };
+
+  {
+    auto start = std::chrono::steady_clock::now();
+    UnionFind uf(N);
+    for (Index i = 0; i < N * K; ++i) uf.Connect(i / K, neighbors[i]);
+    LOGI("UnionFind: " << seconds_since(start) << " s, " << uf.count() << " parts.")
+  }
+
+  for (Index threads : {Index(1), Index(2), Index(4), ParallelThreadCount()}) {
+    auto start = std::chrono::steady_clock::now();
+    ConcurrentUnionFind uf(N);
+    ParallelFor(0, N, [&](Index n, Index) {
+      for (Index j = 0; j < K; ++j) uf.Connect(n, neighbors[n * K + j]);
+    }, threads);
+    LOGI("ConcurrentUnionFind, " << threads << " threads: " << seconds_since(start) << " s, " << uf.count()
+                                 << " parts.")
+  }
+
+  LOGTIMESTAMP("Union-Find Benchmark Finished.");
+
+}
+
+void dijkstracl_kernels_benchmark() {
+
+  LOGTIMESTAMP("DijkstraCL Kernel Sets Benchmark Begin.")
+
+  // kNN graph of pixels on a noisy 2D manifold embedded in 20 bands, as the spectra of a smooth scene are.
+  const Index N = 50000, BANDS = 20, SOURCES = 64;
+  auto data = std::make_shared<gsl::Matrix>(N, BANDS);
+  std::mt19937 g(1);
+  std::uniform_real_distribution<Scalar> uniform(0, 1);
+  std::normal_distribution<Scalar> noise(0, 0.01);
+  for (Index n = 0; n < N; ++n) {
+    Scalar u = uniform(g), v = uniform(g);
+    for (Index b = 0; b < BANDS; ++b) (*data)(n, b) = std::sin(3 * u * (b + 1) / BANDS) + v * b / BANDS + noise(g);
+  }
+  auto knngraph = KNNGraphWithImplementation(KNNGRAPH_IMPLEMENTATION_FIXED_K, data,
+                                             PropertyList({{KNNGRAPH_FIXED_K_NUMBER, 10},
+                                                           {KNNGRAPH_GRAPH_BACKEND, KNNGRAPH_GRAPH_BACKEND_CSR}}));
+  std::vector<Index> sources(SOURCES);
+  for (auto &source : sources) source = std::uniform_int_distribution<Index>(0, N - 1)(g);
+
+  for (auto kernelSet : {DIJKSTRACL_KERNELS_ALL_VERTICES, DIJKSTRACL_KERNELS_FRONTIER}) {
+    auto dijkstra = std::dynamic_pointer_cast<DijkstraCL>(DijkstraWithImplementation(DIJKSTRA_IMPLEMENTATION_CL,
+                                                                                      knngraph->knngraph()));
+    dijkstra->SetKernelSet(kernelSet);
+    dijkstra->SetSourceVertices(sources);
+    dijkstra->Run();
+    auto counters = dijkstra->GetCounters();
+    LOGI((kernelSet == DIJKSTRACL_KERNELS_FRONTIER ? "Frontier" : "All-vertices") << " kernels: "
+             << counters.iterations << " iterations, " << counters.workItems << " work items, "
+             << counters.kernelSeconds << " s in kernels, " << counters.seconds << " s.")
+  }
+
+  LOGTIMESTAMP("DijkstraCL Kernel Sets Benchmark Finished.");
+
+}
 
 int main() {
 
 //  example2();
+//  union_find_benchmark();
+//  dijkstracl_kernels_benchmark();
 
   paviau_mnf_landmark_tests();
   
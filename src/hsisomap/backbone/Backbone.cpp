@@ -5,7 +5,7 @@
 #include <hsisomap/backbone/Backbone.h>
 #include <hsisomap/gsl_util/matrix_util.h>
 #include <hsisomap/Logger.h>
-#include <hsisomap/util/VpTree.h>
+#include <hsisomap/knnsearch/KNNSearch.h>
 #include <gsl/gsl_blas.h>
 #include <hsisomap/gsl_util/gsl_util.h>
 
@@ -26,68 +26,45 @@ Backbone::Backbone(const std::shared_ptr<const gsl::Matrix> data, const std::vec
 }
 
 void Backbone::PrepareNNCache(Index neighborhood_size, PropertyList optional_settings) {
-  if (neighborhood_size > data_->rows()) neighborhood_size = data_->rows();
-  Index PRIMARY_SEARCH_RANGE = static_cast<kIndex>(optional_settings[BACKBONE_NNCACHE_PRIMARY_SEARCH_RANGE]);
-  Index SECONDARY_SEARCH_RANGE = static_cast<kIndex>(optional_settings[BACKBONE_NNCACHE_SECONDARY_SEARCH_RANGE]);
-  if (PRIMARY_SEARCH_RANGE == 0) PRIMARY_SEARCH_RANGE = std::min(neighborhood_size * 10, data_->rows());
-  if (SECONDARY_SEARCH_RANGE == 0) SECONDARY_SEARCH_RANGE = std::min(neighborhood_size * 20, data_->rows());
-
-  VpTree<PixelView, SquaredDistance> vptree;
-  LOGI("Create PixelView array.");
-  auto pixel_views = CreatePixelViewsFromMatrix(*data_);
-  LOGI("Creating VpTree for the whole image.")
-  vptree.create(pixel_views);
-  LOGI("VpTree created.")
+  if (neighborhood_size > sampled_data_->rows()) neighborhood_size = sampled_data_->rows();
 
-  // The number of rows in NN cache matrix is the number of non-backbone pixels.
-  // The number of cols in NN cache matrix is the number of (precalculated) neighborhood size plus one,
-  // since the first column is the index of the non-backbone pixel in the whole image.
-  nn_cache_ = std::make_shared<gsl::Matrix>(data_->rows() - sampling_indices_.size(), neighborhood_size + 1);
+  // Only backbone pixels can be neighbors, so the search index is built over the backbone pixels alone.
+  // Every other pixel queries it, so the pivot table is paid back many times over.
+  if (optional_settings.find(KNN_PIVOTS) == optional_settings.end()) optional_settings[KNN_PIVOTS] = 16.0;
+  LOGI("Creating kNN search backend for the backbone pixels.")
+  auto knn_search = KNNSearchWithBackend(*sampled_data_, optional_settings);
+  LOGI("kNN search backend created.")
 
-  Index recon_idx = 0;
+  std::vector<Index> non_backbone_indices;
+  non_backbone_indices.reserve(data_->rows() - sampling_indices_.size());
   for (Index full_idx = 0; full_idx < data_->rows(); ++full_idx) {
-
-    // Progress indicator
-    if (full_idx % 10000 == 0) {
-      LOGI("[NN] " << full_idx << " of " << data_->rows() << " finished ("
-               << (int) ((float) full_idx * 100.0 / data_->rows()) << "%).")
+    if (sampling_indices_reverse_table_.find(full_idx) == sampling_indices_reverse_table_.end()) {
+      non_backbone_indices.push_back(full_idx);
     }
+  }
 
-    // If it is found in the sampling indices set, ignore.
-    if (sampling_indices_reverse_table_.find(full_idx) != sampling_indices_reverse_table_.end()) continue;
-
-    // Otherwise, a non-backbone pixel is found.
-    (*nn_cache_)(recon_idx, 0) = full_idx;
-
-    Key LOG_PROMPT[4] = {"PRIMARY", "SECONDARY", "EXHAUSTIVE", "ERROR"};
-    Index search_ranges[3] = {PRIMARY_SEARCH_RANGE, SECONDARY_SEARCH_RANGE, data_->rows()};
-    for (Index iteration = 0; iteration < 3; ++iteration) {
+  // The number of rows in NN cache matrix is the number of non-backbone pixels.
+  // The number of cols in NN cache matrix is the number of (precalculated) neighborhood size plus one,
+  // since the first column is the index of the non-backbone pixel in the whole image.
+  nn_cache_ = std::make_shared<gsl::Matrix>(non_backbone_indices.size(), neighborhood_size + 1);
 
-      std::vector<PixelView> results;
-      std::vector<Scalar> distance_squares;
-      vptree.search(pixel_views[full_idx], search_ranges[iteration], &results, &distance_squares);
+  for (Index first = 0; first < non_backbone_indices.size(); first += KNN_SEARCH_BATCH_ROWS) {
 
-      Index encountered_backbone_count = 0;
+    // Progress indicator
+    LOGI("[NN] " << first << " of " << non_backbone_indices.size() << " finished ("
+             << (int) ((float) first * 100.0 / non_backbone_indices.size()) << "%).")
 
-      for (auto result : results) {
-        if (sampling_indices_reverse_table_.find(result.index) != sampling_indices_reverse_table_.end()) {
-          (*nn_cache_)(recon_idx, encountered_backbone_count + 1) = result.index;
-          encountered_backbone_count++;
-          if (encountered_backbone_count == neighborhood_size) break;
-        }
-      }
+    Index last = std::min(first + KNN_SEARCH_BATCH_ROWS, static_cast<Index>(non_backbone_indices.size()));
+    std::vector<Index> batch(non_backbone_indices.begin() + first, non_backbone_indices.begin() + last);
+    auto table = knn_search->Search(*gsl::GetRows(data_, batch), neighborhood_size);
 
-      if (encountered_backbone_count != neighborhood_size) {
-        LOGI("Only " << encountered_backbone_count << " backbone pixels found in " << LOG_PROMPT[iteration]
-                 << " search range. Use " << LOG_PROMPT[iteration + 1] << " search range instead.");
-      } else {
-        break;
+    for (Index recon_idx = first; recon_idx < last; ++recon_idx) {
+      (*nn_cache_)(recon_idx, 0) = non_backbone_indices[recon_idx];
+      for (Index n = 0; n < neighborhood_size; ++n) {
+        (*nn_cache_)(recon_idx, n + 1) = sampling_indices_[table.index(recon_idx - first, n)];
       }
-
     }
 
-    recon_idx++;
-
   }
 
   LOGI("[NN] NN Cache created.")
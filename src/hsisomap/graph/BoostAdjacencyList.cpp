@@ -6,6 +6,13 @@
 
 namespace GraphUtils {
 
+BoostAdjacencyList::BoostGraph::BoostGraph(const std::vector<Edge> &edges,
+                                           const std::vector<Scalar> &weights,
+                                           Index numVertices)
+    : graph(edges.data(), edges.data() + edges.size(), weights.data(), numVertices),
+      numVertices(numVertices),
+      index(get(boost::vertex_index, graph)) { }
+
 BoostAdjacencyList::BoostAdjacencyList(Index numVertices) : numVertices_(numVertices) { }
 
 void BoostAdjacencyList::Connect(Index a, Index b, Scalar weight) {
@@ -14,13 +21,7 @@ void BoostAdjacencyList::Connect(Index a, Index b, Scalar weight) {
 }
 
 std::shared_ptr<BoostAdjacencyList::BoostGraph> BoostAdjacencyList::GetBoostGraph() {
-  BoostGraphData graph(&edges_[0], &edges_[0] + edges_.size(), &weights_[0], numVertices_);
-  IndexMap index = get(boost::vertex_index, graph);
-  std::shared_ptr<BoostGraph> boostGraph(new BoostGraph());
-  boostGraph->numVertices = numVertices_;
-  boostGraph->graph = graph;
-  boostGraph->index = index;
-  return boostGraph;
+  return std::make_shared<BoostGraph>(edges_, weights_, numVertices_);
 }
 
 Index BoostAdjacencyList::NumVertices() const {
@@ -0,0 +1,38 @@
+//
+// Created on 10/19/26.
+//
+
+#include <hsisomap/graph/BoostCSRGraph.h>
+
+namespace GraphUtils {
+
+BoostCSRGraph::BoostGraph::BoostGraph(const std::vector<Edge> &edges,
+                                      const std::vector<EdgeProperty> &properties,
+                                      Index numVertices)
+    : graph(boost::edges_are_unsorted_multi_pass, edges.begin(), edges.end(), properties.begin(), numVertices),
+      numVertices(numVertices) { }
+
+BoostCSRGraph::BoostCSRGraph(Index numVertices) : numVertices_(numVertices) { }
+
+void BoostCSRGraph::Connect(Index a, Index b, Scalar weight) {
+  edges_.push_back(Edge(a, b));
+  edges_.push_back(Edge(b, a));
+  properties_.push_back(EdgeProperty{weight});
+  properties_.push_back(EdgeProperty{weight});
+  boostGraph_.reset();
+}
+
+std::shared_ptr<BoostCSRGraph::BoostGraph> BoostCSRGraph::GetBoostGraph() {
+  if (!boostGraph_) boostGraph_ = std::make_shared<BoostGraph>(edges_, properties_, numVertices_);
+  return boostGraph_;
+}
+
+Index BoostCSRGraph::NumVertices() const {
+  return numVertices_;
+}
+
+Index BoostCSRGraph::NumEdges() const {
+  return edges_.size() / 2;
+}
+
+}
@@ -0,0 +1,155 @@
+//
+// Created on 10/19/26.
+//
+
+#include <hsisomap/graph/CSRGraph.h>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+namespace GraphUtils {
+
+namespace {
+
+//! Sort the entries of every vertex by neighbor and keep the last entry of each neighbor, then close the gaps.
+void SortAndDeduplicate(std::vector<Index> &offsets, std::vector<Index> &neighbors, std::vector<Scalar> &weights) {
+  std::vector<std::pair<Index, Scalar>> entries;
+  Index write = 0;
+  for (Index v = 0; v + 1 < offsets.size(); ++v) {
+    Index begin = offsets[v], end = offsets[v + 1];
+    entries.clear();
+    for (Index e = begin; e < end; ++e) entries.push_back(std::make_pair(neighbors[e], weights[e]));
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const std::pair<Index, Scalar> &x, const std::pair<Index, Scalar> &y) { return x.first < y.first; });
+    offsets[v] = write;
+    for (Index i = 0; i < entries.size(); ++i) {
+      if (i + 1 < entries.size() && entries[i + 1].first == entries[i].first) continue;
+      neighbors[write] = entries[i].first;
+      weights[write] = entries[i].second;
+      ++write;
+    }
+  }
+  offsets.back() = write;
+  neighbors.resize(write);
+  weights.resize(write);
+}
+
+}
+
+CSRGraph::CSRGraph(Index numVertices) : numVertices_(numVertices), offsets_(numVertices + 1, 0) { }
+
+CSRGraph::CSRGraph(Index numVertices, Index k, const std::vector<Index> &neighbors, const std::vector<Scalar> &weights)
+    : numVertices_(numVertices), offsets_(numVertices + 1, 0) {
+  if (neighbors.size() != numVertices * k || weights.size() != numVertices * k) {
+    throw std::invalid_argument("The neighbor and weight tables should have numVertices x k entries.");
+  }
+
+  // Counting sort of both directions of every edge by source vertex.
+  for (Index v = 0; v < numVertices; ++v) {
+    for (Index j = 0; j < k; ++j) {
+      Index u = neighbors[v * k + j];
+      if (u == v) continue;
+      ++offsets_[v + 1];
+      ++offsets_[u + 1];
+    }
+  }
+  std::partial_sum(offsets_.begin(), offsets_.end(), offsets_.begin());
+  neighbors_.resize(offsets_.back());
+  weights_.resize(offsets_.back());
+  std::vector<Index> fill(offsets_.begin(), offsets_.end() - 1);
+  for (Index v = 0; v < numVertices; ++v) {
+    for (Index j = 0; j < k; ++j) {
+      Index u = neighbors[v * k + j];
+      if (u == v) continue;
+      neighbors_[fill[v]] = u;
+      weights_[fill[v]++] = weights[v * k + j];
+      neighbors_[fill[u]] = v;
+      weights_[fill[u]++] = weights[v * k + j];
+    }
+  }
+
+  SortAndDeduplicate(offsets_, neighbors_, weights_);
+}
+
+void CSRGraph::Connect(Index a, Index b, Scalar weight) {
+  if (a == b) return;
+  pending_.push_back(PendingEdge{a, b, weight});
+}
+
+void CSRGraph::Compact() const {
+  if (pending_.empty()) return;
+
+  std::vector<Index> offsets(numVertices_ + 1, 0);
+  for (Index v = 0; v < numVertices_; ++v) offsets[v + 1] = offsets_[v + 1] - offsets_[v];
+  for (const auto &edge : pending_) {
+    ++offsets[edge.a + 1];
+    ++offsets[edge.b + 1];
+  }
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+  // Existing entries first, so that the entries added later win in the deduplication.
+  std::vector<Index> neighbors(offsets.back());
+  std::vector<Scalar> weights(offsets.back());
+  std::vector<Index> fill(offsets.begin(), offsets.end() - 1);
+  for (Index v = 0; v < numVertices_; ++v) {
+    for (Index e = offsets_[v]; e < offsets_[v + 1]; ++e) {
+      neighbors[fill[v]] = neighbors_[e];
+      weights[fill[v]++] = weights_[e];
+    }
+  }
+  for (const auto &edge : pending_) {
+    neighbors[fill[edge.a]] = edge.b;
+    weights[fill[edge.a]++] = edge.weight;
+    neighbors[fill[edge.b]] = edge.a;
+    weights[fill[edge.b]++] = edge.weight;
+  }
+
+  SortAndDeduplicate(offsets, neighbors, weights);
+  offsets_.swap(offsets);
+  neighbors_.swap(neighbors);
+  weights_.swap(weights);
+  pending_.clear();
+  pending_.shrink_to_fit();
+}
+
+Index CSRGraph::NumVertices() const {
+  return numVertices_;
+}
+
+Index CSRGraph::NumEdges() const {
+  Compact();
+  return neighbors_.size();
+}
+
+const std::vector<Index> &CSRGraph::offsets() const {
+  Compact();
+  return offsets_;
+}
+
+const std::vector<Index> &CSRGraph::neighbors() const {
+  Compact();
+  return neighbors_;
+}
+
+const std::vector<Scalar> &CSRGraph::weights() const {
+  Compact();
+  return weights_;
+}
+
+template <typename T_Index, typename T_Scalar>
+std::shared_ptr<GraphArray<T_Index, T_Scalar>> CSRGraph::GetGraphArray() const {
+  Compact();
+  auto graph = std::make_shared<GraphArray<T_Index, T_Scalar>>();
+  graph->vertices.assign(offsets_.begin(), offsets_.end() - 1);
+  graph->edges.assign(neighbors_.begin(), neighbors_.end());
+  graph->weights.assign(weights_.begin(), weights_.end());
+  return graph;
+}
+
+// explicit instantiations
+template std::shared_ptr<GraphArray<size_t, float>> CSRGraph::GetGraphArray<size_t, float>() const;
+template std::shared_ptr<GraphArray<size_t, double>> CSRGraph::GetGraphArray<size_t, double>() const;
+template std::shared_ptr<GraphArray<int, float>> CSRGraph::GetGraphArray<int, float>() const;
+template std::shared_ptr<GraphArray<int, double>> CSRGraph::GetGraphArray<int, double>() const;
+
+} // namespace GraphUtils
@@ -2,39 +2,79 @@
 // Created by Can on 9/18/15.
 //
 
+#include <algorithm>
+#include <limits>
 #include <numeric>
 #include <gsl/gsl_matrix_double.h>
+#include <boost/property_map/property_map.hpp>
 #include <hsisomap/graph/dijkstra/BoostDijkstra.h>
+#include <hsisomap/util/Parallel.h>
 
 
 namespace Dijkstra {
 
-typedef GraphUtils::BoostAdjacencyList::BoostGraphData BoostGraphData;
-typedef GraphUtils::BoostAdjacencyList::Vertex Vertex;
-
-BoostDijkstra::BoostDijkstra(std::shared_ptr<GraphUtils::BoostAdjacencyList> adjList)
+BoostDijkstra::BoostDijkstra(std::shared_ptr<GraphUtils::BoostAdjacencyList> adjList, Index threads)
     : graph_(adjList->GetBoostGraph()),
       numVertices_(graph_->numVertices),
+      threads_(threads),
       sourceVertices_(graph_->numVertices, 0) {
   std::iota(sourceVertices_.begin(), sourceVertices_.end(), 0);
 }
 
+BoostDijkstra::BoostDijkstra(std::shared_ptr<GraphUtils::BoostCSRGraph> csrGraph, Index threads)
+    : csrGraph_(csrGraph->GetBoostGraph()),
+      numVertices_(csrGraph_->numVertices),
+      threads_(threads),
+      sourceVertices_(csrGraph_->numVertices, 0) {
+  std::iota(sourceVertices_.begin(), sourceVertices_.end(), 0);
+}
+
 void BoostDijkstra::SetSourceVertices(std::vector<Index> sourceVertices) {
   sourceVertices_.resize(sourceVertices.size());
   std::copy(sourceVertices.begin(), sourceVertices.end(), sourceVertices_.begin());
 }
 
 int BoostDijkstra::Run() {
-  distanceMatrix_ = std::make_shared<gsl::Matrix>(sourceVertices_.size(), graph_->numVertices);
+  auto distanceMatrix = std::make_shared<gsl::Matrix>(sourceVertices_.size(), numVertices_);
+  Run(MatrixRowSink(*distanceMatrix));
+  distanceMatrix_ = distanceMatrix;
+  return 0;
+}
 
-  boost::graph_traits<BoostGraphData>::vertex_iterator vi;
-  for (Index i = 0; i < sourceVertices_.size(); ++i) {
-    Vertex source = boost::vertex(sourceVertices_[i], graph_->graph);
-    boost::dijkstra_shortest_paths(graph_->graph, source, boost::distance_map(&distanceMatrix_->m_->data[i * numVertices_]));
+int BoostDijkstra::Run(const DistanceRowSink &sink) {
+  distanceMatrix_.reset();
+  if (csrGraph_) {
+    RunGraph(csrGraph_->graph, boost::get(&GraphUtils::BoostCSRGraph::EdgeProperty::weight, csrGraph_->graph), sink);
+  } else {
+    RunGraph(graph_->graph, boost::get(boost::edge_weight, graph_->graph), sink);
   }
   return 0;
 }
 
+template<typename T_Graph, typename T_WeightMap>
+void BoostDijkstra::RunGraph(const T_Graph &graph, T_WeightMap weight, const DistanceRowSink &sink) {
+  // Both representations store the vertices in a vector, so the vertex indices are the vertex descriptors.
+  auto index = boost::get(boost::vertex_index, graph);
+  Index threads = std::min(hsisomap::ParallelThreadCount(threads_), std::max<Index>(1, sourceVertices_.size()));
+  std::vector<std::vector<boost::default_color_type>> colors(threads);
+  std::vector<std::vector<Scalar>> rows(threads);
+
+  hsisomap::ParallelFor(0, sourceVertices_.size(), [&](Index i, Index thread) {
+    rows[thread].assign(numVertices_, std::numeric_limits<Scalar>::max());
+    Scalar *distances = rows[thread].data();
+    colors[thread].assign(numVertices_, boost::white_color);
+
+    auto source = boost::vertex(sourceVertices_[i], graph);
+    distances[sourceVertices_[i]] = 0;
+    boost::dijkstra_shortest_paths_no_init(graph, source, boost::dummy_property_map(),
+                                           boost::make_iterator_property_map(distances, index), weight, index,
+                                           std::less<Scalar>(), boost::closed_plus<Scalar>(), Scalar(0),
+                                           boost::default_dijkstra_visitor(),
+                                           boost::make_iterator_property_map(colors[thread].begin(), index));
+    sink(i, distances);
+  }, threads, 1);
+}
+
 std::shared_ptr<gsl::Matrix> BoostDijkstra::GetDistanceMatrix() {
   return distanceMatrix_;
 }
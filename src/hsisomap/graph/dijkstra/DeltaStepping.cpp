@@ -0,0 +1,226 @@
+//
+// Created on 10/19/26.
+//
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <hsisomap/graph/dijkstra/DeltaStepping.h>
+#include <hsisomap/util/Parallel.h>
+
+namespace Dijkstra {
+
+namespace {
+
+//! Run body(i) over the chunks of [0, size) taken from a counter shared by a team of threads.
+template<typename Function>
+void TakeChunks(std::atomic<Index> &nextChunk, Index size, Index team, Function body) {
+  Index chunk = std::max<Index>(1, size / (team * 16));
+  for (Index first = nextChunk.fetch_add(chunk); first < size; first = nextChunk.fetch_add(chunk)) {
+    for (Index i = first; i < std::min(first + chunk, size); ++i) body(i);
+  }
+}
+
+}
+
+DeltaStepping::DeltaStepping(std::shared_ptr<GraphUtils::AdjacencyList> adjList, Index threads, Scalar delta)
+    : graph_(adjList->GetGraphArray<Index, Scalar>()),
+      numVertices_(graph_->vertices.size()),
+      threads_(hsisomap::ParallelThreadCount(threads)),
+      sourceVertices_(graph_->vertices.size(), 0),
+      tentative_(new std::atomic<Scalar>[graph_->vertices.size()]),
+      settled_(threads_) {
+  std::iota(sourceVertices_.begin(), sourceVertices_.end(), 0);
+  SetDelta(delta);
+}
+
+DeltaStepping::DeltaStepping(std::shared_ptr<GraphUtils::CSRGraph> csrGraph, Index threads, Scalar delta)
+    : graph_(csrGraph->GetGraphArray<Index, Scalar>()),
+      numVertices_(graph_->vertices.size()),
+      threads_(hsisomap::ParallelThreadCount(threads)),
+      sourceVertices_(graph_->vertices.size(), 0),
+      tentative_(new std::atomic<Scalar>[graph_->vertices.size()]),
+      settled_(threads_) {
+  std::iota(sourceVertices_.begin(), sourceVertices_.end(), 0);
+  SetDelta(delta);
+}
+
+void DeltaStepping::SetDelta(Scalar delta) {
+  std::vector<Index> &vertices = graph_->vertices;
+  std::vector<Index> &edges = graph_->edges;
+  std::vector<Scalar> &weights = graph_->weights;
+
+  Scalar maxWeight = weights.empty() ? 0 : *std::max_element(weights.begin(), weights.end());
+  if (delta <= 0) {
+    std::vector<Scalar> sorted(weights);
+    if (!sorted.empty()) std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2, sorted.end());
+    delta = sorted.empty() ? 0 : DELTASTEPPING_AUTO_DELTA_MEDIAN_SCALE * sorted[sorted.size() / 2];
+    // All zero weights, or no edges at all: one bucket holds every distance.
+    if (delta <= 0) delta = maxWeight > 0 ? maxWeight : 1;
+  }
+  delta_ = delta;
+  numBuckets_ = static_cast<Index>(maxWeight / delta_) + 2;
+
+  // Move the light edges of each vertex before its heavy edges
+  lightEnd_.resize(numVertices_);
+  std::vector<std::pair<Index, Scalar>> adjacency;
+  for (Index vertex = 0; vertex < numVertices_; ++vertex) {
+    Index edgeBegin = vertices[vertex];
+    Index edgeEnd = vertex + 1 < numVertices_ ? vertices[vertex + 1] : edges.size();
+    adjacency.clear();
+    for (Index edge = edgeBegin; edge < edgeEnd; ++edge) adjacency.push_back(std::make_pair(edges[edge], weights[edge]));
+    auto heavy = std::stable_partition(adjacency.begin(), adjacency.end(),
+                                       [this](const std::pair<Index, Scalar> &e) { return e.second <= delta_; });
+    lightEnd_[vertex] = edgeBegin + (heavy - adjacency.begin());
+    for (Index e = 0; e < adjacency.size(); ++e) {
+      edges[edgeBegin + e] = adjacency[e].first;
+      weights[edgeBegin + e] = adjacency[e].second;
+    }
+  }
+
+  buckets_.assign(threads_, std::vector<std::vector<BucketEntry>>(numBuckets_));
+}
+
+Scalar DeltaStepping::delta() const {
+  return delta_;
+}
+
+void DeltaStepping::SetSourceVertices(std::vector<Index> sourceVertices) {
+  sourceVertices_.resize(sourceVertices.size());
+  std::copy(sourceVertices.begin(), sourceVertices.end(), sourceVertices_.begin());
+}
+
+int DeltaStepping::Run() {
+  distanceMatrix_ = std::make_shared<gsl::Matrix>(sourceVertices_.size(), numVertices_);
+  for (Index i = 0; i < sourceVertices_.size(); ++i) {
+    ShortestDistances(sourceVertices_[i], distanceMatrix_->m_->data + i * distanceMatrix_->m_->tda);
+  }
+  return 0;
+}
+
+int DeltaStepping::Run(const DistanceRowSink &sink) {
+  distanceMatrix_.reset();
+  std::vector<Scalar> row(numVertices_);
+  for (Index i = 0; i < sourceVertices_.size(); ++i) {
+    ShortestDistances(sourceVertices_[i], row.data());
+    sink(i, row.data());
+  }
+  return 0;
+}
+
+std::shared_ptr<gsl::Matrix> DeltaStepping::GetDistanceMatrix() {
+  return distanceMatrix_;
+}
+
+void DeltaStepping::ShortestDistances(Index source, Scalar *distances) {
+  const std::vector<Index> &vertices = graph_->vertices;
+  const std::vector<Index> &edges = graph_->edges;
+  const std::vector<Scalar> &weights = graph_->weights;
+  if (source >= numVertices_) throw std::invalid_argument("DeltaStepping source vertex out of range.");
+
+  // One team of threads runs the whole source. Thread 0 picks the buckets and gathers the frontiers between the
+  // barriers, and the threads take chunks of the frontier from a shared counter.
+  std::atomic<Index> nextChunk(0);
+  Index current = 0;
+  bool done = false;
+  hsisomap::ParallelTeam(threads_, [&](Index thread, hsisomap::ParallelBarrier &barrier) {
+    Index sliceBegin = numVertices_ * thread / threads_;
+    Index sliceEnd = numVertices_ * (thread + 1) / threads_;
+    for (Index vertex = sliceBegin; vertex < sliceEnd; ++vertex) {
+      tentative_[vertex].store(std::numeric_limits<Scalar>::max(), std::memory_order_relaxed);
+    }
+    barrier.Wait();
+    if (thread == 0) {
+      tentative_[source].store(0, std::memory_order_relaxed);
+      buckets_[0][0].push_back(BucketEntry(source, 0));
+    }
+
+    for (;;) {
+      // All the pending distances are below the current bucket plus the maximum edge weight, so the scan for the
+      // next non-empty bucket wraps around the cyclic buckets at most once.
+      if (thread == 0) {
+        Index next = current;
+        for (; next < current + numBuckets_; ++next) {
+          bool empty = true;
+          for (auto &threadBuckets : buckets_) empty = empty && threadBuckets[next % numBuckets_].empty();
+          if (!empty) break;
+        }
+        done = next == current + numBuckets_;
+        current = next;
+        for (auto &threadSettled : settled_) threadSettled.clear();
+        if (!done) GatherBucket(current);
+        nextChunk = 0;
+      }
+      barrier.Wait();
+      if (done) break;
+
+      // Relax the light edges of the bucket until no vertex is put back into it
+      while (!frontier_.empty()) {
+        // The small frontiers are left to fewer threads
+        if (thread < TeamSize(frontier_.size())) TakeChunks(nextChunk, frontier_.size(), TeamSize(frontier_.size()), [&](Index i) {
+          Index vertex = frontier_[i].first;
+          Scalar distance = frontier_[i].second;
+          // A stale entry: the vertex was put in a bucket again with a shorter distance
+          if (tentative_[vertex].load(std::memory_order_relaxed) < distance) return;
+          settled_[thread].push_back(vertex);
+          for (Index edge = vertices[vertex]; edge < lightEnd_[vertex]; ++edge) {
+            Relax(edges[edge], distance + weights[edge], thread);
+          }
+        });
+        barrier.Wait();
+        if (thread == 0) {
+          GatherBucket(current);
+          nextChunk = 0;
+        }
+        barrier.Wait();
+      }
+
+      // Relax the heavy edges of the settled vertices once; they lead to the later buckets only
+      if (thread == 0) {
+        settledAll_.clear();
+        for (auto &threadSettled : settled_) settledAll_.insert(settledAll_.end(), threadSettled.begin(), threadSettled.end());
+        nextChunk = 0;
+      }
+      barrier.Wait();
+      if (thread < TeamSize(settledAll_.size())) TakeChunks(nextChunk, settledAll_.size(), TeamSize(settledAll_.size()), [&](Index i) {
+        Index vertex = settledAll_[i];
+        Scalar distance = tentative_[vertex].load(std::memory_order_relaxed);
+        Index edgeEnd = vertex + 1 < numVertices_ ? vertices[vertex + 1] : edges.size();
+        for (Index edge = lightEnd_[vertex]; edge < edgeEnd; ++edge) {
+          Relax(edges[edge], distance + weights[edge], thread);
+        }
+      });
+      barrier.Wait();
+    }
+
+    for (Index vertex = sliceBegin; vertex < sliceEnd; ++vertex) {
+      distances[vertex] = tentative_[vertex].load(std::memory_order_relaxed);
+    }
+  });
+}
+
+void DeltaStepping::Relax(Index vertex, Scalar distance, Index thread) {
+  Scalar tentative = tentative_[vertex].load(std::memory_order_relaxed);
+  while (distance < tentative) {
+    if (tentative_[vertex].compare_exchange_weak(tentative, distance, std::memory_order_relaxed)) {
+      buckets_[thread][static_cast<Index>(distance / delta_) % numBuckets_].push_back(BucketEntry(vertex, distance));
+      return;
+    }
+  }
+}
+
+void DeltaStepping::GatherBucket(Index bucket) {
+  frontier_.clear();
+  for (auto &threadBuckets : buckets_) {
+    std::vector<BucketEntry> &entries = threadBuckets[bucket % numBuckets_];
+    frontier_.insert(frontier_.end(), entries.begin(), entries.end());
+    entries.clear();
+  }
+}
+
+Index DeltaStepping::TeamSize(Index vertices) const {
+  return std::max<Index>(1, std::min(threads_, vertices / DELTASTEPPING_MIN_VERTICES_PER_THREAD));
+}
+
+}
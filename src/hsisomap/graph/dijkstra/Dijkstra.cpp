@@ -2,29 +2,70 @@
 // Created by Can on 9/18/15.
 //
 
+#include <algorithm>
 #include <hsisomap/graph/dijkstra/Dijkstra.h>
 #include <hsisomap/graph/AdjacencyList.h>
 #include <hsisomap/graph/BoostAdjacencyList.h>
+#include <hsisomap/graph/BoostCSRGraph.h>
+#include <hsisomap/graph/CSRGraph.h>
 #include <hsisomap/graph/dijkstra/DijkstraCL.h>
 #include <hsisomap/graph/dijkstra/BoostDijkstra.h>
+#include <hsisomap/graph/dijkstra/DijkstraCPU.h>
+#include <hsisomap/graph/dijkstra/DeltaStepping.h>
+#include <hsisomap/graph/dijkstra/LaneBellmanFord.h>
 
 namespace Dijkstra {
 
+DistanceRowSink MatrixRowSink(gsl::Matrix &matrix) {
+  gsl_matrix *m = matrix.m_;
+  return [m](Index row, const Scalar *distances) {
+    std::copy(distances, distances + m->size2, m->data + row * m->tda);
+  };
+}
 
 std::shared_ptr<Dijkstra> DijkstraWithImplementation(DijkstraImplementations dijkstraImplementations,
-                                                     std::shared_ptr<::GraphUtils::UndirectedWeightedGraph> graph) {
+                                                     std::shared_ptr<::GraphUtils::UndirectedWeightedGraph> graph,
+                                                     Index threads) {
   switch (dijkstraImplementations) {
     case DIJKSTRA_IMPLEMENTATION_CL:
       if (auto p = std::dynamic_pointer_cast<::GraphUtils::AdjacencyList>(graph)) {
         return std::dynamic_pointer_cast<Dijkstra>(std::make_shared<DijkstraCL>(p));
+      } else if (auto p = std::dynamic_pointer_cast<::GraphUtils::CSRGraph>(graph)) {
+        return std::dynamic_pointer_cast<Dijkstra>(std::make_shared<DijkstraCL>(p));
       } else {
-        throw std::invalid_argument("DIJKSTRA_IMPLEMENTATION_CL only accepts GraphUtils::AdjacencyList.");
+        throw std::invalid_argument("DIJKSTRA_IMPLEMENTATION_CL only accepts GraphUtils::AdjacencyList or GraphUtils::CSRGraph.");
       }
     case DIJKSTRA_IMPLEMENTATION_BOOST:
-      if (auto p = std::dynamic_pointer_cast<::GraphUtils::BoostAdjacencyList>(graph)) {
-        return std::dynamic_pointer_cast<Dijkstra>(std::make_shared<BoostDijkstra>(p));
+      if (auto p = std::dynamic_pointer_cast<::GraphUtils::BoostCSRGraph>(graph)) {
+        return std::dynamic_pointer_cast<Dijkstra>(std::make_shared<BoostDijkstra>(p, threads));
+      } else if (auto p = std::dynamic_pointer_cast<::GraphUtils::BoostAdjacencyList>(graph)) {
+        return std::dynamic_pointer_cast<Dijkstra>(std::make_shared<BoostDijkstra>(p, threads));
+      } else {
+        throw std::invalid_argument("DIJKSTRA_IMPLEMENTATION_BOOST only accepts GraphUtils::BoostCSRGraph or GraphUtils::BoostAdjacencyList.");
+      }
+    case DIJKSTRA_IMPLEMENTATION_CPU_PARALLEL:
+      if (auto p = std::dynamic_pointer_cast<::GraphUtils::CSRGraph>(graph)) {
+        return std::dynamic_pointer_cast<Dijkstra>(std::make_shared<DijkstraCPU>(p, threads));
+      } else if (auto p = std::dynamic_pointer_cast<::GraphUtils::AdjacencyList>(graph)) {
+        return std::dynamic_pointer_cast<Dijkstra>(std::make_shared<DijkstraCPU>(p, threads));
+      } else {
+        throw std::invalid_argument("DIJKSTRA_IMPLEMENTATION_CPU_PARALLEL only accepts GraphUtils::CSRGraph or GraphUtils::AdjacencyList.");
+      }
+    case DIJKSTRA_IMPLEMENTATION_DELTA_STEPPING:
+      if (auto p = std::dynamic_pointer_cast<::GraphUtils::CSRGraph>(graph)) {
+        return std::dynamic_pointer_cast<Dijkstra>(std::make_shared<DeltaStepping>(p, threads));
+      } else if (auto p = std::dynamic_pointer_cast<::GraphUtils::AdjacencyList>(graph)) {
+        return std::dynamic_pointer_cast<Dijkstra>(std::make_shared<DeltaStepping>(p, threads));
+      } else {
+        throw std::invalid_argument("DIJKSTRA_IMPLEMENTATION_DELTA_STEPPING only accepts GraphUtils::CSRGraph or GraphUtils::AdjacencyList.");
+      }
+    case DIJKSTRA_IMPLEMENTATION_LANE_BELLMAN_FORD:
+      if (auto p = std::dynamic_pointer_cast<::GraphUtils::CSRGraph>(graph)) {
+        return std::dynamic_pointer_cast<Dijkstra>(std::make_shared<LaneBellmanFord>(p, threads));
+      } else if (auto p = std::dynamic_pointer_cast<::GraphUtils::AdjacencyList>(graph)) {
+        return std::dynamic_pointer_cast<Dijkstra>(std::make_shared<LaneBellmanFord>(p, threads));
       } else {
-        throw std::invalid_argument("DIJKSTRA_IMPLEMENTATION_BOOST only accepts GraphUtils::BoostAdjacencyList.");
+        throw std::invalid_argument("DIJKSTRA_IMPLEMENTATION_LANE_BELLMAN_FORD only accepts GraphUtils::CSRGraph or GraphUtils::AdjacencyList.");
       }
   }
 }
@@ -2,23 +2,94 @@
 // Created by Can on 3/14/15.
 //
 
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
 #include <numeric>
+#include <sstream>
+#include <stdexcept>
 #include <vector>
 #include <hsisomap/graph/dijkstra/DijkstraCL.h>
+#include <hsisomap/Logger.h>
 
 namespace Dijkstra {
 
+namespace {
+
+std::string PlatformInfo(cl_platform_id platform, cl_platform_info parameter) {
+  size_t size = 0;
+  if (clGetPlatformInfo(platform, parameter, 0, NULL, &size) != CL_SUCCESS || size == 0) return std::string();
+  std::vector<char> value(size);
+  clGetPlatformInfo(platform, parameter, size, &value[0], NULL);
+  return std::string(&value[0]);
+}
+
+std::string DeviceInfo(cl_device_id device, cl_device_info parameter) {
+  size_t size = 0;
+  if (clGetDeviceInfo(device, parameter, 0, NULL, &size) != CL_SUCCESS || size == 0) return std::string();
+  std::vector<char> value(size);
+  clGetDeviceInfo(device, parameter, size, &value[0], NULL);
+  return std::string(&value[0]);
+}
+
+cl_device_type DeviceType(cl_device_id device) {
+  cl_device_type type = 0;
+  clGetDeviceInfo(device, CL_DEVICE_TYPE, sizeof(type), &type, NULL);
+  return type;
+}
+
+// Note that the float max value is directly converted to double max value for convenience.
+// This is assuming the client code is aware of possible imprecision:
+// e.g., if client code use double as Scalar, and OpenCL device only supports float as cl_Scalar,
+// then cl_Scalar overflow doesn't mean a Scalar overflow.
+// However, this is ok for almost all applications since the "overflow" here just means no connection.
+Scalar ScalarDistance(DijkstraCL::cl_Scalar cost) {
+  if (cost == std::numeric_limits<DijkstraCL::cl_Scalar>::max()) return std::numeric_limits<Scalar>::max();
+  return static_cast<Scalar>(cost);
+}
+
+// The runtimes of the process by device, and the program cache directory. They are never destroyed, since the
+// OpenCL runtime may be unloaded before the static objects at exit.
+struct Runtimes {
+  std::mutex mutex;
+  std::map<cl_device_id, std::shared_ptr<DijkstraCLRuntime>> devices;
+  std::string programCacheDirectory;
+};
+
+Runtimes &ProcessRuntimes() {
+  static Runtimes *runtimes = new Runtimes;
+  return *runtimes;
+}
+
+// FNV-1a hash, stable across runs and compilers, for the program cache file names.
+std::string CacheKeyHash(const std::string &key) {
+  unsigned long long hash = 14695981039346656037ULL;
+  for (unsigned char c : key) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  std::ostringstream name;
+  name << std::hex << hash;
+  return name.str();
+}
+
+}
+
 //! checkError macro to incorporate the line of code with error for convenient debugging.
 #define checkError() checkErrorFileLine(__FILE__ , __LINE__)
 
+// The kernels work on a batch of sources. Dimension 0 of the NDRange is the vertex and dimension 1 is the source
+// in the batch; the vertex arrays hold one slab of stride elements per source.
 const char *programSource = R"(
 __kernel void OCL_SSSP_KERNEL1(__global int *vertices, __global int *edges, __global float *weights,
                                __global int *masks, __global float *costs, __global float *updatingCosts,
-                               int vertexCount, int edgeCount ) {
+                               int vertexCount, int edgeCount, int stride) {
   int tid = get_global_id(0);
+  int slab = get_global_id(1) * stride;
 
-  if (masks[tid] != 0) {
-    masks[tid] = 0;
+  if (tid < vertexCount && masks[slab + tid] != 0) {
+    masks[slab + tid] = 0;
 
     int edgeStart = vertices[tid];
     int edgeEnd;
@@ -28,58 +99,155 @@ __kernel void OCL_SSSP_KERNEL1(__global int *vertices, __global int *edges, __gl
       edgeEnd = edgeCount;
     }
 
+    float cost = costs[slab + tid];
     for(int edge = edgeStart; edge < edgeEnd; edge++) {
-      int nid = edges[edge];
-      if (updatingCosts[nid] > (costs[tid] + weights[edge])) {
-        updatingCosts[nid] = (costs[tid] + weights[edge]);
-      }
+      // The costs are not negative, so their bit patterns are ordered as ints; atomic_min keeps the least update.
+      atomic_min((volatile __global int *) &updatingCosts[slab + edges[edge]], as_int(cost + weights[edge]));
     }
   }
 }
 
-__kernel void OCL_SSSP_KERNEL2(__global int *vertices, __global int *edges, __global float *weights,
-                               __global int *masks, __global float *costs, __global float *updatingCosts,
-                               int vertexCount) {
-  int tid = get_global_id(0);
+__kernel void OCL_SSSP_KERNEL2(__global int *masks, __global float *costs, __global float *updatingCosts,
+                               __global int *changed, int stride) {
+  int tid = get_global_id(1) * stride + get_global_id(0);
 
   if (costs[tid] > updatingCosts[tid]) {
     costs[tid] = updatingCosts[tid];
     masks[tid] = 1;
+    atomic_or(changed, 1);
   }
 
   updatingCosts[tid] = costs[tid];
 }
 
 __kernel void initializeBuffers(__global int *masks, __global float *costs, __global float *updatingCosts,
-                                int sourceVertex, int vertexCount ) {
+                                __global int *sources, int stride) {
   int tid = get_global_id(0);
+  int slab = get_global_id(1) * stride;
 
-  if (sourceVertex == tid) {
-    masks[tid] = 1;
-    costs[tid] = 0.0;
-    updatingCosts[tid] = 0.0;
+  if (sources[get_global_id(1)] == tid) {
+    masks[slab + tid] = 1;
+    costs[slab + tid] = 0.0;
+    updatingCosts[slab + tid] = 0.0;
   } else {
-    masks[tid] = 0;
-    costs[tid] = FLT_MAX;
-    updatingCosts[tid] = FLT_MAX;
+    masks[slab + tid] = 0;
+    costs[slab + tid] = FLT_MAX;
+    updatingCosts[slab + tid] = FLT_MAX;
+  }
+}
+
+// The frontier kernels keep the vertices to relax in a queue of offsets into the slabs of the batch. A mask marks
+// a vertex already in the next queue, so that each vertex is queued once per iteration.
+__kernel void initializeQueue(__global int *masks, __global int *sources, __global int *queue, int count, int stride) {
+  int tid = get_global_id(0);
+
+  if (tid < count) {
+    queue[tid] = tid * stride + sources[tid];
+    masks[tid * stride + sources[tid]] = 0;
+  }
+}
+
+__kernel void OCL_SSSP_FRONTIER_KERNEL1(__global int *vertices, __global int *edges, __global float *weights,
+                                        __global int *masks, __global float *costs, __global float *updatingCosts,
+                                        __global int *queue, int queueLength,
+                                        __global int *nextQueue, __global int *nextQueueLength,
+                                        int vertexCount, int edgeCount, int stride) {
+  int tid = get_global_id(0);
+
+  if (tid < queueLength) {
+    int offset = queue[tid];
+    int slab = offset / stride * stride;
+    int vertex = offset - slab;
+
+    int edgeStart = vertices[vertex];
+    int edgeEnd;
+    if (vertex + 1 < (vertexCount)) {
+      edgeEnd = vertices[vertex + 1];
+    } else {
+      edgeEnd = edgeCount;
+    }
+
+    float cost = costs[offset];
+    for(int edge = edgeStart; edge < edgeEnd; edge++) {
+      int target = slab + edges[edge];
+      int updatingCost = as_int(cost + weights[edge]);
+      // Queue the target if this lowered its cost and no other work item queued it yet.
+      if (updatingCost < atomic_min((volatile __global int *) &updatingCosts[target], updatingCost) &&
+          atomic_xchg(&masks[target], 1) == 0) {
+        nextQueue[atomic_inc(nextQueueLength)] = target;
+      }
+    }
+  }
+}
+
+__kernel void OCL_SSSP_FRONTIER_KERNEL2(__global int *masks, __global float *costs, __global float *updatingCosts,
+                                        __global int *queue, int queueLength) {
+  int tid = get_global_id(0);
+
+  if (tid < queueLength) {
+    int offset = queue[tid];
+    costs[offset] = updatingCosts[offset];
+    masks[offset] = 0;
   }
 }
 )";
 
+// The kernels of programSource, created once per runtime.
+const char *kernelNames[] = {"initializeBuffers", "OCL_SSSP_KERNEL1", "OCL_SSSP_KERNEL2",
+                             "initializeQueue", "OCL_SSSP_FRONTIER_KERNEL1", "OCL_SSSP_FRONTIER_KERNEL2"};
+
 DijkstraCL::DijkstraCL(std::shared_ptr<GraphUtils::AdjacencyList> adjList)
     : graph_(adjList->GetGraphArray<cl_Index, cl_Scalar>()),
       numVertices_(static_cast<cl_Index>(graph_->vertices.size())),
       sourceVertices_(graph_->vertices.size(), 0),
-      lastErr_(CL_SUCCESS) {
+      sink_(NULL),
+      lastErr_(CL_SUCCESS),
+      batchSize_(0),
+      kernelSet_(DIJKSTRACL_KERNELS_ALL_VERTICES),
+      counters_() {
+  std::iota(sourceVertices_.begin(), sourceVertices_.end(), 0);
+}
+
+DijkstraCL::DijkstraCL(std::shared_ptr<GraphUtils::CSRGraph> csrGraph)
+    : graph_(csrGraph->GetGraphArray<cl_Index, cl_Scalar>()),
+      numVertices_(static_cast<cl_Index>(graph_->vertices.size())),
+      sourceVertices_(graph_->vertices.size(), 0),
+      sink_(NULL),
+      lastErr_(CL_SUCCESS),
+      batchSize_(0),
+      kernelSet_(DIJKSTRACL_KERNELS_ALL_VERTICES),
+      counters_() {
   std::iota(sourceVertices_.begin(), sourceVertices_.end(), 0);
 }
 
 int DijkstraCL::Run() {
   // Allocate results array
   results_.reset(new std::vector<cl_Scalar>(sourceVertices_.size() * graph_->vertices.size(), 0));
+  sink_ = NULL;
+  return RunSources();
+}
+
+int DijkstraCL::Run(const DistanceRowSink &sink) {
+  results_.reset();
+  sink_ = &sink;
+  int err = RunSources();
+  sink_ = NULL;
+  return err;
+}
+
+int DijkstraCL::RunSources() {
   lastErr_ = InitializeDevices();
   if (lastErr_ != CL_SUCCESS) return lastErr_;
-  RunOnDevice(context_, device_);
+  counters_ = DijkstraCLCounters();
+  auto start = std::chrono::steady_clock::now();
+  {
+    std::lock_guard<std::mutex> lock(runtime_->mutex);
+    RunOnDevice(*runtime_, device_);
+  }
+  counters_.seconds = std::chrono::duration<Scalar>(std::chrono::steady_clock::now() - start).count();
+  LOGI("DijkstraCL " << (kernelSet_ == DIJKSTRACL_KERNELS_FRONTIER ? "frontier" : "all-vertices") << " kernels: "
+                     << counters_.iterations << " iterations, " << counters_.workItems << " work items, "
+                     << counters_.kernelSeconds << " s in kernels, " << counters_.seconds << " s on device.")
   return static_cast<int>(lastErr_);
 }
 
@@ -88,63 +256,180 @@ void DijkstraCL::SetSourceVertices(std::vector<Index> sourceVertices) {
   std::copy(sourceVertices.begin(), sourceVertices.end(), sourceVertices_.begin());
 }
 
+void DijkstraCL::SetDeviceSelection(StringPropertyList deviceSelection) {
+  deviceSelection_ = deviceSelection;
+}
+
+void DijkstraCL::SetBatchSize(Index batchSize) {
+  batchSize_ = batchSize;
+}
+
+void DijkstraCL::SetKernelSet(DijkstraCLKernelSet kernelSet) {
+  kernelSet_ = kernelSet;
+}
+
+void DijkstraCL::SetProgramCacheDirectory(std::string directory) {
+  std::lock_guard<std::mutex> lock(ProcessRuntimes().mutex);
+  ProcessRuntimes().programCacheDirectory = directory;
+}
+
+void DijkstraCL::ReleaseRuntimes() {
+  std::lock_guard<std::mutex> lock(ProcessRuntimes().mutex);
+  for (auto &device : ProcessRuntimes().devices) {
+    DijkstraCLRuntime &runtime = *device.second;
+    for (auto &kernel : runtime.kernels) clReleaseKernel(kernel.second);
+    clReleaseProgram(runtime.program);
+    clReleaseCommandQueue(runtime.commandQueue);
+    clReleaseCommandQueue(runtime.readbackQueue);
+    clReleaseContext(runtime.context);
+  }
+  ProcessRuntimes().devices.clear();
+}
+
+DijkstraCLCounters DijkstraCL::GetCounters() {
+  return counters_;
+}
+
 cl_int DijkstraCL::InitializeDevices() {
-  // Find the first OpenCL Plaform
-  cl_uint numPlatforms;
-  lastErr_ = clGetPlatformIDs(1, &platform_, &numPlatforms);
-  if (lastErr_ != CL_SUCCESS || numPlatforms <= 0) return lastErr_;
+  // Enumerate the OpenCL platforms
+  cl_uint numPlatforms = 0;
+  lastErr_ = clGetPlatformIDs(0, NULL, &numPlatforms);
+  if (lastErr_ != CL_SUCCESS) return lastErr_;
+  std::vector<cl_platform_id> platforms(numPlatforms);
+  if (numPlatforms > 0) {
+    lastErr_ = clGetPlatformIDs(numPlatforms, &platforms[0], NULL);
+    if (lastErr_ != CL_SUCCESS) return lastErr_;
+  }
+
+  cl_device_type deviceType = CL_DEVICE_TYPE_ALL;
+  std::string deviceTypeName = deviceSelection_[DIJKSTRACL_DEVICE_TYPE];
+  if (deviceTypeName == DIJKSTRACL_DEVICE_TYPE_GPU) {
+    deviceType = CL_DEVICE_TYPE_GPU;
+  } else if (deviceTypeName == DIJKSTRACL_DEVICE_TYPE_CPU) {
+    deviceType = CL_DEVICE_TYPE_CPU;
+  } else if (deviceTypeName == DIJKSTRACL_DEVICE_TYPE_ACCELERATOR) {
+    deviceType = CL_DEVICE_TYPE_ACCELERATOR;
+  } else if (!deviceTypeName.empty() && deviceTypeName != DIJKSTRACL_DEVICE_TYPE_ALL) {
+    throw std::invalid_argument("Unknown DIJKSTRACL_DEVICE_TYPE value: " + deviceTypeName + ".");
+  }
 
-  context_ = clCreateContextFromType(0, CL_DEVICE_TYPE_GPU, NULL, NULL, &lastErr_);
+  // Collect the matching devices of all the platforms
+  std::vector<cl_device_id> devices;
+  for (auto platform : platforms) {
+    if (PlatformInfo(platform, CL_PLATFORM_NAME).find(deviceSelection_[DIJKSTRACL_PLATFORM_NAME]) == std::string::npos) {
+      continue;
+    }
+    cl_uint numDevices = 0;
+    // A platform without devices of the type reports CL_DEVICE_NOT_FOUND
+    if (clGetDeviceIDs(platform, deviceType, 0, NULL, &numDevices) != CL_SUCCESS || numDevices == 0) continue;
+    std::vector<cl_device_id> platformDevices(numDevices);
+    if (clGetDeviceIDs(platform, deviceType, numDevices, &platformDevices[0], NULL) != CL_SUCCESS) continue;
+    for (auto device : platformDevices) {
+      if (DeviceInfo(device, CL_DEVICE_NAME).find(deviceSelection_[DIJKSTRACL_DEVICE_NAME]) != std::string::npos) {
+        devices.push_back(device);
+      }
+    }
+  }
+
+  // Without a device type, GPUs are preferred
+  if (deviceTypeName.empty()) {
+    std::vector<cl_device_id> gpus;
+    for (auto device : devices) {
+      if (DeviceType(device) & CL_DEVICE_TYPE_GPU) gpus.push_back(device);
+    }
+    if (!gpus.empty()) {
+      devices.swap(gpus);
+    } else if (!devices.empty()) {
+      LOGW("No OpenCL GPU device found, DijkstraCL falls back to the other devices.")
+    }
+  }
+
+  if (devices.empty()) {
+    LOGE("No OpenCL device matches the DijkstraCL device selection.")
+    return lastErr_ = CL_DEVICE_NOT_FOUND;
+  }
+
+  device_ = GetMaxFlopsDevice(devices);
+  lastErr_ = clGetDeviceInfo(device_, CL_DEVICE_PLATFORM, sizeof(platform_), &platform_, NULL);
   if (lastErr_ != CL_SUCCESS) return lastErr_;
-  device_ = GetMaxFlopsDevice();
 
+  // The first run on the device creates its runtime
+  {
+    std::lock_guard<std::mutex> lock(ProcessRuntimes().mutex);
+    auto &runtime = ProcessRuntimes().devices[device_];
+    if (!runtime) runtime = CreateRuntime(device_);
+    runtime_ = runtime;
+    if (!runtime) ProcessRuntimes().devices.erase(device_);
+  }
+  if (!runtime_) return lastErr_;
+
+  LOGI("DijkstraCL runs on OpenCL device " << DeviceInfo(device_, CL_DEVICE_NAME) << " of platform "
+                                           << PlatformInfo(platform_, CL_PLATFORM_NAME) << ".")
   return lastErr_;
 }
 
-cl_device_id DijkstraCL::GetMaxFlopsDevice() {
-  size_t parameterSize;
-  cl_device_id *devices;
-  clGetContextInfo(context_, CL_CONTEXT_DEVICES, 0, NULL, &parameterSize);
-  cl_device_id maxFlopsDevice;
+std::shared_ptr<DijkstraCLRuntime> DijkstraCL::CreateRuntime(cl_device_id device) {
+  cl_platform_id platform;
+  lastErr_ = clGetDeviceInfo(device, CL_DEVICE_PLATFORM, sizeof(platform), &platform, NULL);
+  if (lastErr_ != CL_SUCCESS) return nullptr;
+  cl_context_properties properties[] = {CL_CONTEXT_PLATFORM, reinterpret_cast<cl_context_properties>(platform), 0};
+  cl_context context = clCreateContext(properties, 1, &device, NULL, NULL, &lastErr_);
+  if (lastErr_ != CL_SUCCESS) return nullptr;
+
+  auto runtime = std::make_shared<DijkstraCLRuntime>();
+  runtime->context = context;
+  // The kernels run on one queue, the costs of finished batches are read back on the other.
+  // The kernel events are profiled for the counters.
+  runtime->commandQueue = clCreateCommandQueue(context, device, CL_QUEUE_PROFILING_ENABLE, &lastErr_); checkError();
+  runtime->readbackQueue = clCreateCommandQueue(context, device, 0, &lastErr_); checkError();
+  runtime->program = buildProgram(context, device);
+  for (auto name : kernelNames) {
+    runtime->kernels[name] = clCreateKernel(runtime->program, name, &lastErr_); checkError();
+  }
+  return runtime;
+}
 
-  {
-    devices = (cl_device_id *) malloc(parameterSize);
-    size_t deviceCount = parameterSize / sizeof(cl_device_id);
-    clGetContextInfo(context_, CL_CONTEXT_DEVICES, parameterSize, devices, NULL);
-
-    maxFlopsDevice = devices[0];
-    int maxFlops = 0;
-    size_t currentDevice = 0;
-    cl_uint computeUnits;
-    clGetDeviceInfo(devices[currentDevice], CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(computeUnits), &computeUnits, NULL);
-    cl_uint clockFrequency;
-    clGetDeviceInfo(devices[currentDevice],
-                    CL_DEVICE_MAX_CLOCK_FREQUENCY,
-                    sizeof(clockFrequency),
-                    &clockFrequency,
-                    NULL);
-    maxFlops = computeUnits * clockFrequency;
-
-    while (currentDevice < deviceCount) {
-      cl_uint computeUnits;
-      clGetDeviceInfo(devices[currentDevice], CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(computeUnits), &computeUnits, NULL);
-      cl_uint clockFrequency;
-      clGetDeviceInfo(devices[currentDevice],
-                      CL_DEVICE_MAX_CLOCK_FREQUENCY,
-                      sizeof(clockFrequency),
-                      &clockFrequency,
-                      NULL);
-      int flops = computeUnits * clockFrequency;
-      if (flops > maxFlops) {
-        maxFlops = flops;
-        maxFlopsDevice = devices[currentDevice];
-      }
-      currentDevice++;
+cl_device_id DijkstraCL::GetMaxFlopsDevice(const std::vector<cl_device_id> &devices) {
+  cl_device_id maxFlopsDevice = devices[0];
+  cl_ulong maxFlops = 0;
+  for (auto device : devices) {
+    cl_uint computeUnits = 0;
+    clGetDeviceInfo(device, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(computeUnits), &computeUnits, NULL);
+    cl_uint clockFrequency = 0;
+    clGetDeviceInfo(device, CL_DEVICE_MAX_CLOCK_FREQUENCY, sizeof(clockFrequency), &clockFrequency, NULL);
+    cl_ulong flops = static_cast<cl_ulong>(computeUnits) * clockFrequency;
+    if (flops > maxFlops) {
+      maxFlops = flops;
+      maxFlopsDevice = device;
     }
+  }
+  return maxFlopsDevice;
+}
 
-    free(devices);
-    return maxFlopsDevice;
+size_t DijkstraCL::WorkGroupSize(cl_device_id device, const std::vector<cl_kernel> &kernels) {
+  // The largest size all the kernels can run with, and the smallest preferred multiple
+  size_t limit = 0;
+  clGetDeviceInfo(device, CL_DEVICE_MAX_WORK_GROUP_SIZE, sizeof(limit), &limit, NULL);
+  size_t multiple = limit;
+  for (auto kernel : kernels) {
+    size_t kernelLimit = limit;
+    clGetKernelWorkGroupInfo(kernel, device, CL_KERNEL_WORK_GROUP_SIZE, sizeof(kernelLimit), &kernelLimit, NULL);
+    limit = std::min(limit, kernelLimit);
+    size_t kernelMultiple = 1;
+    clGetKernelWorkGroupInfo(kernel, device, CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE, sizeof(kernelMultiple),
+                             &kernelMultiple, NULL);
+    multiple = std::min(multiple, kernelMultiple);
   }
+  limit = std::max<size_t>(limit, 1);
+  multiple = std::max<size_t>(std::min(multiple, limit), 1);
+
+  if (!deviceSelection_[DIJKSTRACL_WORK_GROUP_SIZE].empty()) {
+    size_t requested = std::stoul(deviceSelection_[DIJKSTRACL_WORK_GROUP_SIZE]);
+    return std::max<size_t>(1, std::min(requested, limit));
+  }
+  if (DeviceType(device) & CL_DEVICE_TYPE_CPU) return std::min(multiple * DIJKSTRACL_CPU_WORK_GROUP_VECTORS, limit);
+  size_t size = std::min(DIJKSTRACL_GPU_WORK_GROUP_SIZE, limit);
+  return std::max(size / multiple * multiple, multiple);
 }
 
 void DijkstraCL::checkErrorFileLine(const char *file, const int lineNumber) {
@@ -154,147 +439,264 @@ void DijkstraCL::checkErrorFileLine(const char *file, const int lineNumber) {
   }
 }
 
-cl_int DijkstraCL::RunOnDevice(cl_context context, cl_device_id device) {
-  // Create command queue
-  cl_command_queue commandQueue;
-  commandQueue = clCreateCommandQueue(context, device, 0, &lastErr_); checkError();
-
-  // Load program
-  cl_program program = buildProgram(context);
-
-  // Get the maximum workgroup size
-  size_t maxWorkGroupSize;
-  clGetDeviceInfo(device, CL_DEVICE_MAX_WORK_GROUP_SIZE, sizeof(size_t), &maxWorkGroupSize, NULL); checkError();
-
-  // Set work items as 1 dimension
-  size_t localWorkSize = maxWorkGroupSize;
-  size_t globalWorkSize = RoundUpWorkSize(localWorkSize, graph_->vertices.size());
+cl_int DijkstraCL::RunOnDevice(DijkstraCLRuntime &runtime, cl_device_id device) {
+  cl_context context = runtime.context;
+  cl_command_queue commandQueue = runtime.commandQueue;
+  cl_command_queue readbackQueue = runtime.readbackQueue;
+
+  // The kernels are shared by the runs on the device; their args are set below
+  cl_kernel initializeBuffersKernel = runtime.kernels["initializeBuffers"];
+  cl_kernel ssspKernel1 = runtime.kernels["OCL_SSSP_KERNEL1"];
+  cl_kernel ssspKernel2 = runtime.kernels["OCL_SSSP_KERNEL2"];
+  cl_kernel initializeQueueKernel = runtime.kernels["initializeQueue"];
+  cl_kernel frontierKernel1 = runtime.kernels["OCL_SSSP_FRONTIER_KERNEL1"];
+  cl_kernel frontierKernel2 = runtime.kernels["OCL_SSSP_FRONTIER_KERNEL2"];
+  bool frontier = kernelSet_ == DIJKSTRACL_KERNELS_FRONTIER;
+
+  // Set work items as 2 dimensions: the vertices, with the work-group size tuned for the device, and the sources.
+  // The frontier kernels run 1 dimension over their queue.
+  size_t localWorkSize[2] = {frontier
+                             ? WorkGroupSize(device, {initializeBuffersKernel, initializeQueueKernel, frontierKernel1, frontierKernel2})
+                             : WorkGroupSize(device, {initializeBuffersKernel, ssspKernel1, ssspKernel2}), 1};
+  size_t stride = RoundUpWorkSize(localWorkSize[0], graph_->vertices.size());
+  size_t batchSize = BatchSize(device, stride);
 
   cl_mem verticesDevice;
   cl_mem edgesDevice;
   cl_mem weightsDevice;
-  cl_mem maskDevice;
-  cl_mem costDevice;
-  cl_mem updatingCostDevice;
 
   // Allocate and copy data into device
-  PrepareDeviceMemory(context, commandQueue, *graph_, &verticesDevice, &edgesDevice, &weightsDevice,
-                      &maskDevice, &costDevice, &updatingCostDevice, globalWorkSize);
+  PrepareDeviceMemory(context, commandQueue, *graph_, &verticesDevice, &edgesDevice, &weightsDevice, stride);
+
+  // Two sets of batch buffers, so that a batch is computed while the previous one is read back
+  BatchBuffers batchBuffers[2];
+  PrepareBatchMemory(context, batchSize, stride, &batchBuffers[0]);
+  PrepareBatchMemory(context, std::min(batchSize, sourceVertices_.size() - std::min(batchSize, sourceVertices_.size())),
+                     stride, &batchBuffers[1]);
 
   // Convert rvalue to local variable so that an address can be taken
   // The clSetKernelArg takes pointers even for plain type arguments
   cl_Index vertexCount = graph_->vertices.size();
   cl_Index edgeCount = graph_->edges.size();
+  cl_Index slabStride = static_cast<cl_Index>(stride);
 
-  // Create initializeBuffers Kernel and set args
-  cl_kernel initializeBuffersKernel = clCreateKernel(program, "initializeBuffers", &lastErr_); checkError();
-  lastErr_ |= clSetKernelArg(initializeBuffersKernel, 0, sizeof(cl_mem), &maskDevice);
-  lastErr_ |= clSetKernelArg(initializeBuffersKernel, 1, sizeof(cl_mem), &costDevice);
-  lastErr_ |= clSetKernelArg(initializeBuffersKernel, 2, sizeof(cl_mem), &updatingCostDevice);
-
-  // 3rd Arg is changing for each source vertex and set in the loop below
-  lastErr_ |= clSetKernelArg(initializeBuffersKernel, 4, sizeof(cl_Index), &vertexCount); checkError();
+  // The graph args are shared by all the batches, the batch buffer args are set for each batch below
+  lastErr_ |= clSetKernelArg(initializeBuffersKernel, 4, sizeof(cl_Index), &slabStride); checkError();
 
-
-  // Create SSSP Kernel 1 and set args
-  cl_kernel ssspKernel1;
-  ssspKernel1 = clCreateKernel(program, "OCL_SSSP_KERNEL1", &lastErr_); checkError();
   lastErr_ |= clSetKernelArg(ssspKernel1, 0, sizeof(cl_mem), &verticesDevice);
   lastErr_ |= clSetKernelArg(ssspKernel1, 1, sizeof(cl_mem), &edgesDevice);
   lastErr_ |= clSetKernelArg(ssspKernel1, 2, sizeof(cl_mem), &weightsDevice);
-  lastErr_ |= clSetKernelArg(ssspKernel1, 3, sizeof(cl_mem), &maskDevice);
-  lastErr_ |= clSetKernelArg(ssspKernel1, 4, sizeof(cl_mem), &costDevice);
-  lastErr_ |= clSetKernelArg(ssspKernel1, 5, sizeof(cl_mem), &updatingCostDevice);
   lastErr_ |= clSetKernelArg(ssspKernel1, 6, sizeof(cl_Index), &vertexCount);
-  lastErr_ |= clSetKernelArg(ssspKernel1, 7, sizeof(cl_Index), &edgeCount); checkError();
-
-  // Create SSSP Kernel 2 and set args
-  cl_kernel ssspKernel2;
-  ssspKernel2 = clCreateKernel(program, "OCL_SSSP_KERNEL2", &lastErr_); checkError();
-  lastErr_ |= clSetKernelArg(ssspKernel2, 0, sizeof(cl_mem), &verticesDevice);
-  lastErr_ |= clSetKernelArg(ssspKernel2, 1, sizeof(cl_mem), &edgesDevice);
-  lastErr_ |= clSetKernelArg(ssspKernel2, 2, sizeof(cl_mem), &weightsDevice);
-  lastErr_ |= clSetKernelArg(ssspKernel2, 3, sizeof(cl_mem), &maskDevice);
-  lastErr_ |= clSetKernelArg(ssspKernel2, 4, sizeof(cl_mem), &costDevice);
-  lastErr_ |= clSetKernelArg(ssspKernel2, 5, sizeof(cl_mem), &updatingCostDevice);
-  lastErr_ |= clSetKernelArg(ssspKernel2, 6, sizeof(cl_Index), &vertexCount); checkError();
-
-  cl_Index *maskHost = (cl_Index *) malloc(sizeof(cl_Index) * vertexCount);
-
-  for (cl_Index i = 0 ; i < sourceVertices_.size(); i++ ) {
-    cl_event event;
+  lastErr_ |= clSetKernelArg(ssspKernel1, 7, sizeof(cl_Index), &edgeCount);
+  lastErr_ |= clSetKernelArg(ssspKernel1, 8, sizeof(cl_Index), &slabStride); checkError();
 
-    // Set source vertex as the 3rd arg of initializeBuffer kernel
-    lastErr_ = clSetKernelArg(initializeBuffersKernel, 3, sizeof(cl_Index), &sourceVertices_[i]); checkError();
+  lastErr_ |= clSetKernelArg(ssspKernel2, 4, sizeof(cl_Index), &slabStride); checkError();
 
-    // Initialize mask array to false, C and U to infinity
-    lastErr_ = clEnqueueNDRangeKernel(commandQueue, initializeBuffersKernel, 1, NULL, &globalWorkSize, NULL,
-                                      0, NULL, &event); checkError();
-    clWaitForEvents(1, &event); // Sync
+  lastErr_ |= clSetKernelArg(initializeQueueKernel, 4, sizeof(cl_Index), &slabStride); checkError();
 
-//--- For Debug
-//    lastErr_ = clEnqueueReadBuffer(commandQueue, maskDevice, CL_FALSE, 0, sizeof(cl_Index) * vertexCount,
-//                                   maskHost, 0, NULL, &event); checkError();
-//    clWaitForEvents(1, &event);
-//    std::cout << "> " << i << "]"; for (int a = 0; a < vertexCount; ++a) std::cout << maskHost[a] << "-";
-//    std::cout << std::endl;
-//---
+  lastErr_ |= clSetKernelArg(frontierKernel1, 0, sizeof(cl_mem), &verticesDevice);
+  lastErr_ |= clSetKernelArg(frontierKernel1, 1, sizeof(cl_mem), &edgesDevice);
+  lastErr_ |= clSetKernelArg(frontierKernel1, 2, sizeof(cl_mem), &weightsDevice);
+  lastErr_ |= clSetKernelArg(frontierKernel1, 10, sizeof(cl_Index), &vertexCount);
+  lastErr_ |= clSetKernelArg(frontierKernel1, 11, sizeof(cl_Index), &edgeCount);
+  lastErr_ |= clSetKernelArg(frontierKernel1, 12, sizeof(cl_Index), &slabStride); checkError();
 
-    // Read mask array from device to host
-    lastErr_ = clEnqueueReadBuffer(commandQueue, maskDevice, CL_FALSE, 0, sizeof(cl_Index) * vertexCount,
-                                   maskHost, 0, NULL, &event); checkError();
-    lastErr_ = clWaitForEvents(1, &event); checkError(); // Sync
+  const cl_Index unchanged = 0;
+  for (size_t first = 0, batch = 0; first < sourceVertices_.size(); first += batchSize, ++batch) {
+    size_t count = std::min(batchSize, sourceVertices_.size() - first);
+    BatchBuffers &buffers = batchBuffers[batch % 2];
+    size_t globalWorkSize[2] = {stride, count};
+    cl_event event;
+    std::vector<cl_event> kernelEvents; // profiled after each read of the flag, when the kernels have finished
 
-    while(!isMaskEmpty(maskHost, vertexCount)) {
+    // The slabs are free once the readback of the batch before the previous one has finished
+    WaitForReadbacks(&buffers);
 
-      // Number of iterations before reading results to prevent stalling if data set is small; From original OpenCL Programming Guide.
-#define DIJKSTRACL_GPU_ITERATIONS_PREVENT_STALLING 1
-      for(int iteration = 0; iteration < DIJKSTRACL_GPU_ITERATIONS_PREVENT_STALLING; ++iteration) {
-        // execute the kernel
-        lastErr_ = clEnqueueNDRangeKernel(commandQueue, ssspKernel1, 1, 0, &globalWorkSize, NULL,
-                                          0, NULL, NULL); checkError();
+    lastErr_ = clEnqueueWriteBuffer(commandQueue, buffers.sources, CL_TRUE, 0, sizeof(cl_Index) * count,
+                                    &sourceVertices_[first], 0, NULL, NULL); checkError();
 
-        lastErr_ = clEnqueueNDRangeKernel(commandQueue, ssspKernel2, 1, 0, &globalWorkSize, NULL,
-                                          0, NULL, NULL); checkError();
+    lastErr_ |= clSetKernelArg(initializeBuffersKernel, 0, sizeof(cl_mem), &buffers.masks);
+    lastErr_ |= clSetKernelArg(initializeBuffersKernel, 1, sizeof(cl_mem), &buffers.costs);
+    lastErr_ |= clSetKernelArg(initializeBuffersKernel, 2, sizeof(cl_mem), &buffers.updatingCosts);
+    lastErr_ |= clSetKernelArg(initializeBuffersKernel, 3, sizeof(cl_mem), &buffers.sources); checkError();
+
+    // Initialize the masks of the sources to true, C and U to infinity elsewhere
+    lastErr_ = clEnqueueNDRangeKernel(commandQueue, initializeBuffersKernel, 2, NULL, globalWorkSize, localWorkSize,
+                                      0, NULL, &event); checkError();
+    kernelEvents.push_back(event);
+
+    if (frontier) {
+      lastErr_ |= clSetKernelArg(initializeQueueKernel, 0, sizeof(cl_mem), &buffers.masks);
+      lastErr_ |= clSetKernelArg(initializeQueueKernel, 1, sizeof(cl_mem), &buffers.sources);
+      lastErr_ |= clSetKernelArg(initializeQueueKernel, 2, sizeof(cl_mem), &buffers.queues[0]);
+      lastErr_ |= clSetKernelArg(frontierKernel1, 3, sizeof(cl_mem), &buffers.masks);
+      lastErr_ |= clSetKernelArg(frontierKernel1, 4, sizeof(cl_mem), &buffers.costs);
+      lastErr_ |= clSetKernelArg(frontierKernel1, 5, sizeof(cl_mem), &buffers.updatingCosts);
+      lastErr_ |= clSetKernelArg(frontierKernel1, 9, sizeof(cl_mem), &buffers.changed);
+      lastErr_ |= clSetKernelArg(frontierKernel2, 0, sizeof(cl_mem), &buffers.masks);
+      lastErr_ |= clSetKernelArg(frontierKernel2, 1, sizeof(cl_mem), &buffers.costs);
+      lastErr_ |= clSetKernelArg(frontierKernel2, 2, sizeof(cl_mem), &buffers.updatingCosts); checkError();
+
+      // The first queue holds the sources
+      cl_Index queueLength = static_cast<cl_Index>(count);
+      size_t queueWorkSize = RoundUpWorkSize(localWorkSize[0], count);
+      lastErr_ = clSetKernelArg(initializeQueueKernel, 3, sizeof(cl_Index), &queueLength); checkError();
+      lastErr_ = clEnqueueNDRangeKernel(commandQueue, initializeQueueKernel, 1, NULL, &queueWorkSize, localWorkSize,
+                                        0, NULL, &event); checkError();
+      kernelEvents.push_back(event);
+
+      for (size_t current = 0; queueLength > 0; current = 1 - current) {
+        lastErr_ = clEnqueueWriteBuffer(commandQueue, buffers.changed, CL_FALSE, 0, sizeof(cl_Index), &unchanged,
+                                        0, NULL, NULL); checkError();
+
+        // Relax the edges of the current queue, and queue the vertices whose cost was lowered
+        queueWorkSize = RoundUpWorkSize(localWorkSize[0], queueLength);
+        lastErr_ |= clSetKernelArg(frontierKernel1, 6, sizeof(cl_mem), &buffers.queues[current]);
+        lastErr_ |= clSetKernelArg(frontierKernel1, 7, sizeof(cl_Index), &queueLength);
+        lastErr_ |= clSetKernelArg(frontierKernel1, 8, sizeof(cl_mem), &buffers.queues[1 - current]); checkError();
+        lastErr_ = clEnqueueNDRangeKernel(commandQueue, frontierKernel1, 1, NULL, &queueWorkSize, localWorkSize,
+                                          0, NULL, &event); checkError();
+        kernelEvents.push_back(event);
+        ++counters_.iterations;
+        counters_.workItems += queueLength;
+
+        // Only the length of the next queue is read back; the blocking read also waits for the kernel
+        lastErr_ = clEnqueueReadBuffer(commandQueue, buffers.changed, CL_TRUE, 0, sizeof(cl_Index), &queueLength,
+                                       0, NULL, NULL); checkError();
+        CountKernelTime(&kernelEvents);
+        if (queueLength == 0) break;
+
+        // Commit the lowered costs of the next queue
+        queueWorkSize = RoundUpWorkSize(localWorkSize[0], queueLength);
+        lastErr_ |= clSetKernelArg(frontierKernel2, 3, sizeof(cl_mem), &buffers.queues[1 - current]);
+        lastErr_ |= clSetKernelArg(frontierKernel2, 4, sizeof(cl_Index), &queueLength); checkError();
+        lastErr_ = clEnqueueNDRangeKernel(commandQueue, frontierKernel2, 1, NULL, &queueWorkSize, localWorkSize,
+                                          0, NULL, &event); checkError();
+        kernelEvents.push_back(event);
+      }
+    } else {
+      lastErr_ |= clSetKernelArg(ssspKernel1, 3, sizeof(cl_mem), &buffers.masks);
+      lastErr_ |= clSetKernelArg(ssspKernel1, 4, sizeof(cl_mem), &buffers.costs);
+      lastErr_ |= clSetKernelArg(ssspKernel1, 5, sizeof(cl_mem), &buffers.updatingCosts);
+      lastErr_ |= clSetKernelArg(ssspKernel2, 0, sizeof(cl_mem), &buffers.masks);
+      lastErr_ |= clSetKernelArg(ssspKernel2, 1, sizeof(cl_mem), &buffers.costs);
+      lastErr_ |= clSetKernelArg(ssspKernel2, 2, sizeof(cl_mem), &buffers.updatingCosts);
+      lastErr_ |= clSetKernelArg(ssspKernel2, 3, sizeof(cl_mem), &buffers.changed); checkError();
+
+      cl_Index changed = 1;
+      while (changed) {
+        lastErr_ = clEnqueueWriteBuffer(commandQueue, buffers.changed, CL_FALSE, 0, sizeof(cl_Index), &unchanged,
+                                        0, NULL, NULL); checkError();
+
+        // Number of iterations before reading results to prevent stalling if data set is small; From original OpenCL Programming Guide.
+#define DIJKSTRACL_GPU_ITERATIONS_PREVENT_STALLING 1
+        for(int iteration = 0; iteration < DIJKSTRACL_GPU_ITERATIONS_PREVENT_STALLING; ++iteration) {
+          // execute the kernel
+          lastErr_ = clEnqueueNDRangeKernel(commandQueue, ssspKernel1, 2, NULL, globalWorkSize, localWorkSize,
+                                            0, NULL, &event); checkError();
+          kernelEvents.push_back(event);
+
+          lastErr_ = clEnqueueNDRangeKernel(commandQueue, ssspKernel2, 2, NULL, globalWorkSize, localWorkSize,
+                                            0, NULL, &event); checkError();
+          kernelEvents.push_back(event);
+          ++counters_.iterations;
+          counters_.workItems += stride * count;
+        }
+
+        // Only the flag is read back; the blocking read also waits for the kernels of the in-order queue
+        lastErr_ = clEnqueueReadBuffer(commandQueue, buffers.changed, CL_TRUE, 0, sizeof(cl_Index), &changed,
+                                       0, NULL, NULL); checkError();
+        CountKernelTime(&kernelEvents);
       }
-      lastErr_ = clEnqueueReadBuffer(commandQueue, maskDevice, CL_FALSE, 0, sizeof(cl_Index) * vertexCount,
-                                     maskHost, 0, NULL, &event); checkError();
-      clWaitForEvents(1, &event);
     }
 
-    // Get results
-    lastErr_ = clEnqueueReadBuffer(commandQueue, costDevice, CL_FALSE, 0, sizeof(cl_Scalar) * vertexCount,
-                                   &((*results_)[i * vertexCount]), 0, NULL, &event); checkError();
-    clWaitForEvents(1, &event); // Sync
+    // Get results of the batch on the readback queue, while the next batch runs on the other buffers
+    buffers.readbacks.resize(count);
+    if (sink_) {
+      buffers.hostCosts.resize(count * vertexCount);
+      buffers.first = first;
+    }
+    for (size_t b = 0; b < count; ++b) {
+      cl_Scalar *destination = sink_ ? &buffers.hostCosts[b * vertexCount] : &((*results_)[(first + b) * vertexCount]);
+      lastErr_ = clEnqueueReadBuffer(readbackQueue, buffers.costs, CL_FALSE, sizeof(cl_Scalar) * b * stride,
+                                     sizeof(cl_Scalar) * vertexCount, destination,
+                                     0, NULL, &buffers.readbacks[b]); checkError();
+    }
+    clFlush(readbackQueue);
   }
 
-  free(maskHost);
+  for (auto &buffers : batchBuffers) {
+    WaitForReadbacks(&buffers);
+    clReleaseMemObject(buffers.sources);
+    clReleaseMemObject(buffers.masks);
+    clReleaseMemObject(buffers.costs);
+    clReleaseMemObject(buffers.updatingCosts);
+    clReleaseMemObject(buffers.changed);
+    for (auto queue : buffers.queues) if (queue) clReleaseMemObject(queue);
+  }
 
   clReleaseMemObject(verticesDevice);
   clReleaseMemObject(edgesDevice);
   clReleaseMemObject(weightsDevice);
-  clReleaseMemObject(maskDevice);
-  clReleaseMemObject(costDevice);
-  clReleaseMemObject(updatingCostDevice);
-
-  clReleaseKernel(initializeBuffersKernel);
-  clReleaseKernel(ssspKernel1);
-  clReleaseKernel(ssspKernel2);
-
-  clReleaseCommandQueue(commandQueue);
-  clReleaseProgram(program);
   return lastErr_;
 }
 
-cl_program DijkstraCL::buildProgram(cl_context context) {
+cl_program DijkstraCL::buildProgram(cl_context context, cl_device_id device) {
+  // The cached binary is keyed by everything that can change the build, including the program source itself
+  std::string cachePath;
+  std::string cacheDirectory = ProcessRuntimes().programCacheDirectory;
+  if (!cacheDirectory.empty()) {
+    cl_platform_id platform;
+    clGetDeviceInfo(device, CL_DEVICE_PLATFORM, sizeof(platform), &platform, NULL);
+    std::string key = PlatformInfo(platform, CL_PLATFORM_NAME) + "\n" + DeviceInfo(device, CL_DEVICE_NAME) + "\n" +
+        DeviceInfo(device, CL_DEVICE_VERSION) + "\n" + DeviceInfo(device, CL_DRIVER_VERSION) + "\n" + programSource;
+    cachePath = cacheDirectory + "/dijkstracl_" + CacheKeyHash(key) + ".bin";
+
+    std::ifstream ifs(cachePath, std::ios::binary);
+    std::vector<unsigned char> binary((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    if (!binary.empty()) {
+      size_t size = binary.size();
+      const unsigned char *data = &binary[0];
+      cl_int status = CL_SUCCESS;
+      cl_program program = clCreateProgramWithBinary(context, 1, &device, &size, &data, &status, &lastErr_);
+      if (lastErr_ == CL_SUCCESS && status == CL_SUCCESS &&
+          (lastErr_ = clBuildProgram(program, 1, &device, NULL, NULL, NULL)) == CL_SUCCESS) {
+        LOGI("DijkstraCL program loaded from the cache " << cachePath << ".")
+        return program;
+      }
+      if (program) clReleaseProgram(program);
+      LOGW("DijkstraCL program cache " << cachePath << " is not valid for the device, the program is rebuilt.")
+    }
+  }
+
   // Create program for all devices in the context
   cl_program program = clCreateProgramWithSource(context, 1, (const char **) &programSource, NULL, &lastErr_); checkError();
   // Build program
   lastErr_ = clBuildProgram(program, 0, NULL, NULL, NULL, NULL);
   if (lastErr_ != CL_SUCCESS) {
     char buildLog[10240];
-    clGetProgramBuildInfo(program, device_, CL_PROGRAM_BUILD_LOG, sizeof(buildLog), buildLog, NULL); checkError();
+    clGetProgramBuildInfo(program, device, CL_PROGRAM_BUILD_LOG, sizeof(buildLog), buildLog, NULL); checkError();
     std::cerr << buildLog << std::endl;
+    return program;
+  }
+
+  if (!cachePath.empty()) {
+    // The context has the single device, so the program has one binary
+    size_t size = 0;
+    clGetProgramInfo(program, CL_PROGRAM_BINARY_SIZES, sizeof(size), &size, NULL);
+    std::vector<unsigned char> binary(size);
+    unsigned char *data = binary.empty() ? NULL : &binary[0];
+    if (size > 0 && clGetProgramInfo(program, CL_PROGRAM_BINARIES, sizeof(data), &data, NULL) == CL_SUCCESS) {
+      // Write a temporary file and rename it, so that a concurrent process never reads a partial binary
+      std::string temporaryPath = cachePath + ".tmp";
+      std::ofstream ofs(temporaryPath, std::ios::binary);
+      ofs.write(reinterpret_cast<const char *>(data), size);
+      ofs.close();
+      if (!ofs || std::rename(temporaryPath.c_str(), cachePath.c_str()) != 0) {
+        std::remove(temporaryPath.c_str());
+        LOGW("DijkstraCL program cannot be cached to " << cachePath << ".")
+      }
+    }
   }
   return program;
 }
@@ -311,9 +713,6 @@ void DijkstraCL::PrepareDeviceMemory(cl_context context,
                                      cl_mem *verticesDevice,
                                      cl_mem *edgesDevice,
                                      cl_mem *weightsDevice,
-                                     cl_mem *maskDevice,
-                                     cl_mem *costDevice,
-                                     cl_mem *updatingCostDevice,
                                      size_t globalWorkSize) {
   cl_mem verticesHost;
   cl_mem edgesHost;
@@ -333,9 +732,6 @@ void DijkstraCL::PrepareDeviceMemory(cl_context context,
   *verticesDevice = clCreateBuffer(context, CL_MEM_READ_ONLY, sizeof(cl_Index) * globalWorkSize, NULL, &lastErr_); checkError();
   *edgesDevice = clCreateBuffer(context, CL_MEM_READ_ONLY, sizeof(cl_Index) * graph.edges.size(), NULL, &lastErr_); checkError();
   *weightsDevice = clCreateBuffer(context, CL_MEM_READ_ONLY, sizeof(cl_Scalar) * graph.weights.size(), NULL, &lastErr_); checkError();
-  *maskDevice = clCreateBuffer(context, CL_MEM_READ_WRITE, sizeof(cl_Index) * globalWorkSize, NULL, &lastErr_); checkError();
-  *costDevice = clCreateBuffer(context, CL_MEM_READ_WRITE, sizeof(cl_Scalar) * globalWorkSize, NULL, &lastErr_); checkError();
-  *updatingCostDevice = clCreateBuffer(context, CL_MEM_READ_WRITE, sizeof(cl_Scalar) * globalWorkSize, NULL, &lastErr_); checkError();
 
   // Enqueue the data reading commands
   cl_event event;
@@ -343,14 +739,17 @@ void DijkstraCL::PrepareDeviceMemory(cl_context context,
   lastErr_ = clEnqueueCopyBuffer(commandQueue, verticesHost, *verticesDevice, 0, 0,
                                  sizeof(cl_Index) * graph.vertices.size(), 0, NULL, &event); checkError();
   clWaitForEvents(1, &event);
+  clReleaseEvent(event);
 
   lastErr_ = clEnqueueCopyBuffer(commandQueue, edgesHost, *edgesDevice, 0, 0,
                                  sizeof(cl_Index) * graph.edges.size(), 0, NULL, &event); checkError();
   clWaitForEvents(1, &event);
+  clReleaseEvent(event);
 
   lastErr_ = clEnqueueCopyBuffer(commandQueue, weightsHost, *weightsDevice, 0, 0,
                                  sizeof(cl_Scalar) * graph.weights.size(), 0, NULL, &event); checkError();
   clWaitForEvents(1, &event);
+  clReleaseEvent(event);
 
   // Release host memory objects
   clReleaseMemObject(verticesHost);
@@ -362,25 +761,79 @@ std::shared_ptr<std::vector<DijkstraCL::cl_Scalar>> DijkstraCL::GetResultsArray(
   return results_;
 }
 
-bool DijkstraCL::isMaskEmpty(DijkstraCL::cl_Index *mask, DijkstraCL::cl_Index maskSize) {
-  for(cl_Index i = 0; i < maskSize; i++ ) {
-    if (mask[i] == 1) return false;
+size_t DijkstraCL::BatchSize(cl_device_id device, size_t stride) {
+  if (batchSize_ > 0) {
+    return std::max<size_t>(1, std::min<size_t>(std::min<size_t>(batchSize_, sourceVertices_.size()),
+                                                std::numeric_limits<cl_Index>::max() / stride));
+  }
+
+  // Two sets of slabs (masks, costs, updating costs and the frontier queues) in at most half of the device memory, and no slab array
+  // larger than the maximum allocation. The slab offsets are int in the kernels.
+  cl_ulong globalMemory = 0;
+  cl_ulong maxAllocation = 0;
+  clGetDeviceInfo(device, CL_DEVICE_GLOBAL_MEM_SIZE, sizeof(globalMemory), &globalMemory, NULL);
+  clGetDeviceInfo(device, CL_DEVICE_MAX_MEM_ALLOC_SIZE, sizeof(maxAllocation), &maxAllocation, NULL);
+  cl_ulong slabBytes = stride * (sizeof(cl_Index) + 2 * sizeof(cl_Scalar));
+  if (kernelSet_ == DIJKSTRACL_KERNELS_FRONTIER) slabBytes += stride * 2 * sizeof(cl_Index);
+  cl_ulong batchSize = std::min<cl_ulong>(globalMemory / 2 / (2 * slabBytes), maxAllocation / (stride * sizeof(cl_Scalar)));
+  batchSize = std::min<cl_ulong>(batchSize, std::numeric_limits<cl_Index>::max() / stride);
+  batchSize = std::min<cl_ulong>(batchSize, std::min<size_t>(DIJKSTRACL_MAX_BATCH_SIZE, sourceVertices_.size()));
+  return std::max<size_t>(1, static_cast<size_t>(batchSize));
+}
+
+void DijkstraCL::PrepareBatchMemory(cl_context context, size_t batchSize, size_t stride, BatchBuffers *buffers) {
+  // An unused second set still gets buffers, so that all the sets are released alike
+  batchSize = std::max<size_t>(batchSize, 1);
+  buffers->sources = clCreateBuffer(context, CL_MEM_READ_ONLY, sizeof(cl_Index) * batchSize, NULL, &lastErr_); checkError();
+  buffers->masks = clCreateBuffer(context, CL_MEM_READ_WRITE, sizeof(cl_Index) * batchSize * stride, NULL, &lastErr_); checkError();
+  buffers->costs = clCreateBuffer(context, CL_MEM_READ_WRITE, sizeof(cl_Scalar) * batchSize * stride, NULL, &lastErr_); checkError();
+  buffers->updatingCosts = clCreateBuffer(context, CL_MEM_READ_WRITE, sizeof(cl_Scalar) * batchSize * stride, NULL, &lastErr_); checkError();
+  buffers->changed = clCreateBuffer(context, CL_MEM_READ_WRITE, sizeof(cl_Index), NULL, &lastErr_); checkError();
+  buffers->queues[0] = buffers->queues[1] = NULL;
+  if (kernelSet_ == DIJKSTRACL_KERNELS_FRONTIER) {
+    // Each vertex of the batch is queued at most once per iteration
+    for (auto &queue : buffers->queues) {
+      queue = clCreateBuffer(context, CL_MEM_READ_WRITE, sizeof(cl_Index) * batchSize * stride, NULL, &lastErr_); checkError();
+    }
+  }
+}
+
+void DijkstraCL::CountKernelTime(std::vector<cl_event> *events) {
+  if (events->empty()) return;
+  clWaitForEvents(static_cast<cl_uint>(events->size()), &(*events)[0]);
+  for (auto event : *events) {
+    cl_ulong start = 0;
+    cl_ulong end = 0;
+    clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START, sizeof(start), &start, NULL);
+    clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_END, sizeof(end), &end, NULL);
+    counters_.kernelSeconds += (end - start) * 1e-9;
+    clReleaseEvent(event);
+  }
+  events->clear();
+}
+
+void DijkstraCL::WaitForReadbacks(BatchBuffers *buffers) {
+  if (buffers->readbacks.empty()) return;
+  lastErr_ = clWaitForEvents(static_cast<cl_uint>(buffers->readbacks.size()), &buffers->readbacks[0]); checkError();
+  for (auto event : buffers->readbacks) clReleaseEvent(event);
+
+  if (sink_) {
+    std::vector<Scalar> row(numVertices_);
+    for (size_t b = 0; b < buffers->readbacks.size(); ++b) {
+      const cl_Scalar *costs = &buffers->hostCosts[b * numVertices_];
+      for (Index c = 0; c < numVertices_; ++c) row[c] = ScalarDistance(costs[c]);
+      (*sink_)(buffers->first + b, row.data());
+    }
   }
-  return true;
+  buffers->readbacks.clear();
 }
 
 std::shared_ptr<gsl::Matrix> DijkstraCL::GetDistanceMatrix() {
+  if (!results_) return nullptr;
   std::shared_ptr<gsl::Matrix> result(new gsl::Matrix(sourceVertices_.size(), static_cast<Index>(numVertices_)));
   for (Index r = 0; r < sourceVertices_.size(); ++r) {
     for (Index c = 0; c < numVertices_; ++c) {
-      Scalar val = static_cast<Scalar>((*results_)[r * numVertices_ + c]);
-      // Note that the float max value is directly converted to double max value for convenience.
-      // This is assuming the client code is aware of possible imprecision:
-      // e.g., if client code use double as Scalar, and OpenCL device only supports float as cl_Scalar,
-      // then cl_Scalar overflow doesn't mean a Scalar overflow.
-      // However, this is ok for almost all applications since the "overflow" here just means no connection.
-      if (val == std::numeric_limits<cl_Scalar>::max()) val = std::numeric_limits<Scalar>::max();
-      (*result)(r, c) = val;
+      (*result)(r, c) = ScalarDistance((*results_)[r * numVertices_ + c]);
     }
   }
   return result;
@@ -0,0 +1,194 @@
+//
+// Created on 10/19/26.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <hsisomap/graph/dijkstra/DijkstraCPU.h>
+#include <hsisomap/util/Parallel.h>
+#include <hsisomap/util/RadixHeap.h>
+
+namespace Dijkstra {
+
+DijkstraCPU::DijkstraCPU(std::shared_ptr<GraphUtils::AdjacencyList> adjList, Index threads)
+    : graph_(adjList->GetGraphArray<Index, Scalar>()),
+      numVertices_(graph_->vertices.size()),
+      threads_(threads),
+      queue_(DIJKSTRACPU_QUEUE_BINARY_HEAP),
+      scale_(1),
+      relativeErrorBound_(0),
+      sourceVertices_(graph_->vertices.size(), 0) {
+  std::iota(sourceVertices_.begin(), sourceVertices_.end(), 0);
+}
+
+DijkstraCPU::DijkstraCPU(std::shared_ptr<GraphUtils::CSRGraph> csrGraph, Index threads)
+    : graph_(csrGraph->GetGraphArray<Index, Scalar>()),
+      numVertices_(graph_->vertices.size()),
+      threads_(threads),
+      queue_(DIJKSTRACPU_QUEUE_BINARY_HEAP),
+      scale_(1),
+      relativeErrorBound_(0),
+      sourceVertices_(graph_->vertices.size(), 0) {
+  std::iota(sourceVertices_.begin(), sourceVertices_.end(), 0);
+}
+
+void DijkstraCPU::SetSourceVertices(std::vector<Index> sourceVertices) {
+  sourceVertices_.resize(sourceVertices.size());
+  std::copy(sourceVertices.begin(), sourceVertices.end(), sourceVertices_.begin());
+}
+
+void DijkstraCPU::SetQueue(DijkstraCPUQueue queue) {
+  queue_ = queue;
+  quantizedWeights_.clear();
+  scale_ = 1;
+  relativeErrorBound_ = 0;
+  if (queue_ != DIJKSTRACPU_QUEUE_RADIX_HEAP) return;
+
+  const std::vector<Scalar> &weights = graph_->weights;
+  Scalar maxWeight = 0;
+  Scalar minPositiveWeight = std::numeric_limits<Scalar>::max();
+  for (Scalar weight : weights) {
+    maxWeight = std::max(maxWeight, weight);
+    if (weight > 0) minPositiveWeight = std::min(minPositiveWeight, weight);
+  }
+
+  // The largest weight becomes 2^32 - 1, so that a path of up to 2^32 edges sums within 64 bits
+  if (maxWeight > 0) scale_ = static_cast<Scalar>(std::numeric_limits<std::uint32_t>::max()) / maxWeight;
+  quantizedWeights_.resize(weights.size());
+  for (Index edge = 0; edge < weights.size(); ++edge) {
+    quantizedWeights_[edge] = static_cast<std::uint64_t>(std::llround(weights[edge] * scale_));
+  }
+  if (maxWeight > 0) relativeErrorBound_ = 0.5 / (scale_ * minPositiveWeight);
+}
+
+Scalar DijkstraCPU::relativeErrorBound() const {
+  return relativeErrorBound_;
+}
+
+int DijkstraCPU::Run() {
+  auto distanceMatrix = std::make_shared<gsl::Matrix>(sourceVertices_.size(), numVertices_);
+  if (queue_ == DIJKSTRACPU_QUEUE_RADIX_HEAP) {
+    RunRadixHeap(distanceMatrix.get(), DistanceRowSink());
+  } else {
+    RunBinaryHeap(distanceMatrix.get(), DistanceRowSink());
+  }
+  distanceMatrix_ = distanceMatrix;
+  return 0;
+}
+
+int DijkstraCPU::Run(const DistanceRowSink &sink) {
+  distanceMatrix_.reset();
+  if (queue_ == DIJKSTRACPU_QUEUE_RADIX_HEAP) {
+    RunRadixHeap(nullptr, sink);
+  } else {
+    RunBinaryHeap(nullptr, sink);
+  }
+  return 0;
+}
+
+void DijkstraCPU::RunBinaryHeap(gsl::Matrix *distanceMatrix, const DistanceRowSink &sink) {
+  const std::vector<Index> &vertices = graph_->vertices;
+  const std::vector<Index> &edges = graph_->edges;
+  const std::vector<Scalar> &weights = graph_->weights;
+
+  // Lazy deletion: a vertex is pushed again when its distance improves, and the stale entries are skipped when
+  // popped. The heap is a flat array of (distance, vertex) pairs. The tentative distances of a source are its row of
+  // the distance matrix, or else a row kept by the thread between its sources.
+  typedef std::pair<Scalar, Index> HeapEntry;
+  Index threads = std::min(hsisomap::ParallelThreadCount(threads_), std::max<Index>(1, sourceVertices_.size()));
+  std::vector<std::vector<HeapEntry>> heaps(threads);
+  std::vector<std::vector<Scalar>> rows(distanceMatrix ? 0 : threads);
+
+  hsisomap::ParallelFor(0, sourceVertices_.size(), [&](Index i, Index thread) {
+    Scalar *distances;
+    if (distanceMatrix) {
+      distances = distanceMatrix->m_->data + i * distanceMatrix->m_->tda;
+    } else {
+      rows[thread].resize(numVertices_);
+      distances = rows[thread].data();
+    }
+    std::fill(distances, distances + numVertices_, std::numeric_limits<Scalar>::max());
+    std::vector<HeapEntry> &heap = heaps[thread];
+    heap.clear();
+
+    distances[sourceVertices_[i]] = 0;
+    heap.push_back(HeapEntry(0, sourceVertices_[i]));
+    while (!heap.empty()) {
+      std::pop_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+      Scalar distance = heap.back().first;
+      Index vertex = heap.back().second;
+      heap.pop_back();
+      if (distance > distances[vertex]) continue;
+
+      Index edge_end = vertex + 1 < numVertices_ ? vertices[vertex + 1] : edges.size();
+      for (Index edge = vertices[vertex]; edge < edge_end; ++edge) {
+        Scalar candidate = distance + weights[edge];
+        if (candidate < distances[edges[edge]]) {
+          distances[edges[edge]] = candidate;
+          heap.push_back(HeapEntry(candidate, edges[edge]));
+          std::push_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+        }
+      }
+    }
+    if (!distanceMatrix) sink(i, distances);
+  }, threads, 1);
+}
+
+void DijkstraCPU::RunRadixHeap(gsl::Matrix *distanceMatrix, const DistanceRowSink &sink) {
+  const std::vector<Index> &vertices = graph_->vertices;
+  const std::vector<Index> &edges = graph_->edges;
+
+  // As with the binary heap, a vertex is pushed again when its distance improves, and the stale entries are
+  // skipped. Each thread keeps its heap and its integer distances between its sources, and the converted distances
+  // go to the row of the distance matrix, or else to a row of the thread.
+  const std::uint64_t unreachable = std::numeric_limits<std::uint64_t>::max();
+  Index threads = std::min(hsisomap::ParallelThreadCount(threads_), std::max<Index>(1, sourceVertices_.size()));
+  std::vector<hsisomap::RadixHeap<Index>> heaps(threads);
+  std::vector<std::vector<std::uint64_t>> threadDistances(threads);
+  std::vector<std::vector<Scalar>> rows(distanceMatrix ? 0 : threads);
+
+  hsisomap::ParallelFor(0, sourceVertices_.size(), [&](Index i, Index thread) {
+    std::vector<std::uint64_t> &distances = threadDistances[thread];
+    distances.assign(numVertices_, unreachable);
+    hsisomap::RadixHeap<Index> &heap = heaps[thread];
+    heap.clear();
+
+    distances[sourceVertices_[i]] = 0;
+    heap.push(0, sourceVertices_[i]);
+    while (!heap.empty()) {
+      auto entry = heap.pop();
+      Index vertex = entry.second;
+      if (entry.first > distances[vertex]) continue;
+
+      Index edge_end = vertex + 1 < numVertices_ ? vertices[vertex + 1] : edges.size();
+      for (Index edge = vertices[vertex]; edge < edge_end; ++edge) {
+        std::uint64_t candidate = entry.first + quantizedWeights_[edge];
+        if (candidate < distances[edges[edge]]) {
+          distances[edges[edge]] = candidate;
+          heap.push(candidate, edges[edge]);
+        }
+      }
+    }
+
+    Scalar *row;
+    if (distanceMatrix) {
+      row = distanceMatrix->m_->data + i * distanceMatrix->m_->tda;
+    } else {
+      rows[thread].resize(numVertices_);
+      row = rows[thread].data();
+    }
+    for (Index vertex = 0; vertex < numVertices_; ++vertex) {
+      row[vertex] = distances[vertex] == unreachable ? std::numeric_limits<Scalar>::max() : distances[vertex] / scale_;
+    }
+    if (!distanceMatrix) sink(i, row);
+  }, threads, 1);
+}
+
+std::shared_ptr<gsl::Matrix> DijkstraCPU::GetDistanceMatrix() {
+  return distanceMatrix_;
+}
+
+}
@@ -0,0 +1,164 @@
+//
+// Created on 10/19/26.
+//
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <hsisomap/graph/dijkstra/LaneBellmanFord.h>
+#include <hsisomap/util/Parallel.h>
+#include <hsisomap/util/RadixHeap.h>
+
+namespace Dijkstra {
+
+LaneBellmanFord::LaneBellmanFord(std::shared_ptr<GraphUtils::AdjacencyList> adjList, Index threads, Index lanes)
+    : graph_(adjList->GetGraphArray<Index, Scalar>()),
+      numVertices_(graph_->vertices.size()),
+      threads_(threads),
+      sourceVertices_(graph_->vertices.size(), 0) {
+  std::iota(sourceVertices_.begin(), sourceVertices_.end(), 0);
+  SetLanes(lanes);
+  SetDelta(0);
+}
+
+LaneBellmanFord::LaneBellmanFord(std::shared_ptr<GraphUtils::CSRGraph> csrGraph, Index threads, Index lanes)
+    : graph_(csrGraph->GetGraphArray<Index, Scalar>()),
+      numVertices_(graph_->vertices.size()),
+      threads_(threads),
+      sourceVertices_(graph_->vertices.size(), 0) {
+  std::iota(sourceVertices_.begin(), sourceVertices_.end(), 0);
+  SetLanes(lanes);
+  SetDelta(0);
+}
+
+void LaneBellmanFord::SetLanes(Index lanes) {
+  if (lanes != 8 && lanes != 16) throw std::invalid_argument("LaneBellmanFord lanes must be 8 or 16.");
+  lanes_ = lanes;
+}
+
+Index LaneBellmanFord::lanes() const {
+  return lanes_;
+}
+
+void LaneBellmanFord::SetDelta(Scalar delta) {
+  if (delta <= 0) {
+    std::vector<Scalar> sorted(graph_->weights);
+    if (!sorted.empty()) std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2, sorted.end());
+    delta = sorted.empty() ? 0 : LANEBELLMANFORD_AUTO_DELTA_MEDIAN_SCALE * sorted[sorted.size() / 2];
+    // Mostly zero weights, or no edges at all: any positive rounding orders the distances.
+    if (delta <= 0) delta = 1;
+  }
+  delta_ = delta;
+}
+
+Scalar LaneBellmanFord::delta() const {
+  return delta_;
+}
+
+void LaneBellmanFord::SetSourceVertices(std::vector<Index> sourceVertices) {
+  sourceVertices_.resize(sourceVertices.size());
+  std::copy(sourceVertices.begin(), sourceVertices.end(), sourceVertices_.begin());
+}
+
+int LaneBellmanFord::Run() {
+  auto distanceMatrix = std::make_shared<gsl::Matrix>(sourceVertices_.size(), numVertices_);
+  Run(MatrixRowSink(*distanceMatrix));
+  distanceMatrix_ = distanceMatrix;
+  return 0;
+}
+
+int LaneBellmanFord::Run(const DistanceRowSink &sink) {
+  distanceMatrix_.reset();
+  for (Index source : sourceVertices_) {
+    if (source >= numVertices_) throw std::invalid_argument("LaneBellmanFord source vertex out of range.");
+  }
+  if (lanes_ == 16) {
+    RunLanes<16>(sink);
+  } else {
+    RunLanes<8>(sink);
+  }
+  return 0;
+}
+
+template<Index T_Lanes>
+void LaneBellmanFord::RunLanes(const DistanceRowSink &sink) {
+  const std::vector<Index> &vertices = graph_->vertices;
+  const std::vector<Index> &edges = graph_->edges;
+  const std::vector<Scalar> &weights = graph_->weights;
+
+  const Scalar unreachable = std::numeric_limits<Scalar>::max();
+  const std::uint64_t inactive = std::numeric_limits<std::uint64_t>::max();
+  Index batches = (sourceVertices_.size() + T_Lanes - 1) / T_Lanes;
+  Index threads = std::min(hsisomap::ParallelThreadCount(threads_), std::max<Index>(1, batches));
+  // Each thread keeps its lanes of distances, the heap key of its active vertices, and its heap between batches.
+  std::vector<std::vector<Scalar>> threadDistances(threads);
+  std::vector<std::vector<std::uint64_t>> threadKeys(threads);
+  std::vector<hsisomap::RadixHeap<Index>> heaps(threads);
+  std::vector<std::vector<Scalar>> rows(threads);
+
+  hsisomap::ParallelFor(0, batches, [&](Index batch, Index thread) {
+    Index first = batch * T_Lanes;
+    Index count = std::min<Index>(T_Lanes, sourceVertices_.size() - first);
+    std::vector<Scalar> &distances = threadDistances[thread];
+    distances.assign(numVertices_ * T_Lanes, unreachable);
+    std::vector<std::uint64_t> &keys = threadKeys[thread];
+    keys.assign(numVertices_, inactive);
+    hsisomap::RadixHeap<Index> &heap = heaps[thread];
+    heap.clear();
+
+    // The lanes past the last source of the batch stay unreachable and never improve
+    for (Index lane = 0; lane < count; ++lane) {
+      Index source = sourceVertices_[first + lane];
+      distances[source * T_Lanes + lane] = 0;
+      if (keys[source] == inactive) heap.push(0, source);
+      keys[source] = 0;
+    }
+
+    while (!heap.empty()) {
+      auto entry = heap.pop();
+      Index vertex = entry.second;
+      // A stale entry: the vertex was pushed again with a lower key, or already relaxed
+      if (entry.first != keys[vertex]) continue;
+      keys[vertex] = inactive;
+
+      const Scalar *from = &distances[vertex * T_Lanes];
+      Index edge_end = vertex + 1 < numVertices_ ? vertices[vertex + 1] : edges.size();
+      for (Index edge = vertices[vertex]; edge < edge_end; ++edge) {
+        Index neighbor = edges[edge];
+        Scalar weight = weights[edge];
+        Scalar *to = &distances[neighbor * T_Lanes];
+        // Min-plus over the lanes, then the lowest distance that improved. The two loops vectorize separately.
+        Scalar improved[T_Lanes];
+        for (Index lane = 0; lane < T_Lanes; ++lane) {
+          Scalar candidate = from[lane] + weight;
+          improved[lane] = candidate < to[lane] ? candidate : unreachable;
+          to[lane] = std::min(to[lane], candidate);
+        }
+        Scalar lowest = unreachable;
+        for (Index lane = 0; lane < T_Lanes; ++lane) lowest = std::min(lowest, improved[lane]);
+        if (lowest == unreachable) continue;
+
+        std::uint64_t key = std::max(entry.first, static_cast<std::uint64_t>(lowest / delta_));
+        if (key < keys[neighbor]) {
+          keys[neighbor] = key;
+          heap.push(key, neighbor);
+        }
+      }
+    }
+
+    std::vector<Scalar> &row = rows[thread];
+    row.resize(numVertices_);
+    for (Index lane = 0; lane < count; ++lane) {
+      for (Index v = 0; v < numVertices_; ++v) row[v] = distances[v * T_Lanes + lane];
+      sink(first + lane, row.data());
+    }
+  }, threads, 1);
+}
+
+std::shared_ptr<gsl::Matrix> LaneBellmanFord::GetDistanceMatrix() {
+  return distanceMatrix_;
+}
+
+}
@@ -3,8 +3,11 @@
 //
 
 #include <hsisomap/graph/knngraph/KNNGraph.h>
+#include <hsisomap/graph/knngraph/KNNGraph_FixedK.h>
 #include <hsisomap/graph/knngraph/KNNGraph_FixedK_MST.h>
 #include <hsisomap/graph/knngraph/KNNGraph_AdaptiveK_HIDENN.h>
+#include <hsisomap/graph/knngraph/KNNGraph_NNDescent.h>
+#include <hsisomap/graph/knngraph/KNNGraph_Epsilon.h>
 
 HSISOMAP_NAMESPACE_BEGIN
 
@@ -14,11 +17,15 @@ std::shared_ptr<KNNGraph> KNNGraphWithImplementation(KNNGraphImplementation knng
 
   switch (knngraph_implementation) {
     case KNNGRAPH_IMPLEMENTATION_FIXED_K:
-      throw std::invalid_argument("Subsetter Implementation RandomSkel not supported yet.");
+      return std::dynamic_pointer_cast<KNNGraph>(std::make_shared<KNNGraph_FixedK>(data, property_list));
     case KNNGRAPH_IMPLEMENTATION_FIXED_K_WITH_MST:
       return std::dynamic_pointer_cast<KNNGraph>(std::make_shared<KNNGraph_FixedK_MST>(data, property_list));
     case KNNGRAPH_IMPLEMENTATION_ADAPTIVE_K_HIDENN:
       return std::dynamic_pointer_cast<KNNGraph>(std::make_shared<KNNGraph_AdaptiveK_HIDENN>(data, property_list));
+    case KNNGRAPH_IMPLEMENTATION_NN_DESCENT:
+      return std::dynamic_pointer_cast<KNNGraph>(std::make_shared<KNNGraph_NNDescent>(data, property_list));
+    case KNNGRAPH_IMPLEMENTATION_EPSILON:
+      return std::dynamic_pointer_cast<KNNGraph>(std::make_shared<KNNGraph_Epsilon>(data, property_list));
   }
 }
 
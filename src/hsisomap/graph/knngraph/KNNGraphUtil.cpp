@@ -0,0 +1,100 @@
+//
+// Created on 10/19/26.
+//
+
+#include <hsisomap/graph/knngraph/KNNGraphUtil.h>
+#include <hsisomap/graph/AdjacencyList.h>
+#include <hsisomap/graph/BoostAdjacencyList.h>
+#include <hsisomap/graph/BoostCSRGraph.h>
+#include <hsisomap/graph/CSRGraph.h>
+#include <hsisomap/Logger.h>
+#include <hsisomap/util/BallTree.h>
+#include <hsisomap/util/Parallel.h>
+#include <numeric>
+#include <unordered_map>
+
+HSISOMAP_NAMESPACE_BEGIN
+
+std::shared_ptr<GraphUtils::UndirectedWeightedGraph> CreateKNNGraphBackend(PropertyList &property_list, Index vertices) {
+  if (property_list[KNNGRAPH_GRAPH_BACKEND] == KNNGRAPH_GRAPH_BACKEND_ADJACENCYLIST) {
+    return std::make_shared<GraphUtils::AdjacencyList>(vertices);
+  } else if (property_list[KNNGRAPH_GRAPH_BACKEND] == KNNGRAPH_GRAPH_BACKEND_BOOST) {
+    return std::make_shared<GraphUtils::BoostAdjacencyList>(vertices);
+  } else if (property_list[KNNGRAPH_GRAPH_BACKEND] == KNNGRAPH_GRAPH_BACKEND_CSR) {
+    return std::make_shared<GraphUtils::CSRGraph>(vertices);
+  } else if (property_list[KNNGRAPH_GRAPH_BACKEND] == KNNGRAPH_GRAPH_BACKEND_BOOST_CSR) {
+    return std::make_shared<GraphUtils::BoostCSRGraph>(vertices);
+  } else {
+    throw std::invalid_argument("Invalid KNNGRAPH_GRAPH_BACKEND value.");
+  }
+}
+
+Index AugmentMST(GraphUtils::UndirectedWeightedGraph &graph, UnionFind &uf, std::vector<UndirectedEdge> &unused_edges) {
+  LOGI("Start augmenting MST.")
+
+  std::sort(std::begin(unused_edges), std::end(unused_edges), [](const UndirectedEdge &a, const UndirectedEdge &b) {
+    return a.weight < b.weight;
+  });
+
+  Index augment_count = 0;
+  for (const auto &edge : unused_edges) {
+    Index old_count = uf.count();
+    uf.Connect(edge.index_a, edge.index_b);
+    if (uf.count() < old_count) {
+      graph.Connect(edge.index_a, edge.index_b, edge.weight);
+      augment_count++;
+    }
+    if (uf.count() == 1) break;
+  }
+
+  LOGI(augment_count << " edges augmented.")
+  return augment_count;
+}
+
+Index AugmentBoruvka(GraphUtils::UndirectedWeightedGraph &graph, ConcurrentUnionFind &uf, const gsl::Matrix &data,
+                     Index threads) {
+  if (uf.count() <= 1) return 0;
+  LOGI("Start augmenting MST with Boruvka rounds from " << uf.count() << " connected parts.")
+
+  BallTree tree(data.m_);
+  std::vector<Index> labels(data.rows());
+  Index augment_count = 0;
+
+  while (uf.count() > 1) {
+    ParallelFor(0, data.rows(), [&](Index i, Index) { labels[i] = uf.Find(i); }, threads);
+    std::unordered_map<Index, Index> component_of_root;
+    std::vector<std::vector<Index>> members;
+    for (Index i = 0; i < data.rows(); ++i) {
+      auto inserted = component_of_root.insert(std::make_pair(labels[i], members.size()));
+      if (inserted.second) members.push_back(std::vector<Index>());
+      members[inserted.first->second].push_back(i);
+    }
+
+    // The largest part needs no search of its own: every other part is joined to another part, so the P parts
+    // merge into at most (P - 1) / 2 + 1 (rounded down) parts per round.
+    Index largest = 0;
+    for (Index c = 1; c < members.size(); ++c) {
+      if (members[c].size() > members[largest].size()) largest = c;
+    }
+    members[largest].clear();
+
+    std::vector<std::pair<Index, Index>> edges;
+    std::vector<Scalar> distance_squares;
+    ComponentNearestNeighbors(tree, labels, members, &edges, &distance_squares, threads);
+
+    // Two parts may pick the same edge, or edges of equal length that close a cycle.
+    std::vector<Index> order(edges.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](Index a, Index b) { return distance_squares[a] < distance_squares[b]; });
+    for (auto c : order) {
+      if (c == largest || !uf.Connect(edges[c].first, edges[c].second)) continue;
+      graph.Connect(edges[c].first, edges[c].second, std::sqrt(distance_squares[c]));
+      augment_count++;
+    }
+  }
+
+  LOGI(augment_count << " edges augmented.")
+  return augment_count;
+}
+
+HSISOMAP_NAMESPACE_END
@@ -4,11 +4,11 @@
 
 
 #include <hsisomap/graph/knngraph/KNNGraph_AdaptiveK_HIDENN.h>
-#include <hsisomap/graph/AdjacencyList.h>
-#include <hsisomap/graph/BoostAdjacencyList.h>
+#include <hsisomap/graph/knngraph/KNNGraph_AdaptiveK_HIDENN_detail.h>
+#include <hsisomap/graph/knngraph/KNNGraphUtil.h>
 #include <hsisomap/Logger.h>
-#include <hsisomap/util/VpTree.h>
-#include <hsisomap/util/UnionFind.h>
+#include <hsisomap/knnsearch/KNNSearch.h>
+#include <hsisomap/util/Parallel.h>
 
 #include <hsisomap/subsetter/Subsetter.h>
 #include <hsisomap/gsl_util/matrix_util.h>
@@ -19,17 +19,95 @@
 
 HSISOMAP_NAMESPACE_BEGIN
 
-struct UndirectedEdge {
-  Index index_b;
-  Index index_a;
-  Scalar weight;
-  UndirectedEdge(Index index_a, Index index_b, Scalar weight) : index_a(index_a), index_b(index_b), weight(weight) { }
-};
+namespace hidenn_detail {
+
+// The neighbor lists of the points of each sample are sorted once up to MAX_K, from one row of brute-force distances
+// at a time. An undirected edge belongs to the kNN graphs of all k from the smaller of its two ranks on, so the graph
+// lengths of all k are prefix sums of the edge lengths binned by that rank.
+std::vector<Scalar> GraphLengthSlopes(const gsl::Matrix &data, const std::vector<Index> &rows, std::mt19937 &rng) {
+  std::vector<Scalar> slopes(MAX_K + 1, 0);
+  kIndex max_samples = std::min(MAX_SAMPLES, static_cast<Index>(rows.size()));
+  if (max_samples <= MIN_SAMPLES) return slopes;
+
+  kIndex D = data.cols();
+  std::vector<Index> sample(rows);
+  std::vector<Scalar> log_samples;
+  std::vector<std::vector<Scalar>> log_lengths(MAX_K + 1);
+  std::vector<Scalar> row_distances;
+  std::vector<Index> neighbors;
+  std::vector<Scalar> neighbor_distances;
+  std::vector<Index> order;
+
+  for (Index N = MIN_SAMPLES; N <= max_samples; ++N) {
+    // Partial Fisher-Yates shuffle: the first N rows are a uniform sample.
+    for (Index i = 0; i < N; ++i) {
+      std::uniform_int_distribution<Index> pick(i, sample.size() - 1);
+      std::swap(sample[i], sample[pick(rng)]);
+    }
+
+    kIndex K = std::min(MAX_K, N - 1);
+    neighbors.resize(N * K);
+    neighbor_distances.resize(N * K);
+    row_distances.resize(N);
+    for (Index a = 0; a < N; ++a) {
+      const Scalar *x = data.m_->data + sample[a] * data.m_->tda;
+      for (Index b = 0; b < N; ++b) {
+        const Scalar *y = data.m_->data + sample[b] * data.m_->tda;
+        Scalar distance = 0;
+        for (Index d = 0; d < D; ++d) distance += (x[d] - y[d]) * (x[d] - y[d]);
+        row_distances[b] = std::sqrt(distance);
+      }
+      order.clear();
+      for (Index b = 0; b < N; ++b) if (b != a) order.push_back(b);
+      std::partial_sort(order.begin(), order.begin() + K, order.end(), [&](Index u, Index v) {
+        return row_distances[u] < row_distances[v] || (row_distances[u] == row_distances[v] && u < v);
+      });
+      for (Index j = 0; j < K; ++j) {
+        neighbors[a * K + j] = order[j];
+        neighbor_distances[a * K + j] = row_distances[order[j]];
+      }
+    }
+
+    // Each edge is counted once, from the end point where its rank is smaller.
+    std::vector<Scalar> length_of_rank(MAX_K + 1, 0);
+    for (Index a = 0; a < N; ++a) {
+      for (Index j = 0; j < K; ++j) {
+        Index b = neighbors[a * K + j];
+        Index rank_in_b = K;
+        for (Index i = 0; i < K; ++i) {
+          if (neighbors[b * K + i] == a) {
+            rank_in_b = i;
+            break;
+          }
+        }
+        if (rank_in_b < j || (rank_in_b == j && b < a)) continue;
+        length_of_rank[j + 1] += neighbor_distances[a * K + j];
+      }
+    }
+
+    log_samples.push_back(log(static_cast<Scalar>(N)));
+    Scalar length = 0;
+    for (Index k = 1; k <= MAX_K; ++k) {
+      length += length_of_rank[k];
+      if (k >= MIN_K) log_lengths[k].push_back(log(length * 2));
+    }
+  }
+
+  for (Index k = MIN_K; k <= MAX_K; ++k) {
+    double c0, c1, cov00, cov01, cov11, sumsq;
+    gsl_fit_linear(log_samples.data(), 1, log_lengths[k].data(), 1, log_samples.size(), &c0, &c1, &cov00, &cov01, &cov11, &sumsq);
+    slopes[k] = c1;
+  }
+  return slopes;
+}
 
+}
 
 KNNGraph_AdaptiveK_HIDENN::KNNGraph_AdaptiveK_HIDENN(std::shared_ptr<gsl::Matrix> data, PropertyList property_list)
     : data_(data), property_list_(property_list) {
 
+  if (property_list_.find(KNN_BACKEND) == property_list_.end()) property_list_[KNN_BACKEND] = KNNGraphDefaultBackend();
+
   LOGI("Subsetting.")
 //  std::shared_ptr<Subsetter> subsetter = SubsetterWithImplementation(SUBSETTER_IMPLEMENTATION_RANDOMSKEL,
 //                                                                     data_,
@@ -67,76 +145,35 @@ KNNGraph_AdaptiveK_HIDENN::KNNGraph_AdaptiveK_HIDENN(std::shared_ptr<gsl::Matrix
 
   std::vector<Index> optim_ks(subset_indexes.size(), 0);
 
+  // Each subset has its own random stream, so the estimates do not depend on the thread schedule.
+  kIndex SEED = property_list_[KNNGRAPH_ADAPTIVE_K_HIDENN_SEED] == 0.0 ? std::random_device()()
+                                                                      : static_cast<Index>(property_list_[KNNGRAPH_ADAPTIVE_K_HIDENN_SEED]);
+  LOGI("Estimating kNN graph length slopes of " << subset_indexes.size() << " subsets.")
+  std::vector<std::vector<Scalar>> slopes_of_subsets(subset_indexes.size());
+  ParallelFor(0, subset_indexes.size(), [&](Index subset, Index) {
+    std::seed_seq seeds{static_cast<std::uint32_t>(SEED), static_cast<std::uint32_t>(static_cast<std::uint64_t>(SEED) >> 32),
+                        static_cast<std::uint32_t>(subset)};
+    std::mt19937 rng(seeds);
+    slopes_of_subsets[subset] = hidenn_detail::GraphLengthSlopes(*data_, subset_indexes[subset], rng);
+  }, static_cast<Index>(property_list_[PARALLEL_THREADS]), 1);
+
   Index s = 0;
   for (auto indexes_in_subset : subset_indexes) {
     auto subset_data = gsl::GetRows(data_, indexes_in_subset);
-    VpTree<PixelView, SquaredDistance> vptree;
-    auto pixel_views = CreatePixelViewsFromMatrix(*subset_data);
-    vptree.create(pixel_views);
+    // The subset rows are not in image order, so the image geometry does not apply to them.
+    PropertyList subset_property_list = property_list_;
+    subset_property_list[KNN_IMAGE_SAMPLES] = 0.0;
+    auto subset_table = KNNSearchWithBackend(*subset_data, subset_property_list)->SearchReference(0, subset_data->rows(), K1 + 1);
 
     Scalar mean_intrinsic_dimensionality = 0;
     Scalar log_k_kp = log(static_cast<Scalar>(K1) / static_cast<Scalar>(K2));
     for (Index i = 0; i < indexes_in_subset.size(); ++i) {
-      std::vector<PixelView> results;
-      std::vector<Scalar> distance_squares;
-      vptree.search(pixel_views[i], K1 + 1, &results, &distance_squares);
-      mean_intrinsic_dimensionality += 2 * log_k_kp / log(distance_squares[K1] / distance_squares[K2]);
+      mean_intrinsic_dimensionality +=
+          2 * log_k_kp / log(subset_table.distance_square(i, K1) / subset_table.distance_square(i, K2));
     }
     mean_intrinsic_dimensionality /= indexes_in_subset.size();
 
-    std::vector<Scalar> slope_of_k(23, 0);
-    for (Index k = 3; k <= 22; ++k) {
-//      LOGI("K = " << k);
-//      LOGI(indexes_in_subset.size());
-      std::vector<Index> randomed_indexes_in_subset(indexes_in_subset);
-
-      gsl::Matrix log_N_log_L(100 - 10 + 1, 2);
-      Index Ni = 0;
-      for (Index N = 10; N <= 100; ++N) {
-        std::random_device rd;
-        std::mt19937 g(rd());
-        std::shuffle(randomed_indexes_in_subset.begin(), randomed_indexes_in_subset.end(), g);
-
-        std::vector<Index> indexes_in_subset_of_subset(N, 0);
-        std::copy_n(randomed_indexes_in_subset.begin(), N, indexes_in_subset_of_subset.begin());
-
-        auto subset_of_subset_data = gsl::GetRows(data_, indexes_in_subset_of_subset);
-        VpTree<PixelView, SquaredDistance> vptree;
-        auto pixel_views = CreatePixelViewsFromMatrix(*subset_of_subset_data);
-        vptree.create(pixel_views);
-
-        gsl::Matrix knngraph_subset_of_subset(N, N);
-        for (Index n = 0; n < N; ++n) {
-          std::vector<PixelView> results;
-          std::vector<Scalar> distance_squares;
-          vptree.search(pixel_views[n], k + 1, &results, &distance_squares);
-          for (Index ki = 1; ki < results.size(); ++ki) {
-            knngraph_subset_of_subset(n, results[ki].index) = sqrt(distance_squares[ki]);
-            knngraph_subset_of_subset(results[ki].index, n) = sqrt(distance_squares[ki]);
-          }
-
-
-        }
-
-        Scalar L = 0;
-        for (Index r = 0; r < knngraph_subset_of_subset.rows(); ++r) {
-          for (Index c = r + 1; c < knngraph_subset_of_subset.cols(); ++c) {
-            L += knngraph_subset_of_subset(r, c);
-          }
-        }
-
-        log_N_log_L(Ni, 0) = log(static_cast<Scalar>(N));
-        log_N_log_L(Ni, 1) = log(L * 2);
-        ++Ni;
-      }
-
-      double c0, c1, cov00, cov01, cov11, sumsq;
-      gsl_fit_linear(&(log_N_log_L.m_->data[0]), 2, &(log_N_log_L.m_->data[1]), 2, log_N_log_L.rows(), &c0, &c1, &cov00, &cov01, &cov11, &sumsq);
-      slope_of_k[k] = c1;
-//      LOGI("c0 " << c0 << " c1 " << c1);
-    }
-
-
+    const std::vector<Scalar> &slope_of_k = slopes_of_subsets[s];
 
     LOGI(mean_intrinsic_dimensionality);
     mean_intrinsic_dimensionality_log(s, 0) = mean_intrinsic_dimensionality;
@@ -144,7 +181,7 @@ KNNGraph_AdaptiveK_HIDENN::KNNGraph_AdaptiveK_HIDENN(std::shared_ptr<gsl::Matrix
     Scalar min_diff = 10000;
     Index optim_k = 0;
     Scalar optim_slope = 1.0 - 1.0 / mean_intrinsic_dimensionality;
-    for (Index k = 3; k <= 22; ++k) {
+    for (Index k = hidenn_detail::MIN_K; k <= hidenn_detail::MAX_K; ++k) {
       if (std::abs(optim_slope - slope_of_k[k]) < min_diff) {
         min_diff = std::abs(optim_slope - slope_of_k[k]);
         optim_k = k;
@@ -168,83 +205,41 @@ KNNGraph_AdaptiveK_HIDENN::KNNGraph_AdaptiveK_HIDENN(std::shared_ptr<gsl::Matrix
     ofs << optim_ks_mat;
   }
 
-  if (property_list_[KNNGRAPH_GRAPH_BACKEND] == KNNGRAPH_GRAPH_BACKEND_ADJACENCYLIST) {
-    knngraph_ = std::make_shared<GraphUtils::AdjacencyList>(data_->rows());
-  } else if (property_list_[KNNGRAPH_GRAPH_BACKEND] == KNNGRAPH_GRAPH_BACKEND_BOOST) {
-    knngraph_ = std::make_shared<GraphUtils::BoostAdjacencyList>(data_->rows());
-  } else {
-    throw std::invalid_argument("Invalid KNNGRAPH_GRAPH_BACKEND value.");
-  }
-
-  kIndex MST_EDGE_POOL_DEPTH = 120;
-
+  knngraph_ = CreateKNNGraphBackend(property_list_, data_->rows());
 
   LOGI("Constructing kNN graph with FixedK_MST.")
 
-  VpTree<PixelView, SquaredDistance> vptree;
-  LOGI("Create PixelView array.");
-  auto pixel_views = CreatePixelViewsFromMatrix(*data_);
-  LOGI("Creating VpTree for the current data matrix.")
-  vptree.create(pixel_views);
-  LOGI("VpTree created. Now creating kNN graph.")
-
-  UnionFind uf(data_->rows());
-  std::vector<UndirectedEdge> unused_edges;
+  auto knn_search = KNNSearchWithBackend(*data_, property_list_);
+  LOGI("kNN search backend created. Now creating kNN graph.")
 
+  ConcurrentUnionFind uf(data_->rows());
 
   s = 0;
   for (auto indexes_in_subset : subset_indexes) {
 
     Index adaptive_k = optim_ks[s];
 
-    for (Index ni = 0; ni < indexes_in_subset.size(); ++ni) {
-      Index n = indexes_in_subset[ni];
-
-      PixelView current_pixel = pixel_views[n];
-      std::vector<PixelView> results;
-      std::vector<Scalar> distance_squares;
-      vptree.search(current_pixel, MST_EDGE_POOL_DEPTH, &results, &distance_squares);
+    for (Index first = 0; first < indexes_in_subset.size(); first += KNN_SEARCH_BATCH_ROWS) {
+      Index last = std::min(first + KNN_SEARCH_BATCH_ROWS, static_cast<Index>(indexes_in_subset.size()));
+      std::vector<Index> batch(indexes_in_subset.begin() + first, indexes_in_subset.begin() + last);
+      auto table = knn_search->SearchReferenceRows(batch, adaptive_k);
 
-      for (Index j = 0; j < MST_EDGE_POOL_DEPTH; ++j) {
-        if (j < adaptive_k) {
-          knngraph_->Connect(current_pixel.index, results[j].index, std::sqrt(distance_squares[j]));
-          uf.Connect(current_pixel.index, results[j].index);
-        } else {
-          unused_edges.push_back(UndirectedEdge(current_pixel.index, results[j].index, std::sqrt(distance_squares[j])));
+      for (Index ni = first; ni < last; ++ni) {
+        Index n = indexes_in_subset[ni];
+        for (Index j = 0; j < table.k; ++j) {
+          knngraph_->Connect(n, table.index(ni - first, j), std::sqrt(table.distance_square(ni - first, j)));
         }
       }
+      ParallelFor(first, last, [&](Index ni, Index) {
+        for (Index j = 0; j < table.k; ++j) uf.Connect(indexes_in_subset[ni], table.index(ni - first, j));
+      }, static_cast<Index>(property_list_[PARALLEL_THREADS]));
     }
 
     ++s;
   }
   LOGI("kNN graph without MST has " << uf.count() << " connected parts.")
 
-  if (uf.count() != 1) {
-    LOGI("Start augmenting MST.")
-
-    std::sort(std::begin(unused_edges), std::end(unused_edges), [](UndirectedEdge a, UndirectedEdge b) {
-      return a.weight < b.weight;
-    });
-
-    Index augment_count = 0;
-    for (auto edge : unused_edges) {
-      Index old_count = uf.count();
-      uf.Connect(edge.index_a, edge.index_b);
-      if (uf.count() < old_count) {
-        knngraph_->Connect(edge.index_a, edge.index_b, edge.weight);
-        augment_count++;
-      }
-      if (uf.count() == 1) break;
-    }
-
-    LOGI(augment_count << " edges augmented.")
-
-    if (uf.count() != 1) {
-      throw std::invalid_argument(
-          "MST Augmentation failed -- need to increase KNNGRAPH_FIXED_K_WITH_MST_EDGE_POOL_DEPTH");
-    }
-
-  }
+  AugmentBoruvka(*knngraph_, uf, *data_, static_cast<Index>(property_list_[PARALLEL_THREADS]));
 
   LOGI("kNN graph construction finished.")
 
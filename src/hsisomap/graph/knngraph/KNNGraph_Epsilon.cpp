@@ -0,0 +1,124 @@
+//
+// Created on 10/19/26.
+//
+
+#include <hsisomap/graph/knngraph/KNNGraph_Epsilon.h>
+#include <hsisomap/graph/knngraph/KNNGraphUtil.h>
+#include <hsisomap/Logger.h>
+#include <hsisomap/util/VpTree.h>
+#include <hsisomap/subsetter/Subsetter.h>
+#include <cmath>
+#include <numeric>
+
+HSISOMAP_NAMESPACE_BEGIN
+
+namespace {
+
+kIndex kRadiusSamples = 1024;
+
+}
+
+KNNGraph_Epsilon::KNNGraph_Epsilon(std::shared_ptr<gsl::Matrix> data, PropertyList property_list)
+    : data_(data), property_list_(property_list) {
+
+  if (property_list_[KNNGRAPH_EPSILON_SUBSET_NUMBER] == 0.0) property_list_[KNNGRAPH_EPSILON_SUBSET_NUMBER] = 1.0;
+  if (property_list_[KNNGRAPH_EPSILON_REFERENCE_K] == 0.0) property_list_[KNNGRAPH_EPSILON_REFERENCE_K] = 10.0;
+  if (property_list_[KNNGRAPH_EPSILON_SCALE] == 0.0) property_list_[KNNGRAPH_EPSILON_SCALE] = 1.0;
+  if (property_list_[KNNGRAPH_EPSILON_MAX_DEGREE] == 0.0) property_list_[KNNGRAPH_EPSILON_MAX_DEGREE] = 64.0;
+
+  kIndex N = data_->rows();
+  kIndex D = data_->cols();
+  kIndex MAX_DEGREE = static_cast<Index>(property_list_[KNNGRAPH_EPSILON_MAX_DEGREE]);
+  kIndex threads = ParallelThreadCount(static_cast<Index>(property_list_[PARALLEL_THREADS]));
+
+  knngraph_ = CreateKNNGraphBackend(property_list_, N);
+
+  LOGI("Constructing epsilon graph.")
+
+  radii_.assign(N, property_list_[KNNGRAPH_EPSILON_RADIUS]);
+  if (property_list_[KNNGRAPH_EPSILON_RADIUS] == 0.0) {
+    std::vector<std::vector<Index>> subset_indexes;
+    if (property_list_[KNNGRAPH_EPSILON_SUBSET_NUMBER] > 1.0) {
+      LOGI("Subsetting.")
+      subset_indexes = SubsetterWithImplementation(SUBSETTER_IMPLEMENTATION_EMBEDDING,
+                                                   data_,
+                                                   {{SUBSETTER_DEFAULT_EMBEDDING,
+                                                     SUBSETTER_DEFAULT_EMBEDDING_PCA},
+                                                    {SUBSETTER_EMBEDDING_SLICING_MODE,
+                                                     SUBSETTER_EMBEDDING_SLICING_MODE_FIRST_MEAN},
+                                                    {SUBSETTER_SUBSETS, property_list_[KNNGRAPH_EPSILON_SUBSET_NUMBER]}})->subsets();
+    } else {
+      subset_indexes.push_back(std::vector<Index>(N));
+      std::iota(subset_indexes[0].begin(), subset_indexes[0].end(), 0);
+    }
+
+    auto knn_search = KNNSearchWithBackend(*data_, property_list_);
+    kIndex REFERENCE_K = static_cast<Index>(property_list_[KNNGRAPH_EPSILON_REFERENCE_K]);
+
+    for (Index s = 0; s < subset_indexes.size(); ++s) {
+      auto &indexes_in_subset = subset_indexes[s];
+      if (indexes_in_subset.empty()) continue;
+
+      // Evenly spaced samples of the subset.
+      Index samples = std::min(kRadiusSamples, static_cast<Index>(indexes_in_subset.size()));
+      std::vector<Index> rows(samples);
+      for (Index i = 0; i < samples; ++i) rows[i] = indexes_in_subset[i * indexes_in_subset.size() / samples];
+      auto table = knn_search->SearchReferenceRows(rows, REFERENCE_K);
+
+      std::vector<Scalar> kth_distance_squares(samples);
+      for (Index i = 0; i < samples; ++i) kth_distance_squares[i] = table.distance_square(i, table.k - 1);
+      std::nth_element(kth_distance_squares.begin(), kth_distance_squares.begin() + samples / 2,
+                       kth_distance_squares.end());
+      Scalar radius = std::sqrt(kth_distance_squares[samples / 2]) * property_list_[KNNGRAPH_EPSILON_SCALE];
+      LOGI("Subset " << s << " of " << indexes_in_subset.size() << " points has radius " << radius << ".")
+
+      for (auto n : indexes_in_subset) radii_[n] = radius;
+    }
+  }
+
+  LOGI("Creating VpTree for radius search.")
+  VpTree<PixelView, SquaredDistance> vptree;
+  vptree.create(CreatePixelViewsFromMatrix(*data_));
+
+  // Each thread keeps the closest MAX_DEGREE hits of the current point in a reused heap, and appends the edges to
+  // its own buffer. The connected parts are tracked on the fly.
+  ConcurrentUnionFind uf(N);
+  std::vector<std::vector<UndirectedEdge>> buffers(threads);
+  std::vector<std::vector<std::pair<Scalar, Index>>> heaps(threads);
+  ParallelFor(0, N, [&](Index n, Index thread) {
+    auto &heap = heaps[thread];
+    heap.clear();
+    PixelView query(D, data_->m_->data + n * data_->m_->tda, n);
+    vptree.search_r(query, radii_[n] * radii_[n], [&](const PixelView &item, Scalar distance_square) {
+      if (item.index == n) return;
+      if (heap.size() < MAX_DEGREE) {
+        heap.push_back(std::make_pair(distance_square, item.index));
+        std::push_heap(heap.begin(), heap.end());
+      } else if (distance_square < heap.front().first) {
+        std::pop_heap(heap.begin(), heap.end());
+        heap.back() = std::make_pair(distance_square, item.index);
+        std::push_heap(heap.begin(), heap.end());
+      }
+    });
+    for (auto &hit : heap) {
+      buffers[thread].push_back(UndirectedEdge(n, hit.second, std::sqrt(hit.first)));
+      uf.Connect(n, hit.second);
+    }
+  }, threads);
+
+  Index edges = 0;
+  for (auto &buffer : buffers) {
+    for (auto &edge : buffer) knngraph_->Connect(edge.index_a, edge.index_b, edge.weight);
+    edges += buffer.size();
+    std::vector<UndirectedEdge>().swap(buffer);
+  }
+
+  LOGI("Epsilon graph without MST has " << edges << " directed edges and " << uf.count() << " connected parts.")
+
+  AugmentBoruvka(*knngraph_, uf, *data_, threads);
+
+  LOGI("Epsilon graph construction finished.")
+
+}
+
+HSISOMAP_NAMESPACE_END
@@ -0,0 +1,76 @@
+//
+// Created on 10/19/26.
+//
+
+#include <hsisomap/graph/knngraph/KNNGraph_FixedK.h>
+#include <hsisomap/graph/knngraph/KNNGraphUtil.h>
+#include <hsisomap/graph/CSRGraph.h>
+#include <hsisomap/Logger.h>
+#include <hsisomap/knnsearch/KNNSearch.h>
+#include <hsisomap/util/Parallel.h>
+#include <algorithm>
+#include <functional>
+#include <sstream>
+
+HSISOMAP_NAMESPACE_BEGIN
+
+KNNGraph_FixedK::KNNGraph_FixedK(std::shared_ptr<gsl::Matrix> data, PropertyList property_list)
+    : data_(data), property_list_(property_list) {
+
+  if (property_list_[KNNGRAPH_FIXED_K_NUMBER] == 0.0) property_list_[KNNGRAPH_FIXED_K_NUMBER] = 30.0;
+  if (property_list_.find(KNNGRAPH_GRAPH_BACKEND) == property_list_.end()) {
+    property_list_[KNNGRAPH_GRAPH_BACKEND] = KNNGRAPH_GRAPH_BACKEND_CSR;
+  }
+  if (property_list_.find(KNN_BACKEND) == property_list_.end()) property_list_[KNN_BACKEND] = KNNGraphDefaultBackend();
+  kIndex N = data_->rows();
+  kIndex FIXED_K = static_cast<Index>(property_list_[KNNGRAPH_FIXED_K_NUMBER]);
+
+  LOGI("Constructing kNN graph with FixedK.")
+
+  auto knn_search = KNNSearchWithBackend(*data_, property_list_);
+  LOGI("kNN search backend created. Now searching " << FIXED_K << " neighbors of " << N << " points.")
+
+  // One query for all the rows: the table is the adjacency of the graph, so batching would not save memory.
+  auto table = knn_search->SearchReference(0, N, FIXED_K);
+  for (auto &distance : table.distance_squares) distance = std::sqrt(distance);
+
+  if (property_list_[KNNGRAPH_GRAPH_BACKEND] == KNNGRAPH_GRAPH_BACKEND_CSR) {
+    knngraph_ = std::make_shared<GraphUtils::CSRGraph>(N, table.k, table.indices, table.distance_squares);
+  } else {
+    knngraph_ = CreateKNNGraphBackend(property_list_, N);
+    for (Index n = 0; n < N; ++n) {
+      for (Index j = 0; j < table.k; ++j) knngraph_->Connect(n, table.index(n, j), table.distance_square(n, j));
+    }
+  }
+
+  kIndex THREADS = static_cast<Index>(property_list_[PARALLEL_THREADS]);
+  ConcurrentUnionFind uf(N);
+  ParallelFor(0, N, [&](Index n, Index) {
+    for (Index j = 0; j < table.k; ++j) uf.Connect(n, table.index(n, j));
+  }, THREADS);
+  // The representative of a set is its smallest element, so the roots are numbered in one pass.
+  std::vector<Index> component_of_root(N, 0);
+  for (Index n = 0; n < N; ++n) {
+    Index root = uf.Find(n);
+    if (root == n) {
+      component_of_root[n] = component_sizes_.size();
+      component_sizes_.push_back(0);
+    }
+    ++component_sizes_[component_of_root[root]];
+  }
+  std::sort(component_sizes_.begin(), component_sizes_.end(), std::greater<Index>());
+
+  if (component_sizes_.size() > 1) {
+    std::ostringstream sizes;
+    for (Index c = 0; c < std::min<Index>(component_sizes_.size(), 10); ++c) sizes << " " << component_sizes_[c];
+    if (component_sizes_.size() > 10) sizes << " ...";
+    LOGW("kNN graph has " << component_sizes_.size() << " connected components, of sizes" << sizes.str() << ".")
+  } else {
+    LOGI("kNN graph is connected.")
+  }
+
+  LOGI("kNN graph construction finished.")
+
+}
+
+HSISOMAP_NAMESPACE_END
@@ -0,0 +1,279 @@
+//
+// Created on 10/19/26.
+//
+
+#include <hsisomap/graph/knngraph/KNNGraph_NNDescent.h>
+#include <hsisomap/graph/knngraph/KNNGraphUtil.h>
+#include <hsisomap/Logger.h>
+#include <hsisomap/util/RPForest.h>
+#include <hsisomap/util/VpTree.h>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <numeric>
+#include <random>
+
+HSISOMAP_NAMESPACE_BEGIN
+
+namespace {
+
+kIndex kLockStripes = 4096;
+
+//! Fixed capacity max-heaps of neighbor candidates (one heap per point), stored in flat arrays.
+class NeighborHeaps {
+ public:
+  NeighborHeaps(Index points, Index capacity)
+      : capacity_(capacity), sizes_(points, 0), ids_(points * capacity), distances_(points * capacity),
+        flags_(points * capacity, 0) { }
+
+  Index size(Index i) const { return sizes_[i]; }
+  Index *ids(Index i) { return &ids_[i * capacity_]; }
+  Scalar *distances(Index i) { return &distances_[i * capacity_]; }
+  char *flags(Index i) { return &flags_[i * capacity_]; }
+
+  //! Push a candidate into the heap of point i. If the heap is full, the farthest candidate is pushed out.
+  //! \return whether the candidate is inserted, false if it is too far or already in the heap.
+  bool Push(Index i, Index id, Scalar distance, char flag) {
+    if (capacity_ == 0) return false;
+    Index *heap_ids = ids(i);
+    Scalar *heap_distances = distances(i);
+    char *heap_flags = flags(i);
+    Index size = sizes_[i];
+
+    if (size == capacity_ && distance >= heap_distances[0]) return false;
+    for (Index j = 0; j < size; ++j) {
+      if (heap_ids[j] == id) return false;
+    }
+
+    Index pos;
+    if (size < capacity_) {
+      pos = size;
+      sizes_[i] = size + 1;
+      while (pos > 0) {
+        Index parent = (pos - 1) / 2;
+        if (heap_distances[parent] >= distance) break;
+        heap_ids[pos] = heap_ids[parent];
+        heap_distances[pos] = heap_distances[parent];
+        heap_flags[pos] = heap_flags[parent];
+        pos = parent;
+      }
+    } else {
+      pos = 0;
+      while (true) {
+        Index child = 2 * pos + 1;
+        if (child >= size) break;
+        if (child + 1 < size && heap_distances[child + 1] > heap_distances[child]) ++child;
+        if (heap_distances[child] <= distance) break;
+        heap_ids[pos] = heap_ids[child];
+        heap_distances[pos] = heap_distances[child];
+        heap_flags[pos] = heap_flags[child];
+        pos = child;
+      }
+    }
+    heap_ids[pos] = id;
+    heap_distances[pos] = distance;
+    heap_flags[pos] = flag;
+    return true;
+  }
+
+ private:
+  Index capacity_;
+  std::vector<Index> sizes_;
+  std::vector<Index> ids_;
+  std::vector<Scalar> distances_;
+  std::vector<char> flags_;
+};
+
+//! Derive an independent seed for one point in one phase, so the result does not depend on thread scheduling.
+inline std::minstd_rand::result_type PointSeed(Index seed, Index phase, Index point) {
+  std::uint64_t x = static_cast<std::uint64_t>(seed) * 0x9E3779B97F4A7C15ULL + phase * 0xBF58476D1CE4E5B9ULL + point;
+  x ^= x >> 31;
+  x *= 0x94D049BB133111EBULL;
+  x ^= x >> 29;
+  return static_cast<std::minstd_rand::result_type>(x % 2147483646ULL + 1);
+}
+
+//! Keep a random sample of at most samples elements of the list (partial Fisher-Yates shuffle).
+inline void SampleInPlace(std::vector<Index> &list, Index samples, std::minstd_rand &rng) {
+  if (list.size() <= samples) return;
+  for (Index s = 0; s < samples; ++s) {
+    std::uniform_int_distribution<Index> pick(s, list.size() - 1);
+    std::swap(list[s], list[pick(rng)]);
+  }
+  list.resize(samples);
+}
+
+} // namespace
+
+KNNGraph_NNDescent::KNNGraph_NNDescent(std::shared_ptr<gsl::Matrix> data, PropertyList property_list)
+    : data_(data), property_list_(property_list) {
+
+  if (property_list_[KNNGRAPH_NN_DESCENT_K_NUMBER] == 0.0) property_list_[KNNGRAPH_NN_DESCENT_K_NUMBER] = 30.0;
+  if (property_list_[KNNGRAPH_NN_DESCENT_SAMPLE_RATE] == 0.0) property_list_[KNNGRAPH_NN_DESCENT_SAMPLE_RATE] = 1.0;
+  if (property_list_[KNNGRAPH_NN_DESCENT_TERMINATION_DELTA] == 0.0)
+    property_list_[KNNGRAPH_NN_DESCENT_TERMINATION_DELTA] = 0.001;
+  if (property_list_[KNNGRAPH_NN_DESCENT_MAX_ITERATIONS] == 0.0) property_list_[KNNGRAPH_NN_DESCENT_MAX_ITERATIONS] = 10.0;
+
+  if (property_list_[KNNGRAPH_NN_DESCENT_K_NUMBER] < 2.0) {
+    throw std::invalid_argument("KNNGRAPH_NN_DESCENT_K_NUMBER needs to be at least 2.");
+  }
+  if (property_list_[KNNGRAPH_NN_DESCENT_SAMPLE_RATE] <= 0.0 || property_list_[KNNGRAPH_NN_DESCENT_SAMPLE_RATE] > 1.0) {
+    throw std::invalid_argument("KNNGRAPH_NN_DESCENT_SAMPLE_RATE needs to be in (0, 1].");
+  }
+
+  knngraph_ = CreateKNNGraphBackend(property_list_, data_->rows());
+
+  kIndex N = data_->rows();
+  // The point itself is counted in k, the same as KNNGRAPH_FIXED_K_NUMBER.
+  kIndex K = std::min(static_cast<Index>(property_list_[KNNGRAPH_NN_DESCENT_K_NUMBER]) - 1, N > 0 ? N - 1 : 0);
+  kIndex SAMPLES = std::max<Index>(1, static_cast<Index>(std::ceil(property_list_[KNNGRAPH_NN_DESCENT_SAMPLE_RATE] * K)));
+  kScalar TERMINATION_DELTA = property_list_[KNNGRAPH_NN_DESCENT_TERMINATION_DELTA];
+  kIndex MAX_ITERATIONS = static_cast<Index>(property_list_[KNNGRAPH_NN_DESCENT_MAX_ITERATIONS]);
+  kIndex THREADS = ParallelThreadCount(static_cast<Index>(property_list_[PARALLEL_THREADS]));
+  kIndex SEED = property_list_[KNNGRAPH_NN_DESCENT_SEED] == 0.0 ? std::random_device()()
+                                                                 : static_cast<Index>(property_list_[KNNGRAPH_NN_DESCENT_SEED]);
+
+  LOGI("Constructing kNN graph with NNDescent on " << THREADS << " threads.")
+
+  auto pixel_views = CreatePixelViewsFromMatrix(*data_);
+  NeighborHeaps neighbors(N, K);
+  std::vector<std::mutex> locks(kLockStripes);
+
+  // Offer j as a neighbor of i.
+  auto update = [&](Index i, Index j, Scalar distance) -> Index {
+    std::lock_guard<std::mutex> lock(locks[i % locks.size()]);
+    return neighbors.Push(i, j, distance, 1) ? 1 : 0;
+  };
+
+  std::unique_ptr<RPForest> forest;
+  if (property_list_[KNNGRAPH_NN_DESCENT_INITIALIZATION] == KNNGRAPH_NN_DESCENT_INITIALIZATION_RPFOREST) {
+    if (property_list_[KNN_RPFOREST_TREES] == 0.0) property_list_[KNN_RPFOREST_TREES] = 4.0;
+    if (property_list_[KNN_RPFOREST_LEAF_SIZE] == 0.0) property_list_[KNN_RPFOREST_LEAF_SIZE] = std::max<Index>(K + 1, 16);
+    LOGI("Building random projection forest for the initial neighbor lists.")
+    forest.reset(new RPForest(*data_,
+                              static_cast<Index>(property_list_[KNN_RPFOREST_TREES]),
+                              static_cast<Index>(property_list_[KNN_RPFOREST_LEAF_SIZE]),
+                              SEED,
+                              THREADS));
+  } else if (property_list_[KNNGRAPH_NN_DESCENT_INITIALIZATION] != KNNGRAPH_NN_DESCENT_INITIALIZATION_RANDOM) {
+    throw std::invalid_argument("Invalid KNNGRAPH_NN_DESCENT_INITIALIZATION value.");
+  }
+
+  LOGI("Initializing neighbor lists.")
+  ParallelFor(0, N, [&](Index i, Index) {
+    std::minstd_rand rng(PointSeed(SEED, 0, i));
+    std::uniform_int_distribution<Index> pick(0, N - 1);
+    if (forest) {
+      std::vector<Index> ids;
+      std::vector<Scalar> distance_squares;
+      forest->Search(pixel_views[i].data, K + 1, &ids, &distance_squares);
+      for (Index j = 0; j < ids.size(); ++j) {
+        if (ids[j] != i) neighbors.Push(i, ids[j], distance_squares[j], 1);
+      }
+    }
+    while (neighbors.size(i) < K) {
+      Index j = pick(rng);
+      if (j == i) continue;
+      neighbors.Push(i, j, SquaredDistance(pixel_views[i], pixel_views[j]), 1);
+    }
+  }, THREADS);
+  forest.reset();
+
+  std::vector<std::vector<Index>> old_lists(N), new_lists(N), old_reverse(N), new_reverse(N);
+  std::vector<Index> thread_updates(THREADS, 0);
+
+  for (Index iteration = 0; iteration < MAX_ITERATIONS; ++iteration) {
+
+    // Split each neighbor list into old and sampled new neighbors, the sampled ones are no longer new afterwards.
+    ParallelFor(0, N, [&](Index i, Index) {
+      std::minstd_rand rng(PointSeed(SEED, 2 * iteration + 1, i));
+      Index *ids = neighbors.ids(i);
+      char *flags = neighbors.flags(i);
+      old_lists[i].clear();
+      new_lists[i].clear();
+      for (Index j = 0; j < neighbors.size(i); ++j) {
+        if (flags[j]) {
+          new_lists[i].push_back(j);
+        } else {
+          old_lists[i].push_back(ids[j]);
+        }
+      }
+      SampleInPlace(new_lists[i], SAMPLES, rng);
+      for (auto &position : new_lists[i]) {
+        flags[position] = 0;
+        position = ids[position];
+      }
+    }, THREADS);
+
+    for (Index i = 0; i < N; ++i) {
+      old_reverse[i].clear();
+      new_reverse[i].clear();
+    }
+    for (Index i = 0; i < N; ++i) {
+      for (auto j : old_lists[i]) old_reverse[j].push_back(i);
+      for (auto j : new_lists[i]) new_reverse[j].push_back(i);
+    }
+
+    ParallelFor(0, N, [&](Index i, Index) {
+      std::minstd_rand rng(PointSeed(SEED, 2 * iteration + 2, i));
+      SampleInPlace(old_reverse[i], SAMPLES, rng);
+      SampleInPlace(new_reverse[i], SAMPLES, rng);
+      old_lists[i].insert(old_lists[i].end(), old_reverse[i].begin(), old_reverse[i].end());
+      new_lists[i].insert(new_lists[i].end(), new_reverse[i].begin(), new_reverse[i].end());
+      std::sort(old_lists[i].begin(), old_lists[i].end());
+      old_lists[i].erase(std::unique(old_lists[i].begin(), old_lists[i].end()), old_lists[i].end());
+      std::sort(new_lists[i].begin(), new_lists[i].end());
+      new_lists[i].erase(std::unique(new_lists[i].begin(), new_lists[i].end()), new_lists[i].end());
+    }, THREADS);
+
+    // Local join: compare new neighbors with each other and with old neighbors.
+    std::fill(thread_updates.begin(), thread_updates.end(), 0);
+    ParallelFor(0, N, [&](Index i, Index thread) {
+      const std::vector<Index> &fresh = new_lists[i];
+      const std::vector<Index> &stale = old_lists[i];
+      Index updates = 0;
+      for (Index a = 0; a < fresh.size(); ++a) {
+        Index u1 = fresh[a];
+        for (Index b = a + 1; b < fresh.size(); ++b) {
+          Index u2 = fresh[b];
+          Scalar distance = SquaredDistance(pixel_views[u1], pixel_views[u2]);
+          updates += update(u1, u2, distance);
+          updates += update(u2, u1, distance);
+        }
+        for (auto u2 : stale) {
+          if (u1 == u2) continue;
+          Scalar distance = SquaredDistance(pixel_views[u1], pixel_views[u2]);
+          updates += update(u1, u2, distance);
+          updates += update(u2, u1, distance);
+        }
+      }
+      thread_updates[thread] += updates;
+    }, THREADS);
+
+    Index updates = std::accumulate(thread_updates.begin(), thread_updates.end(), Index(0));
+    LOGI("NNDescent iteration " << iteration + 1 << ": " << updates << " updates.")
+    if (updates <= TERMINATION_DELTA * N * K) break;
+  }
+
+  LOGI("Neighbor lists converged. Now creating kNN graph.")
+
+  ConcurrentUnionFind uf(N);
+
+  for (Index i = 0; i < N; ++i) {
+    Index *ids = neighbors.ids(i);
+    Scalar *distances = neighbors.distances(i);
+    for (Index j = 0; j < neighbors.size(i); ++j) {
+      knngraph_->Connect(i, ids[j], std::sqrt(distances[j]));
+      uf.Connect(i, ids[j]);
+    }
+  }
+
+  LOGI("kNN graph without MST has " << uf.count() << " connected parts.")
+
+  AugmentBoruvka(*knngraph_, uf, *data_, THREADS);
+
+  LOGI("kNN graph construction finished.")
+
+}
+
+HSISOMAP_NAMESPACE_END
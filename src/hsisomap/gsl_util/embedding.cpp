@@ -7,6 +7,7 @@
 #include <gsl/gsl_eigen.h>
 #include <hsisomap/gsl_util/matrix_util.h>
 #include <hsisomap/Logger.h>
+#include <hsisomap/knnsearch/KNNSearch.h>
 #include <gsl/gsl_matrix.h>
 #include <gsl/gsl_vector.h>
 
@@ -166,7 +167,7 @@ Embedding MNF(const Matrix &data, const Matrix &noise_covariance, Index reduced_
   return result;
 }
 
-std::shared_ptr<Matrix> NearestNeighborNoiseEstimation(const Matrix &data) {
+std::shared_ptr<Matrix> NearestNeighborNoiseEstimation(const Matrix &data, PropertyList property_list) {
 
   // TODO: Outlier exclusion
 
@@ -177,25 +178,28 @@ std::shared_ptr<Matrix> NearestNeighborNoiseEstimation(const Matrix &data) {
 
   Matrix noise_values(n, d);
 
-  auto l2_dist = L2Distance(data, data, true);
-
-  // Find the second smallest distance (first is 0, and should be forced, so it is smallest non-zero), so no need to fully sort the matrix
-  for (Index i = 0; i < n; ++i) {
-    Index smallest_non_zero_index = 0;
-    Scalar smallest_non_zero_value = (*l2_dist)(i, 0);
-    if (i == 0) {
-      smallest_non_zero_value = std::numeric_limits<Scalar>::max();
-    }
-    for (Index j = 1; j < n; ++j) {
-      if (j == i) continue;
-      if ((*l2_dist)(i, j) < smallest_non_zero_value) {
-        smallest_non_zero_index = j;
-        smallest_non_zero_value = (*l2_dist)(i, j);
+  // The blocked brute-force search is exact and never materializes the full pairwise distance matrix.
+  if (property_list.find(hsisomap::KNN_BACKEND) == property_list.end()) {
+    property_list[hsisomap::KNN_BACKEND] = hsisomap::KNN_BACKEND_BRUTE_FORCE;
+  }
+  auto knn_search = hsisomap::KNNSearchWithBackend(data, property_list);
+
+  // Search two neighbors, one of them is the pixel itself, and take the other one
+  for (Index first = 0; first < n; first += hsisomap::KNN_SEARCH_BATCH_ROWS) {
+    Index last = std::min(first + hsisomap::KNN_SEARCH_BATCH_ROWS, n);
+    auto table = knn_search->SearchReference(first, last, 2);
+    for (Index i = first; i < last; ++i) {
+      Index nearest_index = i;
+      for (Index j = 0; j < table.k; ++j) {
+        if (table.index(i - first, j) != i) {
+          nearest_index = table.index(i - first, j);
+          break;
+        }
       }
-    }
 
-    for (Index k = 0; k < d; ++k) {
-      noise_values(i, k) = data(i, k) - data(smallest_non_zero_index, k);
+      for (Index k = 0; k < d; ++k) {
+        noise_values(i, k) = data(i, k) - data(nearest_index, k);
+      }
     }
   }
 
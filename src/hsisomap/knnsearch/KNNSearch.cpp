@@ -0,0 +1,87 @@
+//
+// Created on 10/19/26.
+//
+
+#include <hsisomap/knnsearch/KNNSearch.h>
+#include <hsisomap/knnsearch/KNNSearch_VpTree.h>
+#include <hsisomap/knnsearch/KNNSearch_BruteForce.h>
+#include <hsisomap/knnsearch/KNNSearch_RPForest.h>
+#include <hsisomap/knnsearch/KNNSearch_PCAKDTree.h>
+#include <hsisomap/knnsearch/KNNSearch_DualTree.h>
+#include <mutex>
+#include <numeric>
+
+HSISOMAP_NAMESPACE_BEGIN
+
+namespace {
+
+std::mutex index_cache_directory_mutex;
+std::string index_cache_directory;
+
+}
+
+void SetKNNIndexCacheDirectory(const std::string &directory) {
+  std::lock_guard<std::mutex> lock(index_cache_directory_mutex);
+  index_cache_directory = directory;
+}
+
+std::string KNNIndexCacheDirectory() {
+  std::lock_guard<std::mutex> lock(index_cache_directory_mutex);
+  return index_cache_directory;
+}
+
+Scalar KNNGraphDefaultBackend() {
+  return KNNIndexCacheDirectory().empty() ? KNN_BACKEND_DUAL_TREE : KNN_BACKEND_VPTREE;
+}
+
+KNNSearch::KNNSearch(const gsl::Matrix &reference, PropertyList property_list)
+    : reference_(reference), property_list_(property_list) {
+  threads_ = ParallelThreadCount(static_cast<Index>(property_list_[PARALLEL_THREADS]));
+}
+
+KNNTable KNNSearch::Search(const gsl::Matrix &queries, Index k) {
+  if (queries.cols() != reference_.cols()) {
+    throw std::invalid_argument("Queries and reference should have same dimensionality (data matrices with same number of columns).");
+  }
+  return SearchBlock(queries.m_, k);
+}
+
+KNNTable KNNSearch::SearchReference(Index first, Index last, Index k) {
+  if (first > last || last > reference_.rows()) throw std::invalid_argument("Invalid reference row range.");
+  if (first == last) return KNNTable(0, std::min(k, reference_.rows()));
+  gsl_matrix_const_view queries = gsl_matrix_const_submatrix(reference_.m_, first, 0, last - first, reference_.cols());
+  std::vector<Index> rows(last - first);
+  std::iota(rows.begin(), rows.end(), first);
+  return SearchReferenceBlock(&queries.matrix, rows.data(), k);
+}
+
+KNNTable KNNSearch::SearchReferenceRows(const std::vector<Index> &rows, Index k) {
+  for (auto row : rows) {
+    if (row >= reference_.rows()) throw std::invalid_argument("Invalid reference row index.");
+  }
+  if (rows.empty()) return KNNTable(0, std::min(k, reference_.rows()));
+  gsl::Matrix queries(rows.size(), reference_.cols());
+  for (Index q = 0; q < rows.size(); ++q) {
+    gsl_vector_const_view row = gsl_matrix_const_row(reference_.m_, rows[q]);
+    gsl_matrix_set_row(queries.m_, q, &row.vector);
+  }
+  return SearchReferenceBlock(queries.m_, rows.data(), k);
+}
+
+std::shared_ptr<KNNSearch> KNNSearchWithBackend(const gsl::Matrix &reference, PropertyList property_list) {
+  if (property_list[KNN_BACKEND] == KNN_BACKEND_VPTREE) {
+    return std::make_shared<KNNSearch_VpTree>(reference, property_list);
+  } else if (property_list[KNN_BACKEND] == KNN_BACKEND_BRUTE_FORCE) {
+    return std::make_shared<KNNSearch_BruteForce>(reference, property_list);
+  } else if (property_list[KNN_BACKEND] == KNN_BACKEND_RPFOREST) {
+    return std::make_shared<KNNSearch_RPForest>(reference, property_list);
+  } else if (property_list[KNN_BACKEND] == KNN_BACKEND_PCA_KDTREE) {
+    return std::make_shared<KNNSearch_PCAKDTree>(reference, property_list);
+  } else if (property_list[KNN_BACKEND] == KNN_BACKEND_DUAL_TREE) {
+    return std::make_shared<KNNSearch_DualTree>(reference, property_list);
+  } else {
+    throw std::invalid_argument("Invalid KNN_BACKEND value.");
+  }
+}
+
+HSISOMAP_NAMESPACE_END
@@ -0,0 +1,185 @@
+//
+// Created on 10/19/26.
+//
+
+#include <hsisomap/knnsearch/KNNSearch_BruteForce.h>
+#include <hsisomap/util/VpTree.h>
+#include <gsl/gsl_blas.h>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+HSISOMAP_NAMESPACE_BEGIN
+
+namespace {
+
+kIndex kDefaultTileRows = 256;
+kIndex kDefaultTileCols = 2048;
+
+inline Scalar SquaredNorm(const Scalar *row, Index cols) {
+  Scalar sum = 0;
+  for (Index c = 0; c < cols; ++c) sum += row[c] * row[c];
+  return sum;
+}
+
+} // namespace
+
+KNNSearch_BruteForce::KNNSearch_BruteForce(const gsl::Matrix &reference, PropertyList property_list)
+    : KNNSearch(reference, property_list) {
+  if (property_list_[KNN_BRUTE_FORCE_TILE_ROWS] == 0.0) property_list_[KNN_BRUTE_FORCE_TILE_ROWS] = kDefaultTileRows;
+  if (property_list_[KNN_BRUTE_FORCE_TILE_COLS] == 0.0) property_list_[KNN_BRUTE_FORCE_TILE_COLS] = kDefaultTileCols;
+  tile_rows_ = static_cast<Index>(property_list_[KNN_BRUTE_FORCE_TILE_ROWS]);
+  tile_cols_ = static_cast<Index>(property_list_[KNN_BRUTE_FORCE_TILE_COLS]);
+
+  reference_norms_.resize(reference_.rows());
+  for (Index r = 0; r < reference_.rows(); ++r) {
+    reference_norms_[r] = SquaredNorm(reference_.m_->data + r * reference_.m_->tda, reference_.cols());
+  }
+
+  if (property_list_[KNN_PIVOTS] > 0) {
+    pivots_.reset(new PivotTable(reference_.m_, static_cast<Index>(property_list_[KNN_PIVOTS]), threads_));
+  }
+}
+
+KNNTable KNNSearch_BruteForce::SearchBlock(const gsl_matrix *queries, Index k) {
+  kIndex R = reference_.rows();
+  kIndex Q = queries->size1;
+  kIndex D = queries->size2;
+  k = std::min(k, R);
+  KNNTable table(Q, k);
+  if (k == 0 || Q == 0) return table;
+  if (pivots_) return SearchBlockWithPivots(queries, k);
+
+  // The rounding of the GEMM dot product and of the norms keeps the expanded form within ERROR times |a|^2 + |b|^2
+  // of the exact distance square, with some margin.
+  kScalar ERROR = (D + 2) * std::numeric_limits<Scalar>::epsilon();
+  kIndex tiles = (Q + tile_rows_ - 1) / tile_rows_;
+  kIndex threads = std::min(threads_, tiles);
+  std::vector<std::shared_ptr<gsl::Matrix>> products(threads);
+
+  ParallelFor(0, tiles, [&](Index tile, Index thread) {
+    kIndex first_row = tile * tile_rows_;
+    kIndex rows = std::min(tile_rows_, Q - first_row);
+    if (!products[thread]) products[thread] = std::make_shared<gsl::Matrix>(tile_rows_, std::min(tile_cols_, R));
+
+    // Per query row, a bounded max-heap of the upper bounds of the distance squares, whose top bounds the k-th one,
+    // and the (lower bound, reference row) candidates that may still be closer than that.
+    std::vector<Scalar> heaps(rows * k);
+    std::vector<Index> sizes(rows, 0);
+    std::vector<std::vector<std::pair<Scalar, Index>>> candidates(rows);
+    std::vector<Scalar> query_norms(rows);
+    for (Index i = 0; i < rows; ++i) {
+      query_norms[i] = SquaredNorm(queries->data + (first_row + i) * queries->tda, D);
+    }
+
+    gsl_matrix_const_view query_tile = gsl_matrix_const_submatrix(queries, first_row, 0, rows, D);
+    for (Index first_col = 0; first_col < R; first_col += tile_cols_) {
+      kIndex cols = std::min(tile_cols_, R - first_col);
+      gsl_matrix_const_view reference_tile = gsl_matrix_const_submatrix(reference_.m_, first_col, 0, cols, D);
+      gsl_matrix_view product = gsl_matrix_submatrix(products[thread]->m_, 0, 0, rows, cols);
+      gsl_blas_dgemm(CblasNoTrans, CblasTrans, 1.0, &query_tile.matrix, &reference_tile.matrix, 0.0, &product.matrix);
+
+      for (Index i = 0; i < rows; ++i) {
+        const Scalar *dots = product.matrix.data + i * product.matrix.tda;
+        Scalar *heap = &heaps[i * k];
+        Index size = sizes[i];
+        std::vector<std::pair<Scalar, Index>> &list = candidates[i];
+        for (Index j = 0; j < cols; ++j) {
+          Scalar norms = query_norms[i] + reference_norms_[first_col + j];
+          Scalar distance = norms - 2.0 * dots[j];
+          Scalar error = ERROR * norms;
+          if (size == k && distance - error > heap[0]) continue;
+          list.push_back(std::make_pair(distance - error, first_col + j));
+          if (size < k) {
+            heap[size++] = distance + error;
+            std::push_heap(heap, heap + size);
+          } else if (distance + error < heap[0]) {
+            std::pop_heap(heap, heap + k);
+            heap[k - 1] = distance + error;
+            std::push_heap(heap, heap + k);
+          }
+        }
+        sizes[i] = size;
+        // Drop the candidates ruled out since they were added, once they outnumber the neighbors.
+        if (list.size() > 2 * k) {
+          list.erase(std::remove_if(list.begin(), list.end(),
+                                    [&](const std::pair<Scalar, Index> &c) { return c.first > heap[0]; }),
+                     list.end());
+        }
+      }
+    }
+
+    // Near ties are ranked on the direct distances of the candidates, which are exact up to their own rounding.
+    for (Index i = 0; i < rows; ++i) {
+      std::vector<std::pair<Scalar, Index>> &list = candidates[i];
+      list.erase(std::remove_if(list.begin(), list.end(),
+                                [&](const std::pair<Scalar, Index> &c) { return c.first > heaps[i * k]; }),
+                 list.end());
+      PixelView query(D, queries->data + (first_row + i) * queries->tda, 0);
+      for (auto &candidate : list) {
+        PixelView neighbor(D, reference_.m_->data + candidate.second * reference_.m_->tda, 0);
+        candidate.first = SquaredDistance(query, neighbor);
+      }
+      std::partial_sort(list.begin(), list.begin() + k, list.end());
+      for (Index j = 0; j < k; ++j) {
+        table.index(first_row + i, j) = list[j].second;
+        table.distance_square(first_row + i, j) = list[j].first;
+      }
+    }
+  }, threads, 1);
+
+  return table;
+}
+
+KNNTable KNNSearch_BruteForce::SearchBlockWithPivots(const gsl_matrix *queries, Index k) {
+  kIndex R = reference_.rows();
+  kIndex D = queries->size2;
+  KNNTable table(queries->size1, k);
+
+  kIndex threads = std::min<Index>(threads_, queries->size1);
+  std::vector<std::vector<Scalar>> bounds(threads, std::vector<Scalar>(R));
+  std::vector<std::vector<Index>> order(threads, std::vector<Index>(R));
+
+  ParallelFor(0, queries->size1, [&](Index q, Index thread) {
+    PixelView query(D, queries->data + q * queries->tda, 0);
+    std::vector<Scalar> query_distances(pivots_->pivots());
+    pivots_->QueryDistances(query.data, query_distances.data());
+    for (Index r = 0; r < R; ++r) bounds[thread][r] = pivots_->LowerBound(query_distances.data(), r);
+
+    // The rows with the smallest bounds are likely neighbors; they make the first k-th distance tight.
+    std::vector<Index> &rows = order[thread];
+    std::iota(rows.begin(), rows.end(), 0);
+    std::nth_element(rows.begin(), rows.begin() + (k - 1), rows.end(),
+                     [&](Index a, Index b) { return bounds[thread][a] < bounds[thread][b]; });
+
+    std::vector<std::pair<Scalar, Index>> heap;
+    for (Index j = 0; j < k; ++j) {
+      PixelView neighbor(D, reference_.m_->data + rows[j] * reference_.m_->tda, 0);
+      heap.push_back(std::make_pair(SquaredDistance(query, neighbor), rows[j]));
+    }
+    std::make_heap(heap.begin(), heap.end());
+    Scalar tau = std::sqrt(heap[0].first);
+
+    for (Index j = k; j < R; ++j) {
+      if (bounds[thread][rows[j]] >= tau) continue;
+      PixelView neighbor(D, reference_.m_->data + rows[j] * reference_.m_->tda, 0);
+      Scalar distance = SquaredDistance(query, neighbor);
+      if (distance < heap[0].first) {
+        std::pop_heap(heap.begin(), heap.end());
+        heap.back() = std::make_pair(distance, rows[j]);
+        std::push_heap(heap.begin(), heap.end());
+        tau = std::sqrt(heap[0].first);
+      }
+    }
+
+    std::sort_heap(heap.begin(), heap.end());
+    for (Index j = 0; j < k; ++j) {
+      table.index(q, j) = heap[j].second;
+      table.distance_square(q, j) = heap[j].first;
+    }
+  }, threads);
+
+  return table;
+}
+
+HSISOMAP_NAMESPACE_END
@@ -0,0 +1,36 @@
+//
+// Created on 10/19/26.
+//
+
+#include <hsisomap/knnsearch/KNNSearch_DualTree.h>
+#include <hsisomap/Logger.h>
+
+HSISOMAP_NAMESPACE_BEGIN
+
+KNNSearch_DualTree::KNNSearch_DualTree(const gsl::Matrix &reference, PropertyList property_list)
+    : KNNSearch(reference, property_list) {
+  if (property_list_[KNN_DUAL_TREE_LEAF_SIZE] == 0.0) property_list_[KNN_DUAL_TREE_LEAF_SIZE] = 32.0;
+  LOGI("Creating ball tree on " << reference_.rows() << " reference rows.")
+  tree_.reset(new BallTree(reference_.m_, static_cast<Index>(property_list_[KNN_DUAL_TREE_LEAF_SIZE])));
+}
+
+KNNTable KNNSearch_DualTree::SearchBlock(const gsl_matrix *queries, Index k) {
+  BallTree query_tree(queries, static_cast<Index>(property_list_[KNN_DUAL_TREE_LEAF_SIZE]));
+  return Search(query_tree, k);
+}
+
+KNNTable KNNSearch_DualTree::SearchReferenceBlock(const gsl_matrix *queries, const Index *rows, Index k) {
+  // All reference rows in order: the reference tree is the query tree as well.
+  bool all_rows = queries->size1 == reference_.rows();
+  for (Index q = 0; q < queries->size1 && all_rows; ++q) all_rows = rows[q] == q;
+  if (all_rows) return Search(*tree_, k);
+  return SearchBlock(queries, k);
+}
+
+KNNTable KNNSearch_DualTree::Search(const BallTree &query_tree, Index k) {
+  KNNTable table(0, std::min(k, reference_.rows()));
+  DualTreeKNN(query_tree, *tree_, k, &table.indices, &table.distance_squares, threads_);
+  return table;
+}
+
+HSISOMAP_NAMESPACE_END
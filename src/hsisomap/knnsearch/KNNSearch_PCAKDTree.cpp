@@ -0,0 +1,67 @@
+//
+// Created on 10/19/26.
+//
+
+#include <hsisomap/knnsearch/KNNSearch_PCAKDTree.h>
+#include <hsisomap/gsl_util/embedding.h>
+#include <hsisomap/util/VpTree.h>
+#include <hsisomap/Logger.h>
+#include <gsl/gsl_blas.h>
+
+HSISOMAP_NAMESPACE_BEGIN
+
+KNNSearch_PCAKDTree::KNNSearch_PCAKDTree(const gsl::Matrix &reference, PropertyList property_list)
+    : KNNSearch(reference, property_list) {
+  if (property_list_[KNN_PCA_DIMENSIONS] == 0.0) property_list_[KNN_PCA_DIMENSIONS] = 16.0;
+  if (property_list_[KNN_KDTREE_LEAF_SIZE] == 0.0) property_list_[KNN_KDTREE_LEAF_SIZE] = 16.0;
+  Index dimensions = std::min(static_cast<Index>(property_list_[KNN_PCA_DIMENSIONS]), reference_.cols());
+
+  bases_ = std::make_shared<gsl::Matrix>(reference_.cols(), dimensions);
+  if (reference_.rows() < 2) {
+    // No covariance to estimate, the leading coordinates are used as they are.
+    gsl_matrix_set_identity(bases_->m_);
+  } else {
+    LOGI("Calculating principal axes of " << reference_.rows() << " reference rows.")
+    gsl::Embedding pca = gsl::PCA(reference_, dimensions);
+    gsl_matrix_const_view leading = gsl_matrix_const_submatrix(pca.vectors->m_, 0, 0, reference_.cols(), dimensions);
+    gsl_matrix_memcpy(bases_->m_, &leading.matrix);
+  }
+
+  // The mean is not subtracted: the translation cancels in the distances.
+  gsl::Matrix projected(reference_.rows(), dimensions);
+  if (reference_.rows() > 0 && dimensions > 0) {
+    gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1.0, reference_.m_, bases_->m_, 0.0, projected.m_);
+  }
+
+  LOGI("Creating KD-tree on " << dimensions << " principal components.")
+  tree_.reset(new KDTree(projected, static_cast<Index>(property_list_[KNN_KDTREE_LEAF_SIZE])));
+}
+
+KNNTable KNNSearch_PCAKDTree::SearchBlock(const gsl_matrix *queries, Index k) {
+  k = std::min(k, reference_.rows());
+  KNNTable table(queries->size1, k);
+  if (k == 0 || queries->size1 == 0) return table;
+
+  Index D = reference_.cols();
+  gsl::Matrix projected(queries->size1, bases_->cols());
+  if (bases_->cols() > 0) {
+    gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1.0, queries, bases_->m_, 0.0, projected.m_);
+  }
+
+  ParallelFor(0, queries->size1, [&](Index q, Index) {
+    PixelView query(D, queries->data + q * queries->tda, 0);
+    std::vector<Index> results;
+    std::vector<Scalar> distance_squares;
+    tree_->Search(projected.m_->data + q * projected.m_->tda, k, [&](Index i) {
+      return SquaredDistance(query, PixelView(D, reference_.m_->data + i * reference_.m_->tda, 0));
+    }, &results, &distance_squares);
+    for (Index j = 0; j < k; ++j) {
+      table.index(q, j) = results[j];
+      table.distance_square(q, j) = distance_squares[j];
+    }
+  }, threads_);
+
+  return table;
+}
+
+HSISOMAP_NAMESPACE_END
@@ -0,0 +1,42 @@
+//
+// Created on 10/19/26.
+//
+
+#include <hsisomap/knnsearch/KNNSearch_RPForest.h>
+#include <hsisomap/Logger.h>
+
+HSISOMAP_NAMESPACE_BEGIN
+
+KNNSearch_RPForest::KNNSearch_RPForest(const gsl::Matrix &reference, PropertyList property_list)
+    : KNNSearch(reference, property_list) {
+  if (property_list_[KNN_RPFOREST_TREES] == 0.0) property_list_[KNN_RPFOREST_TREES] = 8.0;
+  if (property_list_[KNN_RPFOREST_LEAF_SIZE] == 0.0) property_list_[KNN_RPFOREST_LEAF_SIZE] = 32.0;
+
+  LOGI("Creating random projection forest for " << reference_.rows() << " reference rows.")
+  forest_.reset(new RPForest(reference_,
+                             static_cast<Index>(property_list_[KNN_RPFOREST_TREES]),
+                             static_cast<Index>(property_list_[KNN_RPFOREST_LEAF_SIZE]),
+                             static_cast<Index>(property_list_[KNN_RPFOREST_SEED]),
+                             threads_));
+}
+
+KNNTable KNNSearch_RPForest::SearchBlock(const gsl_matrix *queries, Index k) {
+  k = std::min(k, reference_.rows());
+  KNNTable table(queries->size1, k);
+  if (k == 0) return table;
+  kIndex search_candidates = static_cast<Index>(property_list_[KNN_RPFOREST_SEARCH_CANDIDATES]);
+
+  ParallelFor(0, queries->size1, [&](Index q, Index) {
+    std::vector<Index> results;
+    std::vector<Scalar> distance_squares;
+    forest_->Search(queries->data + q * queries->tda, k, &results, &distance_squares, search_candidates);
+    for (Index j = 0; j < k; ++j) {
+      table.index(q, j) = results[j];
+      table.distance_square(q, j) = distance_squares[j];
+    }
+  }, threads_);
+
+  return table;
+}
+
+HSISOMAP_NAMESPACE_END
@@ -0,0 +1,143 @@
+//
+// Created on 10/19/26.
+//
+
+#include <hsisomap/knnsearch/KNNSearch_VpTree.h>
+#include <hsisomap/Logger.h>
+#include <hsisomap/util/VpTreeIndex.h>
+#include <cmath>
+#include <sstream>
+
+HSISOMAP_NAMESPACE_BEGIN
+
+KNNSearch_VpTree::KNNSearch_VpTree(const gsl::Matrix &reference, PropertyList property_list)
+    : KNNSearch(reference, property_list) {
+  vptree_.set_vantage_selection(static_cast<int>(property_list_[KNN_VPTREE_VANTAGE_CANDIDATES]),
+                                static_cast<int>(property_list_[KNN_VPTREE_VANTAGE_SAMPLES]));
+  auto pixel_views = CreatePixelViewsFromMatrix(reference_);
+  if (property_list_[KNN_PIVOTS] > 0) {
+    LOGI("Creating pivot table for " << reference_.rows() << " reference rows.")
+    pivots_.reset(new PivotTable(reference_.m_, static_cast<Index>(property_list_[KNN_PIVOTS]), threads_));
+  }
+
+  std::string cache_directory = KNNIndexCacheDirectory();
+  if (cache_directory.empty()) {
+    LOGI("Creating VpTree for " << reference_.rows() << " reference rows.")
+    vptree_.create(pixel_views);
+    return;
+  }
+
+  // Trees built with another vantage point selection get their own file, rather than replacing each other.
+  uint64_t checksum = MatrixChecksum(reference_);
+  int candidates = vptree_.vantage_candidates(), samples = vptree_.vantage_samples();
+  std::ostringstream path;
+  path << cache_directory << "/vptree_" << reference_.rows() << "x" << reference_.cols() << "_v" << candidates << "s"
+      << samples << "_" << std::hex << checksum << ".idx";
+
+  VpTreeIndexFile index_file(path.str(), reference_, checksum, candidates, samples);
+  if (index_file.valid()) {
+    LOGI("Loading VpTree for " << reference_.rows() << " reference rows from \"" << path.str() << "\".")
+    // The header and checksum do not cover the node array, so a malformed one is rebuilt and saved again.
+    try {
+      vptree_.create(pixel_views, index_file.nodes(), index_file.size());
+      return;
+    } catch (std::invalid_argument &e) {
+      LOGW(e.what() << " The VpTree is rebuilt.")
+    }
+  }
+
+  LOGI("Creating VpTree for " << reference_.rows() << " reference rows.")
+  vptree_.create(pixel_views);
+  LOGI("Saving VpTree to \"" << path.str() << "\".")
+  try {
+    SaveVpTreeIndex(path.str(), reference_, checksum, candidates, samples, vptree_.flatten());
+  } catch (std::invalid_argument &e) {
+    LOGW(e.what() << " The VpTree is not cached.")
+  }
+}
+
+KNNTable KNNSearch_VpTree::SearchBlock(const gsl_matrix *queries, Index k) {
+  k = std::min(k, reference_.rows());
+  KNNTable table(queries->size1, k);
+  if (k == 0) return table;
+
+  ParallelFor(0, queries->size1, [&](Index q, Index) {
+    PixelView query(queries->size2, queries->data + q * queries->tda, q);
+    std::vector<PixelView> results;
+    std::vector<Scalar> distance_squares;
+    Search(query, k, &results, &distance_squares);
+    for (Index j = 0; j < k; ++j) {
+      table.index(q, j) = results[j].index;
+      table.distance_square(q, j) = distance_squares[j];
+    }
+  }, threads_);
+
+  return table;
+}
+
+KNNTable KNNSearch_VpTree::SearchReferenceBlock(const gsl_matrix *queries, const Index *rows, Index k) {
+  kIndex samples = static_cast<Index>(property_list_[KNN_IMAGE_SAMPLES]);
+  if (samples == 0) return SearchBlock(queries, k);
+
+  k = std::min(k, reference_.rows());
+  KNNTable table(queries->size1, k);
+  if (k == 0) return table;
+
+  Index radius = static_cast<Index>(property_list_[KNN_VPTREE_SPATIAL_SEED_RADIUS]);
+  if (radius == 0) radius = std::max<Index>(1, static_cast<Index>(std::ceil((std::sqrt(2.0 * k) - 1) / 2)));
+  kIndex D = reference_.cols(), N = reference_.rows();
+
+  ParallelFor(0, queries->size1, [&](Index q, Index) {
+    PixelView query(queries->size2, queries->data + q * queries->tda, q);
+    Index line = rows[q] / samples, sample = rows[q] % samples;
+
+    // Seed the search radius with the k-th smallest distance to the pixels of the window.
+    std::vector<Scalar> window;
+    for (Index l = line - std::min(line, radius); l <= line + radius; ++l) {
+      for (Index s = sample - std::min(sample, radius); s <= std::min(sample + radius, samples - 1); ++s) {
+        Index row = l * samples + s;
+        if (row >= N) break;
+        window.push_back(SquaredDistance(query, PixelView(D, reference_.m_->data + row * reference_.m_->tda, row)));
+      }
+    }
+    Scalar tau = std::numeric_limits<Scalar>::max();
+    if (window.size() >= k) {
+      std::nth_element(window.begin(), window.begin() + (k - 1), window.end());
+      tau = window[k - 1];
+    }
+
+    std::vector<PixelView> results;
+    std::vector<Scalar> distance_squares;
+    Search(query, k, &results, &distance_squares, tau);
+    for (Index j = 0; j < k; ++j) {
+      table.index(q, j) = results[j].index;
+      table.distance_square(q, j) = distance_squares[j];
+    }
+  }, threads_);
+
+  return table;
+}
+
+void KNNSearch_VpTree::Search(const PixelView &query, Index k, std::vector<PixelView> *results,
+                              std::vector<Scalar> *distance_squares, Scalar tau) const {
+  // The tree items are the reference rows in order, so the item ids are the table rows.
+  std::vector<Scalar> query_distances;
+  if (pivots_) {
+    query_distances.resize(pivots_->pivots());
+    pivots_->QueryDistances(query.data, query_distances.data());
+  }
+  auto search = [&](Scalar bound) {
+    if (!pivots_) {
+      vptree_.search(query, static_cast<int>(k), results, distance_squares, bound);
+    } else {
+      vptree_.search(query, static_cast<int>(k), results, distance_squares, bound,
+                     [&](int id) { return pivots_->LowerBound(query_distances.data(), id); });
+    }
+  };
+
+  search(tau);
+  // The tree prunes on square roots, so rounding can lose the item at exactly a seeded tau; search again unseeded.
+  if (results->size() < k && tau < std::numeric_limits<Scalar>::max()) search(std::numeric_limits<Scalar>::max());
+}
+
+HSISOMAP_NAMESPACE_END
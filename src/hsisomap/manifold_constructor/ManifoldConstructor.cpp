@@ -5,6 +5,7 @@
 #include <hsisomap/manifold_constructor/ManifoldConstructor.h>
 #include <hsisomap/Logger.h>
 #include <gsl/gsl_blas.h>
+#include <algorithm>
 
 HSISOMAP_NAMESPACE_BEGIN
 
@@ -13,9 +14,20 @@ std::shared_ptr<gsl::Matrix> ConstructManifold(const gsl::Matrix &landmark_to_al
                                                const gsl::Matrix &landmark_distances,
                                                const gsl::Embedding &landmark_cmds_embedding,
                                                Index reduced_dimensions) {
+  const gsl_matrix *m = landmark_to_all_distances.m_;
+  return ConstructManifold(landmark_to_all_distances.cols(), [m](Index l, Scalar *row) {
+    std::copy(m->data + l * m->tda, m->data + l * m->tda + m->size2, row);
+  }, landmark_distances, landmark_cmds_embedding, reduced_dimensions);
+}
+
+std::shared_ptr<gsl::Matrix> ConstructManifold(Index points,
+                                               const DistanceRowSource &landmark_to_all_row,
+                                               const gsl::Matrix &landmark_distances,
+                                               const gsl::Embedding &landmark_cmds_embedding,
+                                               Index reduced_dimensions) {
 
-  Index L = landmark_to_all_distances.rows();
-  Index N = landmark_to_all_distances.cols();
+  Index L = landmark_distances.rows();
+  Index N = points;
 
   gsl::Matrix mean_sqrdist_lm(L, 1);
   for (Index l = 0; l < L; ++l) {
@@ -24,7 +36,6 @@ std::shared_ptr<gsl::Matrix> ConstructManifold(const gsl::Matrix &landmark_to_al
       mean += landmark_distances(l, l2) * landmark_distances(l, l2); // get squared distance
     mean /= static_cast<Scalar>(L) ;
     mean_sqrdist_lm(l, 0) = mean;
-//    for (Index n = 0; n < N; ++n)
   }
 
   gsl::Matrix PLt(L, reduced_dimensions);
@@ -34,17 +45,24 @@ std::shared_ptr<gsl::Matrix> ConstructManifold(const gsl::Matrix &landmark_to_al
     }
   }
 
-  gsl::Matrix Delta(landmark_to_all_distances);
-  gsl_matrix_mul_elements(Delta.m_, Delta.m_); // need to use squared distances
-  for (Index l = 0; l < L; ++l) {
-    for (Index n = 0; n < N; ++n) {
-      Delta(l, n) = mean_sqrdist_lm(l, 0) - Delta(l, n);
-    }
-  }
-
   LOGI("Calculating manifold coordinates: PL * Delta.")
   auto manifold = std::make_shared<gsl::Matrix>(N, reduced_dimensions);
-  gsl_blas_dgemm(CblasTrans, CblasNoTrans, 1.0, Delta.m_, PLt.m_, 0.0, manifold->m_);
+  gsl_matrix_set_zero(manifold->m_);
+
+  // Delta holds a block of landmarks at a time, and the products of the blocks are summed into the manifold.
+  Index block_rows = std::max<Index>(1, std::min<Index>(L, MANIFOLD_CONSTRUCTOR_BLOCK_ELEMENTS / std::max<Index>(1, N)));
+  gsl::Matrix Delta(block_rows, N);
+  for (Index first = 0; first < L; first += block_rows) {
+    Index count = std::min(block_rows, L - first);
+    for (Index b = 0; b < count; ++b) {
+      Scalar *row = Delta.m_->data + b * Delta.m_->tda;
+      landmark_to_all_row(first + b, row);
+      for (Index n = 0; n < N; ++n) row[n] = mean_sqrdist_lm(first + b, 0) - row[n] * row[n]; // need to use squared distances
+    }
+    gsl_matrix_view delta_block = gsl_matrix_submatrix(Delta.m_, 0, 0, count, N);
+    gsl_matrix_view plt_block = gsl_matrix_submatrix(PLt.m_, first, 0, count, reduced_dimensions);
+    gsl_blas_dgemm(CblasTrans, CblasNoTrans, 1.0, &delta_block.matrix, &plt_block.matrix, 1.0, manifold->m_);
+  }
 
   LOGI("Manifold coordinates constructed.")
   return manifold;
@@ -16,47 +16,43 @@ SubsetterRandomSkel::SubsetterRandomSkel(std::shared_ptr<gsl::Matrix> data, Prop
     : data_(data), property_list_(property_list) {
 
 
-  std::vector<Index> initial_indices(data_->rows(), 0);
-  std::iota(initial_indices.begin(), initial_indices.end(), 0);
-
   std::vector<std::vector<Index>> subsets;
 
   Index num_subsets = static_cast<Index>(property_list_[SUBSETTER_SUBSETS]);
-  Index k_limit = static_cast<Index>(static_cast<Scalar >(initial_indices.size()) / static_cast<Scalar>(num_subsets));
-
-  while (initial_indices.size() > 0) {
+  Index k_limit = std::max<Index>(1, static_cast<Index>(static_cast<Scalar>(data_->rows()) / static_cast<Scalar>(num_subsets)));
 
+  // One tree is built for the whole run; the pixels of each subset are erased from it.
+  VpTree<PixelView, SquaredDistance> vptree;
+  auto pixel_views = CreatePixelViewsFromMatrix(*data_);
+  vptree.create(pixel_views);
 
-    auto subset_of_subset_data = gsl::GetRows(data_, initial_indices);
-    VpTree<PixelView, SquaredDistance> vptree;
-    auto pixel_views = CreatePixelViewsFromMatrix(*subset_of_subset_data);
-    vptree.create(pixel_views);
+  // The remaining pixels, with their positions for constant time removal.
+  std::vector<Index> remaining(data_->rows(), 0);
+  std::iota(remaining.begin(), remaining.end(), 0);
+  std::vector<Index> position(remaining);
 
+  std::random_device rd;
+  std::mt19937 g(rd());
 
-    std::random_device rd;
-    std::mt19937 g(rd());
-    std::uniform_int_distribution<Index> rand_dist(0, initial_indices.size() - 1);
-    Index random_center_in_initial_indices = rand_dist(g);
+  while (remaining.size() > 0) {
 
-          std::vector<PixelView> results;
-          std::vector<Scalar> distance_squares;
-          vptree.search(pixel_views[random_center_in_initial_indices], k_limit, &results, &distance_squares);
+    std::uniform_int_distribution<Index> rand_dist(0, remaining.size() - 1);
+    Index random_center = remaining[rand_dist(g)];
 
-    std::vector<Index> remove_list;
-    remove_list.push_back(random_center_in_initial_indices);
+    std::vector<PixelView> results;
+    std::vector<Scalar> distance_squares;
+    vptree.search(pixel_views[random_center], static_cast<int>(k_limit), &results, &distance_squares);
 
-    for (Index ki = 1; ki < results.size(); ++ki) {
-      remove_list.push_back(results[ki].index);
-          }
+    std::vector<Index> selected_original_indexes(1, random_center);
+    for (Index ki = 0; ki < results.size() && selected_original_indexes.size() < k_limit; ++ki) {
+      if (results[ki].index != random_center) selected_original_indexes.push_back(results[ki].index);
+    }
 
-    std::vector<Index> selected_original_indexes;
-    Index cumulator = 0;
-    for (Index i : remove_list) {
-//      LOGI("REMOVE " << initial_indices[i]);
-      selected_original_indexes.push_back(initial_indices[i]);
-      Index initial_indices_size = initial_indices.size();
-      initial_indices.erase(initial_indices.begin() + (i - cumulator));
-      ++cumulator;
+    for (Index i : selected_original_indexes) {
+      vptree.erase(static_cast<int>(i));
+      remaining[position[i]] = remaining.back();
+      position[remaining.back()] = position[i];
+      remaining.pop_back();
     }
 
     LOGI("New Subset");
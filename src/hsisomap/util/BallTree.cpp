@@ -0,0 +1,334 @@
+//
+// Created on 10/19/26.
+//
+
+#include <hsisomap/util/BallTree.h>
+#include <hsisomap/util/Parallel.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+HSISOMAP_NAMESPACE_BEGIN
+
+namespace {
+
+inline Scalar SquaredDistance(const Scalar *a, const Scalar *b, Index dimensions) {
+  Scalar distance = 0;
+  for (Index d = 0; d < dimensions; ++d) distance += (a[d] - b[d]) * (a[d] - b[d]);
+  return distance;
+}
+
+}
+
+BallTree::BallTree(const gsl_matrix *data, Index leaf_size)
+    : data_(data), leaf_size_(std::max<Index>(1, leaf_size)), order_(data->size1) {
+  std::iota(order_.begin(), order_.end(), 0);
+  if (data_->size1 > 0) Build();
+}
+
+Index BallTree::AddNode(Index begin, Index end, Index parent) {
+  kIndex D = data_->size2;
+  Node node = {begin, end, NO_CHILD, NO_CHILD, parent, 0.0};
+  Index id = nodes_.size();
+  centers_.resize(centers_.size() + D, 0.0);
+  Scalar *c = &centers_[id * D];
+  for (Index p = begin; p < end; ++p) {
+    const Scalar *x = point(order_[p]);
+    for (Index d = 0; d < D; ++d) c[d] += x[d];
+  }
+  for (Index d = 0; d < D; ++d) c[d] /= (end - begin);
+  for (Index p = begin; p < end; ++p) {
+    node.radius = std::max(node.radius, SquaredDistance(point(order_[p]), c, D));
+  }
+  node.radius = std::sqrt(node.radius);
+  nodes_.push_back(node);
+  return id;
+}
+
+void BallTree::Build() {
+  kIndex D = data_->size2;
+  std::vector<Index> stack(1, AddNode(0, order_.size(), NO_CHILD));
+  std::vector<std::pair<Scalar, Index>> projected;
+  std::vector<Scalar> direction(D);
+
+  while (!stack.empty()) {
+    Index id = stack.back();
+    stack.pop_back();
+    Index begin = nodes_[id].begin, end = nodes_[id].end;
+    if (end - begin <= leaf_size_) continue;
+
+    // Two far apart points: the farthest from the centroid, and the farthest from that one.
+    Index a = order_[begin], b = order_[begin];
+    Scalar farthest = -1;
+    for (Index p = begin; p < end; ++p) {
+      Scalar distance = SquaredDistance(point(order_[p]), center(id), D);
+      if (distance > farthest) {
+        farthest = distance;
+        a = order_[p];
+      }
+    }
+    farthest = -1;
+    for (Index p = begin; p < end; ++p) {
+      Scalar distance = SquaredDistance(point(order_[p]), point(a), D);
+      if (distance > farthest) {
+        farthest = distance;
+        b = order_[p];
+      }
+    }
+    if (farthest <= 0) continue; // All points coincide, keep it as a leaf.
+
+    for (Index d = 0; d < D; ++d) direction[d] = point(b)[d] - point(a)[d];
+    projected.resize(end - begin);
+    for (Index p = begin; p < end; ++p) {
+      const Scalar *x = point(order_[p]);
+      Scalar projection = 0;
+      for (Index d = 0; d < D; ++d) projection += x[d] * direction[d];
+      projected[p - begin] = std::make_pair(projection, order_[p]);
+    }
+    Index median = (end - begin) / 2;
+    std::nth_element(projected.begin(), projected.begin() + median, projected.end());
+    for (Index p = begin; p < end; ++p) order_[p] = projected[p - begin].second;
+
+    Index left = AddNode(begin, begin + median, id);
+    Index right = AddNode(begin + median, end, id);
+    nodes_[id].left = left;
+    nodes_[id].right = right;
+    stack.push_back(left);
+    stack.push_back(right);
+  }
+}
+
+//! State of a dual-tree all kNN search. Each query point keeps a max-heap of its k best candidates, and each query
+//! node the largest k-th neighbor distance of its points (a Euclidean distance, not squared).
+class DualTreeKNNTraversal {
+ public:
+  DualTreeKNNTraversal(const BallTree &queries, const BallTree &reference, Index k)
+      : queries_(queries), reference_(reference), k_(k), dimensions_(queries.data_->size2),
+        heaps_(queries.size() * k), heap_sizes_(queries.size(), 0),
+        bounds_(queries.nodes_.size(), std::numeric_limits<Scalar>::max()) { }
+
+  //! Split the query tree into at least the given number of independent subtrees, when there are enough nodes.
+  std::vector<Index> Tasks(Index count) const {
+    std::vector<Index> tasks(1, 0);
+    bool split = true;
+    while (tasks.size() < count && split) {
+      split = false;
+      std::vector<Index> next;
+      for (auto node : tasks) {
+        if (queries_.nodes_[node].left == BallTree::NO_CHILD) {
+          next.push_back(node);
+        } else {
+          next.push_back(queries_.nodes_[node].left);
+          next.push_back(queries_.nodes_[node].right);
+          split = true;
+        }
+      }
+      tasks.swap(next);
+    }
+    return tasks;
+  }
+
+  void Traverse(Index query_node, Index reference_node) {
+    const BallTree::Node &q = queries_.nodes_[query_node];
+    const BallTree::Node &r = reference_.nodes_[reference_node];
+    Scalar center_distance = std::sqrt(SquaredDistance(queries_.center(query_node), reference_.center(reference_node),
+                                                       dimensions_));
+    if (center_distance - q.radius - r.radius > bounds_[query_node]) return;
+
+    bool query_leaf = q.left == BallTree::NO_CHILD;
+    bool reference_leaf = r.left == BallTree::NO_CHILD;
+    if (query_leaf && reference_leaf) {
+      BaseCase(query_node, reference_node);
+    } else if (query_leaf || (!reference_leaf && r.end - r.begin >= q.end - q.begin)) {
+      // Descend the reference, closer child first, so that the bounds shrink early.
+      Index first = r.left, second = r.right;
+      if (SquaredDistance(queries_.center(query_node), reference_.center(second), dimensions_)
+          < SquaredDistance(queries_.center(query_node), reference_.center(first), dimensions_)) {
+        std::swap(first, second);
+      }
+      Traverse(query_node, first);
+      Traverse(query_node, second);
+    } else {
+      Traverse(q.left, reference_node);
+      Traverse(q.right, reference_node);
+      bounds_[query_node] = std::max(bounds_[q.left], bounds_[q.right]);
+    }
+  }
+
+  //! Write the sorted neighbors of every query.
+  void Collect(std::vector<Index> *indices, std::vector<Scalar> *distance_squares) {
+    indices->assign(queries_.size() * k_, 0);
+    distance_squares->assign(queries_.size() * k_, 0);
+    for (Index query = 0; query < queries_.size(); ++query) {
+      std::pair<Scalar, Index> *heap = &heaps_[query * k_];
+      std::sort_heap(heap, heap + heap_sizes_[query]);
+      for (Index j = 0; j < heap_sizes_[query]; ++j) {
+        (*indices)[query * k_ + j] = heap[j].second;
+        (*distance_squares)[query * k_ + j] = heap[j].first;
+      }
+    }
+  }
+
+ private:
+  Scalar Kth(Index query) const {
+    if (heap_sizes_[query] < k_) return std::numeric_limits<Scalar>::max();
+    return std::sqrt(heaps_[query * k_].first);
+  }
+
+  void BaseCase(Index query_node, Index reference_node) {
+    const BallTree::Node &q = queries_.nodes_[query_node];
+    const BallTree::Node &r = reference_.nodes_[reference_node];
+    Scalar bound = 0;
+    for (Index p = q.begin; p < q.end; ++p) {
+      Index query = queries_.order_[p];
+      const Scalar *x = queries_.point(query);
+      if (std::sqrt(SquaredDistance(x, reference_.center(reference_node), dimensions_)) - r.radius <= Kth(query)) {
+        std::pair<Scalar, Index> *heap = &heaps_[query * k_];
+        Index &size = heap_sizes_[query];
+        for (Index rp = r.begin; rp < r.end; ++rp) {
+          Index row = reference_.order_[rp];
+          Scalar distance = SquaredDistance(x, reference_.point(row), dimensions_);
+          if (size < k_) {
+            heap[size++] = std::make_pair(distance, row);
+            std::push_heap(heap, heap + size);
+          } else if (distance < heap[0].first) {
+            std::pop_heap(heap, heap + size);
+            heap[size - 1] = std::make_pair(distance, row);
+            std::push_heap(heap, heap + size);
+          }
+        }
+      }
+      bound = std::max(bound, Kth(query));
+    }
+    bounds_[query_node] = std::min(bounds_[query_node], bound);
+  }
+
+  const BallTree &queries_;
+  const BallTree &reference_;
+  Index k_;
+  Index dimensions_;
+  std::vector<std::pair<Scalar, Index>> heaps_;
+  std::vector<Index> heap_sizes_;
+  std::vector<Scalar> bounds_;
+};
+
+void DualTreeKNN(const BallTree &queries, const BallTree &reference, Index k, std::vector<Index> *indices,
+                 std::vector<Scalar> *distance_squares, Index threads) {
+  k = std::min(k, reference.size());
+  if (k == 0 || queries.size() == 0) {
+    indices->assign(queries.size() * k, 0);
+    distance_squares->assign(queries.size() * k, 0);
+    return;
+  }
+
+  threads = ParallelThreadCount(threads);
+  DualTreeKNNTraversal traversal(queries, reference, k);
+  auto tasks = traversal.Tasks(4 * threads);
+  ParallelFor(0, tasks.size(), [&](Index t, Index) { traversal.Traverse(tasks[t], 0); }, threads, 1);
+  traversal.Collect(indices, distance_squares);
+}
+
+//! State of a component-aware nearest neighbor search: the component label of every node, or MIXED.
+class ComponentNearestSearch {
+ public:
+  ComponentNearestSearch(const BallTree &tree, const std::vector<Index> &labels)
+      : tree_(tree), labels_(labels), node_labels_(tree.nodes_.size()), dimensions_(tree.data_->size2) {
+    // Children are added after their parent, so a reverse sweep labels the children first.
+    for (Index n = tree_.nodes_.size(); n-- > 0;) {
+      const BallTree::Node &node = tree_.nodes_[n];
+      if (node.left == BallTree::NO_CHILD) {
+        node_labels_[n] = labels_[tree_.order_[node.begin]];
+        for (Index p = node.begin; p < node.end; ++p) {
+          if (labels_[tree_.order_[p]] != node_labels_[n]) node_labels_[n] = MIXED;
+        }
+      } else {
+        node_labels_[n] = node_labels_[node.left] == node_labels_[node.right] ? node_labels_[node.left] : MIXED;
+      }
+    }
+  }
+
+  //! Update the shortest edge (from, to) from the query point to a point with another label.
+  void Search(Index query, Index node_index, Scalar *best, Index *from, Index *to) const {
+    Index label = labels_[query];
+    if (node_labels_[node_index] == label) return;
+    const BallTree::Node &node = tree_.nodes_[node_index];
+    const Scalar *x = tree_.point(query);
+    if (node.left == BallTree::NO_CHILD) {
+      for (Index p = node.begin; p < node.end; ++p) {
+        Index row = tree_.order_[p];
+        if (labels_[row] == label) continue;
+        Scalar distance = SquaredDistance(x, tree_.point(row), dimensions_);
+        if (distance < *best) {
+          *best = distance;
+          *from = query;
+          *to = row;
+        }
+      }
+      return;
+    }
+
+    // Closer child first; a child is skipped when its ball is beyond the best edge.
+    Index children[2] = {node.left, node.right};
+    Scalar bounds[2];
+    for (Index c = 0; c < 2; ++c) {
+      bounds[c] = std::sqrt(SquaredDistance(x, tree_.center(children[c]), dimensions_))
+          - tree_.nodes_[children[c]].radius;
+    }
+    if (bounds[1] < bounds[0]) {
+      std::swap(children[0], children[1]);
+      std::swap(bounds[0], bounds[1]);
+    }
+    for (Index c = 0; c < 2; ++c) {
+      if (bounds[c] <= 0 || bounds[c] * bounds[c] < *best) Search(query, children[c], best, from, to);
+    }
+  }
+
+ private:
+  static kIndex MIXED = static_cast<Index>(-1);
+
+  const BallTree &tree_;
+  const std::vector<Index> &labels_;
+  std::vector<Index> node_labels_;
+  Index dimensions_;
+};
+
+void ComponentNearestNeighbors(const BallTree &tree, const std::vector<Index> &labels,
+                               const std::vector<std::vector<Index>> &members,
+                               std::vector<std::pair<Index, Index>> *edges, std::vector<Scalar> *distance_squares,
+                               Index threads) {
+  edges->assign(members.size(), std::make_pair(0, 0));
+  distance_squares->assign(members.size(), std::numeric_limits<Scalar>::max());
+  if (tree.size() == 0) return;
+
+  // Large components are split into chunks, so that one of them does not hold up the others.
+  kIndex CHUNK = 1024;
+  std::vector<std::pair<Index, Index>> tasks; // (component, first member)
+  for (Index c = 0; c < members.size(); ++c) {
+    for (Index first = 0; first < members[c].size(); first += CHUNK) tasks.push_back(std::make_pair(c, first));
+  }
+
+  ComponentNearestSearch search(tree, labels);
+  std::vector<std::pair<Index, Index>> task_edges(tasks.size());
+  std::vector<Scalar> task_distance_squares(tasks.size());
+  ParallelFor(0, tasks.size(), [&](Index t, Index) {
+    const std::vector<Index> &points = members[tasks[t].first];
+    Index last = std::min(tasks[t].second + CHUNK, static_cast<Index>(points.size()));
+    Index from = points[tasks[t].second], to = from;
+    Scalar best = std::numeric_limits<Scalar>::max();
+    // The best edge of the chunk so far bounds the searches of its other points.
+    for (Index p = tasks[t].second; p < last; ++p) search.Search(points[p], 0, &best, &from, &to);
+    task_edges[t] = std::make_pair(from, to);
+    task_distance_squares[t] = best;
+  }, threads, 1);
+
+  for (Index t = 0; t < tasks.size(); ++t) {
+    Index c = tasks[t].first;
+    if (tasks[t].second == 0 || task_distance_squares[t] < (*distance_squares)[c]) {
+      (*edges)[c] = task_edges[t];
+      (*distance_squares)[c] = task_distance_squares[t];
+    }
+  }
+}
+
+HSISOMAP_NAMESPACE_END
@@ -0,0 +1,60 @@
+//
+// Created on 10/19/26.
+//
+
+#include <hsisomap/util/PivotTable.h>
+#include <hsisomap/util/Parallel.h>
+#include <algorithm>
+#include <limits>
+
+HSISOMAP_NAMESPACE_BEGIN
+
+namespace {
+
+inline Scalar Distance(const Scalar *a, const Scalar *b, Index dimensions) {
+  Scalar distance = 0;
+  for (Index d = 0; d < dimensions; ++d) distance += (a[d] - b[d]) * (a[d] - b[d]);
+  return std::sqrt(distance);
+}
+
+}
+
+PivotTable::PivotTable(const gsl_matrix *data, Index pivots, Index threads) : dimensions_(data->size2) {
+  kIndex N = data->size1;
+  pivots = std::min(pivots, N);
+  table_.resize(N * pivots);
+  pivot_data_.reserve(pivots * dimensions_);
+  if (pivots == 0) return;
+
+  // The first pivot is the row farthest from row 0, then each pivot is the row farthest from all previous pivots.
+  std::vector<Scalar> nearest_pivot(N, std::numeric_limits<Scalar>::max());
+  Index pivot = 0;
+  Scalar farthest = -1;
+  for (Index row = 0; row < N; ++row) {
+    Scalar distance = Distance(data->data, data->data + row * data->tda, dimensions_);
+    if (distance > farthest) {
+      farthest = distance;
+      pivot = row;
+    }
+  }
+
+  for (Index p = 0; p < pivots; ++p) {
+    pivot_rows_.push_back(pivot);
+    const Scalar *pivot_row = data->data + pivot * data->tda;
+    pivot_data_.insert(pivot_data_.end(), pivot_row, pivot_row + dimensions_);
+
+    ParallelFor(0, N, [&](Index row, Index) {
+      Scalar distance = Distance(pivot_row, data->data + row * data->tda, dimensions_);
+      table_[row * pivots + p] = static_cast<float>(distance);
+      nearest_pivot[row] = std::min(nearest_pivot[row], distance);
+    }, threads);
+
+    pivot = std::max_element(nearest_pivot.begin(), nearest_pivot.end()) - nearest_pivot.begin();
+  }
+}
+
+void PivotTable::QueryDistances(const Scalar *query, Scalar *distances) const {
+  for (Index p = 0; p < pivots(); ++p) distances[p] = Distance(query, &pivot_data_[p * dimensions_], dimensions_);
+}
+
+HSISOMAP_NAMESPACE_END
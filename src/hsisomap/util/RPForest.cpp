@@ -0,0 +1,148 @@
+//
+// Created on 10/19/26.
+//
+
+#include <hsisomap/util/RPForest.h>
+#include <hsisomap/util/Parallel.h>
+#include <hsisomap/util/VpTree.h>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <queue>
+#include <tuple>
+
+HSISOMAP_NAMESPACE_BEGIN
+
+RPForest::RPForest(const gsl::Matrix &data, Index trees, Index leaf_size, Index seed, Index threads)
+    : data_(data), leaf_size_(std::max<Index>(1, leaf_size)), nodes_(trees), order_(trees) {
+  if (seed == 0) seed = std::random_device()();
+  ParallelFor(0, trees, [&](Index tree, Index) {
+    std::seed_seq seed_sequence{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32),
+                                static_cast<std::uint32_t>(tree)};
+    std::mt19937 rng(seed_sequence);
+    BuildTree(tree, rng);
+  }, threads, 1);
+}
+
+Scalar RPForest::Project(const Node &node, const Scalar *x) const {
+  PixelView point(data_.cols(), const_cast<Scalar *>(x), 0);
+  PixelView a(data_.cols(), data_.m_->data + node.pivot_a * data_.m_->tda, 0);
+  PixelView b(data_.cols(), data_.m_->data + node.pivot_b * data_.m_->tda, 0);
+  return SquaredDistance(point, b) - SquaredDistance(point, a);
+}
+
+void RPForest::BuildTree(Index tree, std::mt19937 &rng) {
+  kIndex N = data_.rows();
+  std::vector<Node> &nodes = nodes_[tree];
+  std::vector<Index> &order = order_[tree];
+  order.resize(N);
+  std::iota(order.begin(), order.end(), 0);
+
+  Node root = {0, 0, 0.0, 0.0, NO_CHILD, NO_CHILD, 0, N};
+  nodes.push_back(root);
+  std::vector<Index> stack(1, 0);
+  std::vector<std::pair<Scalar, Index>> projected;
+
+  while (!stack.empty()) {
+    Node node = nodes[stack.back()];
+    Index id = stack.back();
+    stack.pop_back();
+    kIndex count = node.end - node.begin;
+    if (count <= leaf_size_) continue;
+
+    std::uniform_int_distribution<Index> pick(0, count - 1);
+    Index offset_a = pick(rng);
+    Index offset_b = pick(rng);
+    while (offset_b == offset_a) offset_b = pick(rng);
+    node.pivot_a = order[node.begin + offset_a];
+    node.pivot_b = order[node.begin + offset_b];
+    node.threshold = 0.0;
+    PixelView a(data_.cols(), data_.m_->data + node.pivot_a * data_.m_->tda, node.pivot_a);
+    PixelView b(data_.cols(), data_.m_->data + node.pivot_b * data_.m_->tda, node.pivot_b);
+    node.scale = 2.0 * std::sqrt(SquaredDistance(a, b));
+
+    projected.resize(count);
+    for (Index j = 0; j < count; ++j) {
+      Index row = order[node.begin + j];
+      projected[j] = std::make_pair(Project(node, data_.m_->data + row * data_.m_->tda), row);
+    }
+
+    // Split by the bisector of the two pivots, or by the median projection if the bisector does not separate.
+    auto above = [&node](const std::pair<Scalar, Index> &item) { return item.first > node.threshold; };
+    Index left_count = std::count_if(projected.begin(), projected.end(), above);
+    if (left_count == 0 || left_count == count) {
+      std::nth_element(projected.begin(), projected.begin() + count / 2, projected.end());
+      node.threshold = projected[count / 2].first;
+      left_count = std::count_if(projected.begin(), projected.end(), above);
+      if (left_count == 0 || left_count == count) continue; // All projections are equal, keep it as a leaf.
+    }
+    std::partition(projected.begin(), projected.end(), above);
+    for (Index j = 0; j < count; ++j) order[node.begin + j] = projected[j].second;
+
+    Node left = {0, 0, 0.0, 0.0, NO_CHILD, NO_CHILD, node.begin, node.begin + left_count};
+    Node right = {0, 0, 0.0, 0.0, NO_CHILD, NO_CHILD, node.begin + left_count, node.end};
+    node.left = nodes.size();
+    node.right = nodes.size() + 1;
+    nodes[id] = node;
+    nodes.push_back(left);
+    nodes.push_back(right);
+    stack.push_back(node.left);
+    stack.push_back(node.right);
+  }
+}
+
+void RPForest::Search(const Scalar *query, Index k, std::vector<Index> *indices,
+                      std::vector<Scalar> *distance_squares, Index search_candidates) const {
+  k = std::min(k, data_.rows());
+  if (search_candidates == 0) search_candidates = std::max(k, leaf_size_) * trees();
+
+  // Entries are (lower bound of the distance to the region, tree, node), the closest region first.
+  typedef std::tuple<Scalar, Index, Index> Entry;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+  for (Index tree = 0; tree < trees(); ++tree) queue.push(Entry(0.0, tree, 0));
+
+  std::vector<Index> candidates;
+  Index visited = 0;
+  while (!queue.empty() && (visited < search_candidates || candidates.size() < k)) {
+    Scalar bound = std::get<0>(queue.top());
+    Index tree = std::get<1>(queue.top());
+    const Node &node = nodes_[tree][std::get<2>(queue.top())];
+    const std::vector<Index> &order = order_[tree];
+    queue.pop();
+
+    if (node.left == NO_CHILD) {
+      candidates.insert(candidates.end(), order.begin() + node.begin, order.begin() + node.end);
+      visited += node.end - node.begin;
+      if (visited >= search_candidates) {
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+      }
+      continue;
+    }
+
+    Scalar margin = node.scale > 0.0 ? (Project(node, query) - node.threshold) / node.scale : 0.0;
+    queue.push(Entry(bound, tree, margin > 0.0 ? node.left : node.right));
+    queue.push(Entry(std::max(bound, std::abs(margin)), tree, margin > 0.0 ? node.right : node.left));
+  }
+  std::sort(candidates.begin(), candidates.end());
+  candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+  std::vector<std::pair<Scalar, Index>> scored(candidates.size());
+  PixelView target(data_.cols(), const_cast<Scalar *>(query), 0);
+  for (Index c = 0; c < candidates.size(); ++c) {
+    PixelView candidate(data_.cols(), data_.m_->data + candidates[c] * data_.m_->tda, candidates[c]);
+    scored[c] = std::make_pair(SquaredDistance(target, candidate), candidates[c]);
+  }
+  k = std::min(k, static_cast<Index>(scored.size()));
+  std::partial_sort(scored.begin(), scored.begin() + k, scored.end());
+
+  indices->resize(k);
+  distance_squares->resize(k);
+  for (Index j = 0; j < k; ++j) {
+    (*indices)[j] = scored[j].second;
+    (*distance_squares)[j] = scored[j].first;
+  }
+}
+
+HSISOMAP_NAMESPACE_END
@@ -0,0 +1,129 @@
+//
+// Created on 10/19/26.
+//
+
+#include <hsisomap/util/VpTreeIndex.h>
+#include <hsisomap/Logger.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+HSISOMAP_NAMESPACE_BEGIN
+
+namespace {
+
+const char kMagic[8] = {'H', 'S', 'I', 'V', 'P', 'T', 'R', 'E'};
+const uint32_t kByteOrderMark = 0x01020304;
+
+struct IndexHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t node_size;
+  uint64_t rows;
+  uint64_t cols;
+  uint64_t checksum;
+  uint64_t vantage_candidates;
+  uint64_t vantage_samples;
+  uint64_t nodes;
+};
+
+IndexHeader MakeHeader(const gsl::Matrix &data, uint64_t checksum, int vantage_candidates, int vantage_samples,
+                       uint64_t nodes) {
+  IndexHeader header;
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = static_cast<uint32_t>(VPTREE_INDEX_VERSION);
+  header.byte_order = kByteOrderMark;
+  header.node_size = sizeof(VpTreeFlatNode);
+  header.rows = data.rows();
+  header.cols = data.cols();
+  header.checksum = checksum;
+  header.vantage_candidates = vantage_candidates;
+  header.vantage_samples = vantage_samples;
+  header.nodes = nodes;
+  return header;
+}
+
+}
+
+uint64_t MatrixChecksum(const gsl::Matrix &matrix) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (Index r = 0; r < matrix.rows(); ++r) {
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(matrix.m_->data + r * matrix.m_->tda);
+    for (Index b = 0; b < matrix.cols() * sizeof(double); ++b) {
+      hash ^= bytes[b];
+      hash *= 1099511628211ULL;
+    }
+  }
+  return hash;
+}
+
+void SaveVpTreeIndex(const std::string &path, const gsl::Matrix &data, uint64_t checksum, int vantage_candidates,
+                     int vantage_samples, const std::vector<VpTreeFlatNode> &nodes) {
+  IndexHeader header = MakeHeader(data, checksum, vantage_candidates, vantage_samples, nodes.size());
+  std::string temporary_path = path + ".tmp" + std::to_string(getpid());
+  {
+    std::ofstream ofs(temporary_path, std::ios::binary | std::ios::trunc);
+    if (!ofs.is_open()) throw std::invalid_argument(std::string("Cannot write index file \"").append(path).append("\"."));
+    ofs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    ofs.write(reinterpret_cast<const char *>(nodes.data()), nodes.size() * sizeof(VpTreeFlatNode));
+    if (!ofs.good()) {
+      ofs.close();
+      std::remove(temporary_path.c_str());
+      throw std::invalid_argument(std::string("Cannot write index file \"").append(path).append("\"."));
+    }
+  }
+  if (std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+    std::remove(temporary_path.c_str());
+    throw std::invalid_argument(std::string("Cannot write index file \"").append(path).append("\"."));
+  }
+}
+
+VpTreeIndexFile::VpTreeIndexFile(const std::string &path, const gsl::Matrix &data, uint64_t checksum,
+                                 int vantage_candidates, int vantage_samples)
+    : mapping_(NULL), mapping_size_(0), nodes_(NULL), size_(0) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) return;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(IndexHeader)) {
+    close(fd);
+    return;
+  }
+  mapping_size_ = static_cast<size_t>(st.st_size);
+  void *mapping = mmap(NULL, mapping_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) return;
+  mapping_ = mapping;
+
+  IndexHeader header;
+  std::memcpy(&header, mapping_, sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != VPTREE_INDEX_VERSION
+      || header.byte_order != kByteOrderMark || header.node_size != sizeof(VpTreeFlatNode)
+      || header.rows != data.rows() || header.cols != data.cols()
+      || mapping_size_ != sizeof(IndexHeader) + header.nodes * sizeof(VpTreeFlatNode)) {
+    LOGI("Index file \"" << path << "\" is not a valid index of the data, ignored.")
+    return;
+  }
+  if (header.checksum != checksum) {
+    LOGI("Index file \"" << path << "\" was built on different data, ignored.")
+    return;
+  }
+  if (header.vantage_candidates != static_cast<uint64_t>(vantage_candidates)
+      || header.vantage_samples != static_cast<uint64_t>(vantage_samples)) {
+    LOGI("Index file \"" << path << "\" was built with a different vantage point selection, ignored.")
+    return;
+  }
+
+  nodes_ = reinterpret_cast<const VpTreeFlatNode *>(static_cast<const char *>(mapping_) + sizeof(IndexHeader));
+  size_ = header.nodes;
+}
+
+VpTreeIndexFile::~VpTreeIndexFile() {
+  if (mapping_ != NULL) munmap(mapping_, mapping_size_);
+}
+
+HSISOMAP_NAMESPACE_END
@@ -0,0 +1,178 @@
+//
+// Created on 10/19/26.
+//
+
+#include <gtest/gtest.h>
+#include <hsisomap/graph/BoostAdjacencyList.h>
+#include <hsisomap/graph/BoostCSRGraph.h>
+#include <hsisomap/graph/CSRGraph.h>
+#include <hsisomap/graph/dijkstra/BoostDijkstra.h>
+#include <hsisomap/graph/dijkstra/DijkstraCPU.h>
+#include <hsisomap/graph/dijkstra/DeltaStepping.h>
+#include <hsisomap/graph/dijkstra/LaneBellmanFord.h>
+#include <limits>
+#include <random>
+
+namespace {
+
+// kNN graph shaped: short links to nearby vertices, a few long links, and a separate last block of 100 vertices.
+std::shared_ptr<GraphUtils::CSRGraph> TestGraph(Index n) {
+  auto graph = std::make_shared<GraphUtils::CSRGraph>(n);
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<Index> offset(1, 30), anywhere(0, n - 101);
+  std::uniform_real_distribution<Scalar> length(0.5, 1.5);
+  for (Index a = 0; a < n; ++a) {
+    Index first = a < n - 100 ? 0 : n - 100;
+    Index block = a < n - 100 ? n - 100 : 100;
+    for (Index j = 0; j < 4; ++j) graph->Connect(a, first + (a - first + offset(rng)) % block, length(rng));
+    Index far = anywhere(rng);
+    if (a < n - 100 && a % 50 == 0 && far != a) graph->Connect(a, far, 20 * length(rng));
+  }
+  return graph;
+}
+
+}
+
+TEST(dijkstra_check, delta_stepping_check) {
+  const Index N = 5000;
+  auto graph = TestGraph(N);
+  std::vector<Index> sources = {0, 17, 2500, N - 1};
+
+  Dijkstra::DijkstraCPU reference(graph, 2);
+  reference.SetSourceVertices(sources);
+  reference.Run();
+  auto expected = reference.GetDistanceMatrix();
+
+  // The automatic delta, and a small one with many buckets and heavy edges
+  for (Scalar delta : {0.0, 0.3}) {
+    Dijkstra::DeltaStepping deltaStepping(graph, 4, delta);
+    EXPECT_GT(deltaStepping.delta(), 0);
+    deltaStepping.SetSourceVertices(sources);
+    deltaStepping.Run();
+    auto distances = deltaStepping.GetDistanceMatrix();
+    for (Index i = 0; i < sources.size(); ++i) {
+      for (Index v = 0; v < N; ++v) EXPECT_DOUBLE_EQ((*distances)(i, v), (*expected)(i, v));
+    }
+  }
+}
+
+TEST(dijkstra_check, radix_heap_dijkstra_check) {
+  const Index N = 5000;
+  auto graph = TestGraph(N);
+  std::vector<Index> sources = {0, 17, 2500, N - 1};
+
+  Dijkstra::DijkstraCPU reference(graph, 2);
+  reference.SetSourceVertices(sources);
+  reference.Run();
+  auto expected = reference.GetDistanceMatrix();
+
+  Dijkstra::DijkstraCPU radix(graph, 2);
+  radix.SetQueue(Dijkstra::DIJKSTRACPU_QUEUE_RADIX_HEAP);
+  EXPECT_GT(radix.relativeErrorBound(), 0);
+  EXPECT_LT(radix.relativeErrorBound(), 1e-8);
+  radix.SetSourceVertices(sources);
+  radix.Run();
+  auto distances = radix.GetDistanceMatrix();
+  for (Index i = 0; i < sources.size(); ++i) {
+    for (Index v = 0; v < N; ++v) {
+      if ((*expected)(i, v) == std::numeric_limits<Scalar>::max()) {
+        EXPECT_EQ((*distances)(i, v), (*expected)(i, v));
+      } else {
+        EXPECT_NEAR((*distances)(i, v), (*expected)(i, v), radix.relativeErrorBound() * (*expected)(i, v));
+      }
+    }
+  }
+  // The rows handed to a sink are the rows of the matrix
+  std::vector<std::vector<Scalar>> rows(sources.size());
+  radix.Run([&](Index i, const Scalar *row) { rows[i].assign(row, row + N); });
+  for (Index i = 0; i < sources.size(); ++i) {
+    ASSERT_EQ(rows[i].size(), N);
+    for (Index v = 0; v < N; ++v) EXPECT_EQ(rows[i][v], (*distances)(i, v));
+  }
+}
+
+TEST(dijkstra_check, lane_bellman_ford_check) {
+  const Index N = 5000;
+  auto graph = TestGraph(N);
+  // A partial last batch, a repeated source, and sources in the separate block
+  std::vector<Index> sources;
+  for (Index i = 0; i < 21; ++i) sources.push_back((i * 613) % N);
+  sources.push_back(0);
+  sources.push_back(N - 1);
+
+  Dijkstra::DijkstraCPU reference(graph, 2);
+  reference.SetSourceVertices(sources);
+  reference.Run();
+  auto expected = reference.GetDistanceMatrix();
+
+  for (Index lanes : {8, 16}) {
+    Dijkstra::LaneBellmanFord laneBellmanFord(graph, 2, lanes);
+    laneBellmanFord.SetSourceVertices(sources);
+    laneBellmanFord.Run();
+    auto distances = laneBellmanFord.GetDistanceMatrix();
+    for (Index i = 0; i < sources.size(); ++i) {
+      for (Index v = 0; v < N; ++v) EXPECT_DOUBLE_EQ((*distances)(i, v), (*expected)(i, v));
+    }
+  }
+  EXPECT_THROW(Dijkstra::LaneBellmanFord(graph, 1, 4), std::invalid_argument);
+}
+
+TEST(dijkstra_check, boost_dijkstra_check) {
+  const Index N = 5000;
+  auto graph = TestGraph(N);
+  std::vector<Index> sources = {0, 17, 2500, N - 1};
+
+  Dijkstra::DijkstraCPU reference(graph, 2);
+  reference.SetSourceVertices(sources);
+  reference.Run();
+  auto expected = reference.GetDistanceMatrix();
+
+  // The same edges in the two Boost representations
+  auto adjacencyList = std::make_shared<GraphUtils::BoostAdjacencyList>(N);
+  auto boostCSRGraph = std::make_shared<GraphUtils::BoostCSRGraph>(N);
+  for (Index a = 0; a < N; ++a) {
+    for (Index edge = graph->offsets()[a]; edge < graph->offsets()[a + 1]; ++edge) {
+      if (graph->neighbors()[edge] < a) continue;
+      adjacencyList->Connect(a, graph->neighbors()[edge], graph->weights()[edge]);
+      boostCSRGraph->Connect(a, graph->neighbors()[edge], graph->weights()[edge]);
+    }
+  }
+  EXPECT_EQ(boostCSRGraph->NumEdges(), adjacencyList->NumEdges());
+
+  for (auto boostDijkstra : {Dijkstra::BoostDijkstra(adjacencyList, 3), Dijkstra::BoostDijkstra(boostCSRGraph, 3)}) {
+    boostDijkstra.SetSourceVertices(sources);
+    boostDijkstra.Run();
+    auto distances = boostDijkstra.GetDistanceMatrix();
+    for (Index i = 0; i < sources.size(); ++i) {
+      for (Index v = 0; v < N; ++v) EXPECT_DOUBLE_EQ((*distances)(i, v), (*expected)(i, v));
+    }
+  }
+}
+
+TEST(dijkstra_check, distance_row_sink_check) {
+  const Index N = 5000;
+  auto graph = TestGraph(N);
+  std::vector<Index> sources;
+  for (Index i = 0; i < 11; ++i) sources.push_back((i * 457) % N);
+
+  Dijkstra::DijkstraCPU reference(graph, 2);
+  reference.SetSourceVertices(sources);
+  reference.Run();
+  auto expected = reference.GetDistanceMatrix();
+
+  std::vector<std::shared_ptr<Dijkstra::Dijkstra>> engines = {
+      std::make_shared<Dijkstra::DijkstraCPU>(graph, 3),
+      std::make_shared<Dijkstra::DeltaStepping>(graph, 3),
+      std::make_shared<Dijkstra::LaneBellmanFord>(graph, 3)};
+  for (auto engine : engines) {
+    engine->SetSourceVertices(sources);
+    // The rows arrive from the worker threads, each into its own place
+    std::vector<std::vector<Scalar>> rows(sources.size());
+    engine->Run([&](Index i, const Scalar *row) { rows[i].assign(row, row + N); });
+    EXPECT_FALSE(engine->GetDistanceMatrix());
+    for (Index i = 0; i < sources.size(); ++i) {
+      ASSERT_EQ(rows[i].size(), N);
+      for (Index v = 0; v < N; ++v) EXPECT_DOUBLE_EQ(rows[i][v], (*expected)(i, v));
+    }
+  }
+}
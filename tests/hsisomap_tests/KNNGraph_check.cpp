@@ -0,0 +1,292 @@
+//
+// Created on 10/19/26.
+//
+
+#include <gtest/gtest.h>
+#include <hsisomap/graph/CSRGraph.h>
+#include <hsisomap/graph/knngraph/KNNGraph.h>
+#include <hsisomap/graph/knngraph/KNNGraph_AdaptiveK_HIDENN_detail.h>
+#include <hsisomap/graph/knngraph/KNNGraph_FixedK.h>
+#include <hsisomap/graph/knngraph/KNNGraph_FixedK_MST.h>
+#include <hsisomap/graph/knngraph/KNNGraph_NNDescent.h>
+#include <hsisomap/util/BallTree.h>
+#include <hsisomap/util/Parallel.h>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <cmath>
+#include <random>
+
+namespace {
+
+// Gaussian clusters of unit spread, the centers of consecutive clusters separation apart along the first column.
+std::shared_ptr<gsl::Matrix> GaussianClusters(Index clusters, Index points_per_cluster, Index dimensions,
+                                              double separation) {
+  auto data = std::make_shared<gsl::Matrix>(clusters * points_per_cluster, dimensions);
+  std::mt19937 rng(11);
+  std::normal_distribution<double> normal;
+  for (Index r = 0; r < data->rows(); ++r) {
+    for (Index c = 0; c < dimensions; ++c) (*data)(r, c) = normal(rng) + (c == 0) * separation * (r / points_per_cluster);
+  }
+  return data;
+}
+
+// The connected component label of every vertex, from a breadth first search over the CSR arrays.
+std::vector<Index> ComponentLabels(const GraphUtils::CSRGraph &graph, Index *components) {
+  const Index unlabeled = std::numeric_limits<Index>::max();
+  std::vector<Index> labels(graph.NumVertices(), unlabeled);
+  *components = 0;
+  for (Index s = 0; s < graph.NumVertices(); ++s) {
+    if (labels[s] != unlabeled) continue;
+    std::vector<Index> queue(1, s);
+    labels[s] = *components;
+    for (Index q = 0; q < queue.size(); ++q) {
+      for (Index e = graph.offsets()[queue[q]]; e < graph.offsets()[queue[q] + 1]; ++e) {
+        Index neighbor = graph.neighbors()[e];
+        if (labels[neighbor] != unlabeled) continue;
+        labels[neighbor] = *components;
+        queue.push_back(neighbor);
+      }
+    }
+    ++*components;
+  }
+  return labels;
+}
+
+bool HasEdge(const GraphUtils::CSRGraph &graph, Index a, Index b) {
+  auto begin = graph.neighbors().begin() + graph.offsets()[a];
+  auto end = graph.neighbors().begin() + graph.offsets()[a + 1];
+  return std::binary_search(begin, end, b);
+}
+
+}
+
+TEST(knngraph_check, nn_descent_check) {
+  using namespace ::hsisomap;
+  const Index K = 10;
+  // Three clusters that the neighbor lists alone leave apart.
+  auto data = GaussianClusters(3, 1000, 8, 40);
+  auto knngraph = KNNGraphWithImplementation(KNNGRAPH_IMPLEMENTATION_NN_DESCENT, data,
+                                             {{KNNGRAPH_NN_DESCENT_K_NUMBER, K},
+                                              {KNNGRAPH_NN_DESCENT_SEED, 5},
+                                              {KNNGRAPH_GRAPH_BACKEND, KNNGRAPH_GRAPH_BACKEND_CSR},
+                                              {PARALLEL_THREADS, 4}});
+  auto graph = std::dynamic_pointer_cast<GraphUtils::CSRGraph>(knngraph->knngraph());
+  ASSERT_TRUE(graph != nullptr);
+
+  Index components = 0;
+  ComponentLabels(*graph, &components);
+  EXPECT_EQ(components, 1);
+
+  // The neighbor lists are approximate, but they hold most of the exact neighbors. The first exact neighbor is
+  // the point itself, which the graph leaves out.
+  auto exact = KNNSearchWithBackend(*data, {{KNN_BACKEND, KNN_BACKEND_BRUTE_FORCE}})->SearchReference(0, data->rows(), K);
+  Index found = 0;
+  for (Index q = 0; q < exact.queries(); ++q) {
+    for (Index j = 1; j < K; ++j) found += HasEdge(*graph, q, exact.index(q, j));
+  }
+  EXPECT_GT(static_cast<double>(found) / (exact.queries() * (K - 1)), 0.9);
+}
+
+TEST(knngraph_check, fixed_k_mst_boruvka_check) {
+  using namespace ::hsisomap;
+  const Index K = 3;
+  // Clusters around random centers, so that the kNN graph falls apart and the MST over the parts is not a chain.
+  const Index D = 4;
+  auto data = std::make_shared<gsl::Matrix>(6 * 50, D);
+  std::mt19937 rng(3);
+  std::normal_distribution<double> normal;
+  std::uniform_real_distribution<double> center(0, 200);
+  std::vector<double> centers(6 * D);
+  for (auto &c : centers) c = center(rng);
+  for (Index r = 0; r < data->rows(); ++r) {
+    for (Index c = 0; c < D; ++c) (*data)(r, c) = normal(rng) + centers[(r / 50) * D + c];
+  }
+  auto distance = [&](Index a, Index b) {
+    double sum = 0;
+    for (Index c = 0; c < D; ++c) sum += ((*data)(a, c) - (*data)(b, c)) * ((*data)(a, c) - (*data)(b, c));
+    return std::sqrt(sum);
+  };
+
+  PropertyList property_list = {{KNNGRAPH_FIXED_K_NUMBER, K},
+                                {KNNGRAPH_GRAPH_BACKEND, KNNGRAPH_GRAPH_BACKEND_CSR},
+                                {PARALLEL_THREADS, 3}};
+  KNNGraph_FixedK knn_only(data, property_list);
+  auto knn_graph = std::dynamic_pointer_cast<GraphUtils::CSRGraph>(knn_only.knngraph());
+  Index parts = 0;
+  auto labels = ComponentLabels(*knn_graph, &parts);
+  ASSERT_GT(parts, 6);
+
+  // The exhaustive shortest edge between every two parts, and from every part to the rest.
+  std::vector<double> between(parts * parts, std::numeric_limits<double>::max());
+  for (Index a = 0; a < data->rows(); ++a) {
+    for (Index b = 0; b < data->rows(); ++b) {
+      if (labels[a] == labels[b]) continue;
+      double &shortest = between[labels[a] * parts + labels[b]];
+      shortest = std::min(shortest, distance(a, b));
+    }
+  }
+
+  // The component-aware search finds the shortest edge out of each part.
+  BallTree tree(data->m_, 4);
+  std::vector<std::vector<Index>> members(parts);
+  for (Index n = 0; n < data->rows(); ++n) members[labels[n]].push_back(n);
+  std::vector<std::pair<Index, Index>> edges;
+  std::vector<Scalar> distance_squares;
+  ComponentNearestNeighbors(tree, labels, members, &edges, &distance_squares, 3);
+  for (Index p = 0; p < parts; ++p) {
+    EXPECT_EQ(labels[edges[p].first], p);
+    EXPECT_NE(labels[edges[p].second], p);
+    EXPECT_NEAR(std::sqrt(distance_squares[p]), *std::min_element(&between[p * parts], &between[(p + 1) * parts]), 1e-9);
+  }
+
+  // Prim's algorithm over the parts gives the expected augmented edge lengths.
+  std::vector<double> expected;
+  std::vector<bool> in_tree(parts, false);
+  std::vector<double> reach(between.begin(), between.begin() + parts);
+  in_tree[0] = true;
+  for (Index step = 1; step < parts; ++step) {
+    Index next = 0;
+    double shortest = std::numeric_limits<double>::max();
+    for (Index p = 0; p < parts; ++p) {
+      if (!in_tree[p] && reach[p] < shortest) {
+        shortest = reach[p];
+        next = p;
+      }
+    }
+    in_tree[next] = true;
+    expected.push_back(shortest);
+    for (Index p = 0; p < parts; ++p) reach[p] = std::min(reach[p], between[next * parts + p]);
+  }
+
+  auto knngraph = KNNGraphWithImplementation(KNNGRAPH_IMPLEMENTATION_FIXED_K_WITH_MST, data, property_list);
+  auto graph = std::dynamic_pointer_cast<GraphUtils::CSRGraph>(knngraph->knngraph());
+  Index components = 0;
+  ComponentLabels(*graph, &components);
+  EXPECT_EQ(components, 1);
+
+  // The augmented edges are the graph edges between different parts of the kNN graph.
+  std::vector<double> augmented;
+  for (Index a = 0; a < graph->NumVertices(); ++a) {
+    for (Index e = graph->offsets()[a]; e < graph->offsets()[a + 1]; ++e) {
+      Index b = graph->neighbors()[e];
+      if (a < b && labels[a] != labels[b]) {
+        augmented.push_back(graph->weights()[e]);
+        EXPECT_NEAR(graph->weights()[e], distance(a, b), 1e-9);
+      }
+    }
+  }
+  ASSERT_EQ(augmented.size(), expected.size());
+  std::sort(augmented.begin(), augmented.end());
+  std::sort(expected.begin(), expected.end());
+  for (Index i = 0; i < expected.size(); ++i) EXPECT_NEAR(augmented[i], expected[i], 1e-9);
+}
+
+TEST(knngraph_check, hidenn_graph_length_slopes_check) {
+  using namespace ::hsisomap;
+  using namespace ::hsisomap::hidenn_detail;
+  auto data = GaussianClusters(2, 80, 5, 3);
+  std::vector<Index> rows;
+  for (Index r = 0; r < data->rows(); r += 2) rows.push_back(r);
+
+  std::mt19937 rng(42);
+  auto slopes = GraphLengthSlopes(*data, rows, rng);
+  ASSERT_EQ(slopes.size(), MAX_K + 1);
+
+  // Naive reference on the same samples: the dense distance matrix of each sample, summed over the entries of the
+  // symmetric kNN adjacency of every k, and the least squares slopes of the logarithms.
+  std::mt19937 reference_rng(42);
+  std::vector<Index> sample(rows);
+  std::vector<double> log_samples;
+  std::vector<std::vector<double>> log_lengths(MAX_K + 1);
+  for (Index N = MIN_SAMPLES; N <= std::min(MAX_SAMPLES, static_cast<Index>(rows.size())); ++N) {
+    for (Index i = 0; i < N; ++i) {
+      std::uniform_int_distribution<Index> pick(i, sample.size() - 1);
+      std::swap(sample[i], sample[pick(reference_rng)]);
+    }
+    std::vector<double> distances(N * N, 0);
+    for (Index a = 0; a < N; ++a) {
+      for (Index b = 0; b < N; ++b) {
+        double sum = 0;
+        for (Index c = 0; c < data->cols(); ++c) {
+          sum += ((*data)(sample[a], c) - (*data)(sample[b], c)) * ((*data)(sample[a], c) - (*data)(sample[b], c));
+        }
+        distances[a * N + b] = std::sqrt(sum);
+      }
+    }
+    log_samples.push_back(std::log(static_cast<double>(N)));
+    for (Index k = MIN_K; k <= MAX_K; ++k) {
+      std::vector<bool> adjacent(N * N, false);
+      for (Index a = 0; a < N; ++a) {
+        std::vector<Index> order;
+        for (Index b = 0; b < N; ++b) if (b != a) order.push_back(b);
+        std::stable_sort(order.begin(), order.end(),
+                         [&](Index u, Index v) { return distances[a * N + u] < distances[a * N + v]; });
+        for (Index j = 0; j < std::min(k, N - 1); ++j) adjacent[a * N + order[j]] = adjacent[order[j] * N + a] = true;
+      }
+      double length = 0;
+      for (Index e = 0; e < N * N; ++e) length += adjacent[e] ? distances[e] : 0;
+      log_lengths[k].push_back(std::log(length));
+    }
+  }
+
+  for (Index k = MIN_K; k <= MAX_K; ++k) {
+    double mean_x = 0, mean_y = 0;
+    for (Index i = 0; i < log_samples.size(); ++i) {
+      mean_x += log_samples[i] / log_samples.size();
+      mean_y += log_lengths[k][i] / log_samples.size();
+    }
+    double sxy = 0, sxx = 0;
+    for (Index i = 0; i < log_samples.size(); ++i) {
+      sxy += (log_samples[i] - mean_x) * (log_lengths[k][i] - mean_y);
+      sxx += (log_samples[i] - mean_x) * (log_samples[i] - mean_x);
+    }
+    EXPECT_NEAR(slopes[k], sxy / sxx, 1e-9);
+  }
+
+  // Too small subsets get no slopes.
+  std::vector<Index> few_rows(rows.begin(), rows.begin() + MIN_SAMPLES);
+  for (auto slope : GraphLengthSlopes(*data, few_rows, rng)) EXPECT_EQ(slope, 0);
+}
+
+TEST(knngraph_check, csr_graph_neighbor_table_check) {
+  // Rows of 2 neighbors: self loops in rows 0 and 3, the edge 0-1 listed from both ends with different weights, and
+  // the edge 1-2 listed from both ends with the same weight.
+  std::vector<Index> neighbors = {0, 1,
+                                  0, 2,
+                                  3, 1,
+                                  2, 3};
+  std::vector<Scalar> weights = {0.0, 1.0,
+                                 1.5, 2.0,
+                                 3.0, 2.0,
+                                 3.0, 0.0};
+  GraphUtils::CSRGraph graph(4, 2, neighbors, weights);
+
+  EXPECT_EQ(graph.NumVertices(), 4);
+  EXPECT_EQ(graph.NumEdges(), 6);
+  EXPECT_EQ(graph.offsets(), std::vector<Index>({0, 1, 3, 5, 6}));
+  EXPECT_EQ(graph.neighbors(), std::vector<Index>({1, 0, 2, 1, 3, 2}));
+  // The edge 0-1 takes the weight listed last, at both of its ends.
+  EXPECT_EQ(graph.weights(), std::vector<Scalar>({1.5, 1.5, 2.0, 2.0, 3.0, 3.0}));
+
+  EXPECT_THROW(GraphUtils::CSRGraph(4, 3, neighbors, weights), std::invalid_argument);
+}
+
+TEST(knngraph_check, fixed_k_component_sizes_check) {
+  using namespace ::hsisomap;
+  // Two clusters far enough apart that no neighbor list crosses, with enough neighbors to hold each cluster together.
+  auto data = GaussianClusters(2, 120, 4, 50);
+  for (Index k : {2, 12}) {
+    KNNGraph_FixedK knngraph(data, {{KNNGRAPH_FIXED_K_NUMBER, static_cast<Scalar>(k)}, {PARALLEL_THREADS, 3}});
+    auto graph = std::dynamic_pointer_cast<GraphUtils::CSRGraph>(knngraph.knngraph());
+    ASSERT_TRUE(graph != nullptr);
+
+    Index components = 0;
+    auto labels = ComponentLabels(*graph, &components);
+    std::vector<Index> sizes(components, 0);
+    for (auto label : labels) ++sizes[label];
+    std::sort(sizes.begin(), sizes.end(), std::greater<Index>());
+    EXPECT_EQ(knngraph.component_sizes(), sizes);
+    if (k == 12) EXPECT_EQ(knngraph.component_sizes(), std::vector<Index>({120, 120}));
+  }
+}
@@ -0,0 +1,257 @@
+//
+// Created on 10/19/26.
+//
+
+#include <gtest/gtest.h>
+#include <hsisomap/knnsearch/KNNSearch.h>
+#include <hsisomap/knnsearch/KNNSearch_BruteForce.h>
+#include <hsisomap/knnsearch/KNNSearch_RPForest.h>
+#include <hsisomap/knnsearch/KNNSearch_PCAKDTree.h>
+#include <hsisomap/knnsearch/KNNSearch_DualTree.h>
+#include <hsisomap/util/PivotTable.h>
+#include <hsisomap/util/VpTreeIndex.h>
+#include <cstdio>
+#include <sstream>
+#include <random>
+
+class KNNSearchFixture: public ::testing::Test {
+ protected:
+  virtual void TearDown() {
+  }
+
+  virtual void SetUp() {
+  }
+
+ public:
+  KNNSearchFixture() : Test(), reference_(500, 12), queries_(37, 12) {
+    std::mt19937 rng(7);
+    std::normal_distribution<double> normal;
+    for (Index r = 0; r < reference_.rows(); ++r) {
+      for (Index c = 0; c < reference_.cols(); ++c) reference_(r, c) = normal(rng) + (r % 4) * (c == 0) * 5;
+    }
+    for (Index r = 0; r < queries_.rows(); ++r) {
+      for (Index c = 0; c < queries_.cols(); ++c) queries_(r, c) = normal(rng);
+    }
+  }
+
+  virtual ~KNNSearchFixture() {
+  }
+
+  // Exhaustive squared distances from one query row to all reference rows, sorted.
+  std::vector<double> ExactDistanceSquares(const gsl::Matrix &queries, Index q) {
+    std::vector<double> result;
+    for (Index r = 0; r < reference_.rows(); ++r) {
+      double sum = 0;
+      for (Index c = 0; c < reference_.cols(); ++c) {
+        sum += (queries(q, c) - reference_(r, c)) * (queries(q, c) - reference_(r, c));
+      }
+      result.push_back(sum);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+  }
+
+  void ExpectExact(const ::hsisomap::KNNTable &table, const gsl::Matrix &queries, Index first_row) {
+    for (Index q = 0; q < table.queries(); ++q) {
+      auto exact = ExactDistanceSquares(queries, first_row + q);
+      for (Index j = 0; j < table.k; ++j) {
+        EXPECT_NEAR(table.distance_square(q, j), exact[j], 1e-9);
+      }
+    }
+  }
+
+  gsl::Matrix reference_;
+  gsl::Matrix queries_;
+
+};
+
+TEST_F(KNNSearchFixture, knnsearch_brute_force_check) {
+  using namespace ::hsisomap;
+  // Small tiles so that the queries and the reference are both split into several tiles.
+  auto knn_search = KNNSearchWithBackend(reference_, {{KNN_BACKEND, KNN_BACKEND_BRUTE_FORCE},
+                                                      {KNN_BRUTE_FORCE_TILE_ROWS, 16},
+                                                      {KNN_BRUTE_FORCE_TILE_COLS, 64},
+                                                      {PARALLEL_THREADS, 3}});
+  auto table = knn_search->Search(queries_, 10);
+  EXPECT_EQ(table.queries(), queries_.rows());
+  EXPECT_EQ(table.k, 10);
+  ExpectExact(table, queries_, 0);
+
+  auto self_table = knn_search->SearchReference(100, 150, 5);
+  EXPECT_EQ(self_table.queries(), 50);
+  ExpectExact(self_table, reference_, 100);
+  for (Index q = 0; q < self_table.queries(); ++q) EXPECT_EQ(self_table.index(q, 0), 100 + q);
+}
+
+TEST_F(KNNSearchFixture, knnsearch_brute_force_near_tie_check) {
+  using namespace ::hsisomap;
+  // Points close together far from the origin, where |a|^2 + |b|^2 - 2 a.b loses most of its digits.
+  gsl::Matrix reference(400, 12), queries(20, 12);
+  std::mt19937 rng(3);
+  std::normal_distribution<double> normal;
+  for (Index r = 0; r < reference.rows(); ++r) {
+    for (Index c = 0; c < reference.cols(); ++c) reference(r, c) = 1e4 + normal(rng) * 1e-3;
+  }
+  for (Index r = 0; r < queries.rows(); ++r) {
+    for (Index c = 0; c < queries.cols(); ++c) queries(r, c) = 1e4 + normal(rng) * 1e-3;
+  }
+
+  auto knn_search = KNNSearchWithBackend(reference, {{KNN_BACKEND, KNN_BACKEND_BRUTE_FORCE},
+                                                     {KNN_BRUTE_FORCE_TILE_COLS, 64}});
+  const Index k = 8;
+  auto table = knn_search->Search(queries, k);
+  auto views = CreatePixelViewsFromMatrix(reference);
+  auto query_views = CreatePixelViewsFromMatrix(queries);
+  for (Index q = 0; q < queries.rows(); ++q) {
+    std::vector<std::pair<double, Index>> exact;
+    for (Index r = 0; r < reference.rows(); ++r) {
+      exact.push_back(std::make_pair(SquaredDistance(query_views[q], views[r]), r));
+    }
+    std::sort(exact.begin(), exact.end());
+    for (Index j = 0; j < k; ++j) {
+      EXPECT_EQ(table.index(q, j), exact[j].second);
+      EXPECT_EQ(table.distance_square(q, j), exact[j].first);
+    }
+  }
+}
+
+TEST_F(KNNSearchFixture, knnsearch_vptree_check) {
+  using namespace ::hsisomap;
+  auto knn_search = KNNSearchWithBackend(reference_, {{KNN_BACKEND, KNN_BACKEND_VPTREE}, {PARALLEL_THREADS, 3}});
+  auto self_table = knn_search->SearchReference(0, reference_.rows(), 1);
+  for (Index q = 0; q < self_table.queries(); ++q) {
+    EXPECT_EQ(self_table.index(q, 0), q);
+    EXPECT_EQ(self_table.distance_square(q, 0), 0.0);
+  }
+  auto table = knn_search->Search(queries_, 1000);
+  EXPECT_EQ(table.k, reference_.rows());
+}
+
+TEST_F(KNNSearchFixture, knnsearch_vptree_spatial_seed_check) {
+  using namespace ::hsisomap;
+  // The reference is seen as an image of 20 samples per line; the seeded search must stay exact.
+  auto knn_search = KNNSearchWithBackend(reference_, {{KNN_BACKEND, KNN_BACKEND_VPTREE},
+                                                      {KNN_IMAGE_SAMPLES, 20},
+                                                      {PARALLEL_THREADS, 3}});
+  auto table = knn_search->SearchReference(0, reference_.rows(), 12);
+  ExpectExact(table, reference_, 0);
+
+  std::vector<Index> rows = {499, 0, 19, 20, 250};
+  auto rows_table = knn_search->SearchReferenceRows(rows, 30);
+  for (Index q = 0; q < rows.size(); ++q) {
+    auto exact = ExactDistanceSquares(reference_, rows[q]);
+    for (Index j = 0; j < rows_table.k; ++j) EXPECT_NEAR(rows_table.distance_square(q, j), exact[j], 1e-9);
+  }
+}
+
+TEST_F(KNNSearchFixture, knnsearch_vptree_corrupt_cache_check) {
+  using namespace ::hsisomap;
+  // A node array behind a valid header, but with every node a separate leaf.
+  uint64_t checksum = MatrixChecksum(reference_);
+  std::vector<VpTreeFlatNode> nodes(reference_.rows());
+  for (Index i = 0; i < nodes.size(); ++i) nodes[i] = {static_cast<int32_t>(i), -1, -1, 0, 0.0};
+  std::ostringstream path;
+  path << "./vptree_" << reference_.rows() << "x" << reference_.cols() << "_v1s4_" << std::hex << checksum << ".idx";
+  SaveVpTreeIndex(path.str(), reference_, checksum, 1, 4, nodes);
+  ASSERT_TRUE(VpTreeIndexFile(path.str(), reference_, checksum, 1, 4).valid());
+
+  // The malformed tree is rebuilt instead of failing the search.
+  SetKNNIndexCacheDirectory(".");
+  auto knn_search = KNNSearchWithBackend(reference_, {{KNN_BACKEND, KNN_BACKEND_VPTREE}, {PARALLEL_THREADS, 3}});
+  SetKNNIndexCacheDirectory("");
+  ExpectExact(knn_search->Search(queries_, 5), queries_, 0);
+
+  // And the rebuilt tree replaces the malformed file.
+  VpTreeIndexFile index_file(path.str(), reference_, checksum, 1, 4);
+  ASSERT_TRUE(index_file.valid());
+  VpTree<PixelView, SquaredDistance> loaded;
+  EXPECT_NO_THROW(loaded.create(CreatePixelViewsFromMatrix(reference_), index_file.nodes(), index_file.size()));
+  std::remove(path.str().c_str());
+}
+
+TEST_F(KNNSearchFixture, knnsearch_rpforest_check) {
+  using namespace ::hsisomap;
+  auto knn_search = KNNSearchWithBackend(reference_, {{KNN_BACKEND, KNN_BACKEND_RPFOREST},
+                                                      {KNN_RPFOREST_TREES, 8},
+                                                      {KNN_RPFOREST_LEAF_SIZE, 16},
+                                                      {KNN_RPFOREST_SEED, 3}});
+  auto table = knn_search->SearchReference(0, reference_.rows(), 10);
+  auto exact = KNNSearchWithBackend(reference_, {{KNN_BACKEND, KNN_BACKEND_BRUTE_FORCE}})
+      ->SearchReference(0, reference_.rows(), 10);
+
+  // The forest is approximate, but each point finds itself and most of its true neighbors.
+  Index found = 0;
+  for (Index q = 0; q < table.queries(); ++q) {
+    EXPECT_EQ(table.index(q, 0), q);
+    for (Index j = 0; j < table.k; ++j) {
+      EXPECT_GE(table.distance_square(q, j), exact.distance_square(q, j) - 1e-9);
+      for (Index e = 0; e < exact.k; ++e) {
+        if (table.index(q, j) == exact.index(q, e)) ++found;
+      }
+    }
+  }
+  EXPECT_GT(static_cast<double>(found) / exact.indices.size(), 0.9);
+}
+
+TEST_F(KNNSearchFixture, knnsearch_pca_kdtree_check) {
+  using namespace ::hsisomap;
+  // Fewer components than columns, so the tree only filters and the exact refinement decides.
+  auto knn_search = KNNSearchWithBackend(reference_, {{KNN_BACKEND, KNN_BACKEND_PCA_KDTREE},
+                                                      {KNN_PCA_DIMENSIONS, 3},
+                                                      {KNN_KDTREE_LEAF_SIZE, 8},
+                                                      {PARALLEL_THREADS, 3}});
+  auto table = knn_search->Search(queries_, 10);
+  EXPECT_EQ(table.queries(), queries_.rows());
+  ExpectExact(table, queries_, 0);
+
+  auto self_table = knn_search->SearchReference(0, reference_.rows(), 5);
+  ExpectExact(self_table, reference_, 0);
+  for (Index q = 0; q < self_table.queries(); ++q) EXPECT_EQ(self_table.index(q, 0), q);
+}
+
+TEST_F(KNNSearchFixture, knnsearch_dual_tree_check) {
+  using namespace ::hsisomap;
+  auto knn_search = KNNSearchWithBackend(reference_, {{KNN_BACKEND, KNN_BACKEND_DUAL_TREE},
+                                                      {KNN_DUAL_TREE_LEAF_SIZE, 4},
+                                                      {PARALLEL_THREADS, 3}});
+  auto table = knn_search->Search(queries_, 10);
+  EXPECT_EQ(table.queries(), queries_.rows());
+  ExpectExact(table, queries_, 0);
+
+  // All reference rows at once reuse the reference tree as the query tree.
+  auto self_table = knn_search->SearchReference(0, reference_.rows(), 7);
+  EXPECT_EQ(self_table.queries(), reference_.rows());
+  ExpectExact(self_table, reference_, 0);
+  for (Index q = 0; q < self_table.queries(); ++q) EXPECT_EQ(self_table.index(q, 0), q);
+
+  auto rows_table = knn_search->SearchReferenceRows({3, 250, 499}, 4);
+  EXPECT_EQ(rows_table.index(1, 0), 250);
+  EXPECT_NEAR(rows_table.distance_square(2, 3), ExactDistanceSquares(reference_, 499)[3], 1e-9);
+
+  auto capped_table = knn_search->Search(queries_, reference_.rows() + 10);
+  EXPECT_EQ(capped_table.k, reference_.rows());
+  ExpectExact(capped_table, queries_, 0);
+}
+
+TEST_F(KNNSearchFixture, knnsearch_pivots_check) {
+  using namespace ::hsisomap;
+  PivotTable pivots(reference_.m_, 6);
+  EXPECT_EQ(pivots.pivots(), 6);
+  std::vector<Scalar> query_distances(pivots.pivots());
+  pivots.QueryDistances(queries_.m_->data, query_distances.data());
+  for (Index r = 0; r < reference_.rows(); ++r) {
+    double exact = 0;
+    for (Index c = 0; c < reference_.cols(); ++c) exact += (queries_(0, c) - reference_(r, c)) * (queries_(0, c) - reference_(r, c));
+    EXPECT_LE(pivots.LowerBound(query_distances.data(), r), std::sqrt(exact));
+  }
+
+  for (auto backend : {KNN_BACKEND_BRUTE_FORCE, KNN_BACKEND_VPTREE}) {
+    auto knn_search = KNNSearchWithBackend(reference_, {{KNN_BACKEND, backend},
+                                                        {KNN_PIVOTS, 8},
+                                                        {PARALLEL_THREADS, 3}});
+    auto table = knn_search->Search(queries_, 10);
+    ExpectExact(table, queries_, 0);
+    auto self_table = knn_search->SearchReference(0, reference_.rows(), 5);
+    ExpectExact(self_table, reference_, 0);
+  }
+}
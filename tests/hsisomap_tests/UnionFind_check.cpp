@@ -0,0 +1,42 @@
+//
+// Created on 10/19/26.
+//
+
+#include <gtest/gtest.h>
+#include <hsisomap/util/UnionFind.h>
+#include <hsisomap/util/ConcurrentUnionFind.h>
+#include <hsisomap/util/Parallel.h>
+#include <random>
+
+TEST(union_find_check, concurrent_union_find_check) {
+  using namespace ::hsisomap;
+  // kNN graph shaped edges: short-range links within blocks of 500 elements, so there are several parts.
+  const Index N = 20000, K = 3;
+  std::vector<Index> neighbors(N * K);
+  std::mt19937 rng(5);
+  std::uniform_int_distribution<Index> offset(0, 40);
+  for (Index n = 0; n < N; ++n) {
+    for (Index j = 0; j < K; ++j) neighbors[n * K + j] = n / 500 * 500 + (n % 500 + offset(rng)) % 500;
+  }
+
+  UnionFind uf(N);
+  for (Index n = 0; n < N; ++n) {
+    for (Index j = 0; j < K; ++j) uf.Connect(n, neighbors[n * K + j]);
+  }
+
+  ConcurrentUnionFind concurrent_uf(N);
+  std::atomic<Index> merges(0);
+  ParallelFor(0, N, [&](Index n, Index) {
+    for (Index j = 0; j < K; ++j) merges += concurrent_uf.Connect(n, neighbors[n * K + j]);
+  }, 8, 16);
+
+  EXPECT_EQ(concurrent_uf.count(), uf.count());
+  EXPECT_EQ(merges.load(), N - uf.count());
+  for (Index n = 0; n < N; ++n) {
+    Index root = concurrent_uf.Find(n);
+    EXPECT_LE(root, n);
+    EXPECT_EQ(concurrent_uf.Find(root), root);
+    EXPECT_EQ(concurrent_uf.connected(n, n / 500 * 500), uf.connected(n, n / 500 * 500));
+    EXPECT_FALSE(concurrent_uf.connected(n, (n + 500) % N));
+  }
+}
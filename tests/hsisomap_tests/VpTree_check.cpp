@@ -0,0 +1,141 @@
+//
+// Created on 10/19/26.
+//
+
+#include <gtest/gtest.h>
+#include <hsisomap/util/VpTree.h>
+#include <hsisomap/util/VpTreeIndex.h>
+#include <random>
+
+class VpTreeFixture: public ::testing::Test {
+ protected:
+  virtual void TearDown() {
+  }
+
+  virtual void SetUp() {
+  }
+
+ public:
+  VpTreeFixture() : Test(), data_(1200, 5), live_(1200, true) {
+    std::mt19937 rng(11);
+    std::normal_distribution<double> normal;
+    for (Index r = 0; r < data_.rows(); ++r) {
+      for (Index c = 0; c < data_.cols(); ++c) data_(r, c) = normal(rng);
+    }
+    pixel_views_ = ::hsisomap::CreatePixelViewsFromMatrix(data_);
+  }
+
+  virtual ~VpTreeFixture() {
+  }
+
+  // Exhaustive squared distances from one row to all live rows, sorted.
+  std::vector<double> LiveDistanceSquares(Index q) {
+    std::vector<double> result;
+    for (Index r = 0; r < data_.rows(); ++r) {
+      if (live_[r]) result.push_back(::hsisomap::SquaredDistance(pixel_views_[q], pixel_views_[r]));
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+  }
+
+  gsl::Matrix data_;
+  std::vector<::hsisomap::PixelView> pixel_views_;
+  std::vector<bool> live_;
+
+};
+
+TEST_F(VpTreeFixture, vptree_dynamic_check) {
+  using namespace ::hsisomap;
+  VpTree<PixelView, SquaredDistance> vptree;
+  vptree.create(std::vector<PixelView>(pixel_views_.begin(), pixel_views_.begin() + 400));
+  for (Index r = 400; r < data_.rows(); ++r) {
+    // Ids follow the creation order, then the insertion order.
+    EXPECT_EQ(vptree.insert(pixel_views_[r]), r);
+    if (r % 2 == 0) {
+      EXPECT_TRUE(vptree.erase(r / 2));
+      live_[r / 2] = false;
+    }
+  }
+  EXPECT_FALSE(vptree.erase(200));
+  EXPECT_FALSE(vptree.erase(static_cast<int>(data_.rows())));
+  EXPECT_EQ(vptree.size(), 800);
+
+  for (Index q = 0; q < data_.rows(); q += 7) {
+    auto exact = LiveDistanceSquares(q);
+    std::vector<PixelView> results;
+    std::vector<double> distance_squares;
+    vptree.search(pixel_views_[q], 8, &results, &distance_squares);
+    ASSERT_EQ(results.size(), 8);
+    for (Index j = 0; j < 8; ++j) {
+      EXPECT_TRUE(live_[results[j].index]);
+      EXPECT_NEAR(distance_squares[j], exact[j], 1e-12);
+    }
+
+    vptree.search_r(pixel_views_[q], 1.5, &results, &distance_squares);
+    EXPECT_EQ(results.size(), std::upper_bound(exact.begin(), exact.end(), 1.5) - exact.begin());
+  }
+}
+
+TEST_F(VpTreeFixture, vptree_vantage_selection_stats_check) {
+  using namespace ::hsisomap;
+  VpTree<PixelView, SquaredDistance> vptree;
+  vptree.set_vantage_selection(5, 20);
+  vptree.create(pixel_views_);
+  EXPECT_GT(vptree.stats().build_distance_evaluations, 0);
+
+  for (Index q = 0; q < 10; ++q) {
+    auto exact = LiveDistanceSquares(q);
+    std::vector<PixelView> results;
+    std::vector<double> distance_squares;
+    vptree.search(pixel_views_[q], 5, &results, &distance_squares);
+    for (Index j = 0; j < 5; ++j) EXPECT_NEAR(distance_squares[j], exact[j], 1e-12);
+  }
+
+  auto stats = vptree.stats();
+  EXPECT_EQ(stats.queries, 10);
+  EXPECT_GE(stats.nodes_visited, stats.distance_evaluations);
+  EXPECT_GT(stats.distance_evaluations, 0);
+  EXPECT_LT(stats.distance_evaluations, 10 * data_.rows());
+
+  vptree.reset_stats();
+  EXPECT_EQ(vptree.stats().queries, 0);
+}
+
+TEST_F(VpTreeFixture, vptree_index_file_check) {
+  using namespace ::hsisomap;
+  VpTree<PixelView, SquaredDistance> vptree;
+  vptree.create(pixel_views_);
+  vptree.erase(3);
+  live_[3] = false;
+
+  uint64_t checksum = MatrixChecksum(data_);
+  SaveVpTreeIndex("vptree_index_check.idx", data_, checksum, 1, 4, vptree.flatten());
+
+  {
+    VpTreeIndexFile index_file("vptree_index_check.idx", data_, checksum, 1, 4);
+    ASSERT_TRUE(index_file.valid());
+    VpTree<PixelView, SquaredDistance> loaded;
+    loaded.create(pixel_views_, index_file.nodes(), index_file.size());
+    EXPECT_EQ(loaded.size(), vptree.size());
+    EXPECT_TRUE(loaded.erased(3));
+
+    for (Index q = 0; q < data_.rows(); q += 97) {
+      auto exact = LiveDistanceSquares(q);
+      std::vector<PixelView> results;
+      std::vector<double> distance_squares;
+      loaded.search(pixel_views_[q], 4, &results, &distance_squares);
+      for (Index j = 0; j < 4; ++j) EXPECT_NEAR(distance_squares[j], exact[j], 1e-12);
+    }
+    // The restored tree is searched without recomputing the build.
+    EXPECT_EQ(loaded.stats().build_distance_evaluations, 0);
+  }
+
+  // A modified matrix does not match the index.
+  gsl::Matrix modified(data_);
+  modified(5, 2) += 1.0;
+  EXPECT_FALSE(VpTreeIndexFile("vptree_index_check.idx", modified, MatrixChecksum(modified), 1, 4).valid());
+  // Nor does another vantage point selection.
+  EXPECT_FALSE(VpTreeIndexFile("vptree_index_check.idx", data_, checksum, 8, 32).valid());
+  EXPECT_FALSE(VpTreeIndexFile("vptree_index_missing.idx", data_, checksum, 1, 4).valid());
+  std::remove("vptree_index_check.idx");
+}